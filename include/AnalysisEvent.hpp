@@ -11,6 +11,8 @@
 #include <TFile.h>
 #include <TLorentzVector.h>
 #include <TROOT.h>
+#include "derivedCache.hpp"
+#include "pairVertex.hpp"
 #include <iostream>
 #include <string>
 
@@ -2456,6 +2458,18 @@ class AnalysisEvent
     std::pair<int, int> chsPairIndex;
     int chsPairTrkIndex;
 
+    // Displacement and quality of every track pair vertex, filled by
+    // PairVertex::compute
+    PairVertices chsTkPairVertices;
+    PairVertices muonTkPairVertices;
+
+    // Plot variables of the current entry, see DerivedCache
+    mutable DerivedCache derivedCache;
+
+    // Ratio of each weight-only systematic to the nominal weight, set when
+    // they are filled in the nominal pass (see Plots::setWeightChannels)
+    std::vector<double> weightVariations;
+
     std::pair<TLorentzVector, TLorentzVector> wPairQuarks;
     std::pair<int, int> wPairIndex;
 
@@ -3835,6 +3849,7 @@ inline Int_t AnalysisEvent::GetEntry(const Long64_t entry)
     if (!fChain) {
         return 0;
     }
+    derivedCache.newEvent();
     return fChain->GetEntry(entry);
 }
 
@@ -15,7 +15,9 @@
 #include <TROOT.h>
 #include <array>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 // Header file for the classes stored in the TTree if any.
 
@@ -59,7 +61,31 @@ class MvaEvent : public AnalysisEvent
              TTree* tree = nullptr,
              bool is2016 = false,
              bool is2018 = false);
+    // Slim layout of analysisMain.exe --slimMva: the event branches are read
+    // from the payload tree, at the entry given by the systematic tree
+    // alongside the MVA ones. Both chains must hold the same files in the
+    // same order.
+    MvaEvent(bool isMC,
+             TTree* payload,
+             TTree* systematic,
+             bool is2016 = false,
+             bool is2018 = false);
     virtual ~MvaEvent();
+
+    // Entries count those of the systematic tree in either layout
+    Int_t GetEntry(const Long64_t entry);
+
+    // Whether an MVA output file has the slim layout
+    static bool slimLayout(const std::string& file);
+
+    private:
+    void setMvaBranchAddresses(TTree* tree);
+
+    TTree* systematic_;
+    Long64_t payloadEntry_;
+    TBranch* b_payloadEntry_; //!
+    // Offsets of the payload files, for chains
+    std::vector<Long64_t> payloadOffsets_;
 };
 
 inline MvaEvent::MvaEvent(bool isMC,
@@ -67,23 +93,75 @@ inline MvaEvent::MvaEvent(bool isMC,
                           bool is2016,
                           bool is2018)
     : AnalysisEvent{isMC, tree, is2016, is2018}
+    , systematic_{nullptr}
+    , payloadEntry_{-1}
+    , b_payloadEntry_{nullptr}
+    , payloadOffsets_{}
 {
-    fChain->SetBranchAddress("isMC", &isMC, &b_isMC);
-    fChain->SetBranchAddress("eventWeight", &eventWeight, &b_eventWeight);
-    fChain->SetBranchAddress("muonMomentumSF", &muonMomentumSF,
-                             &b_muonMomentumSF);
-    fChain->SetBranchAddress("zLep1Index", &zLep1Index, &b_zLep1Index);
-    fChain->SetBranchAddress("zLep2Index", &zLep2Index, &b_zLep2Index);
-    fChain->SetBranchAddress("muonLeads", &muonLeads, &b_muonLeads);
-    fChain->SetBranchAddress("wQuark1Index", &wQuark1Index, &b_wQuark1Index);
-    fChain->SetBranchAddress("wQuark2Index", &wQuark2Index, &b_wQuark2Index);
-    fChain->SetBranchAddress("jetInd", jetInd, &b_jetInd);
-    fChain->SetBranchAddress("bJetInd", bJetInd, &b_bJetInd);
-    fChain->SetBranchAddress("jetSmearValue", jetSmearValue, &b_jetSmearValue);
+    setMvaBranchAddresses(fChain);
+}
+
+inline MvaEvent::MvaEvent(bool isMC,
+                          TTree* payload,
+                          TTree* systematic,
+                          bool is2016,
+                          bool is2018)
+    : AnalysisEvent{isMC, payload, is2016, is2018}
+    , systematic_{systematic}
+    , payloadEntry_{-1}
+    , b_payloadEntry_{nullptr}
+    , payloadOffsets_{}
+{
+    setMvaBranchAddresses(systematic_);
+    systematic_->SetBranchAddress("payloadEntry", &payloadEntry_, &b_payloadEntry_);
+    if (TChain* chain = dynamic_cast<TChain*>(payload))
+    {
+        // Loads the offset of every file
+        chain->GetEntries();
+        payloadOffsets_.assign(chain->GetTreeOffset(), chain->GetTreeOffset() + chain->GetNtrees());
+    }
 }
 
 inline MvaEvent::~MvaEvent()
 {
 }
 
+inline void MvaEvent::setMvaBranchAddresses(TTree* tree)
+{
+    tree->SetBranchAddress("isMC", &isMC, &b_isMC);
+    tree->SetBranchAddress("eventWeight", &eventWeight, &b_eventWeight);
+    tree->SetBranchAddress("muonMomentumSF", &muonMomentumSF,
+                           &b_muonMomentumSF);
+    tree->SetBranchAddress("zLep1Index", &zLep1Index, &b_zLep1Index);
+    tree->SetBranchAddress("zLep2Index", &zLep2Index, &b_zLep2Index);
+    tree->SetBranchAddress("muonLeads", &muonLeads, &b_muonLeads);
+    tree->SetBranchAddress("wQuark1Index", &wQuark1Index, &b_wQuark1Index);
+    tree->SetBranchAddress("wQuark2Index", &wQuark2Index, &b_wQuark2Index);
+    tree->SetBranchAddress("jetInd", jetInd, &b_jetInd);
+    tree->SetBranchAddress("bJetInd", bJetInd, &b_bJetInd);
+    tree->SetBranchAddress("jetSmearValue", jetSmearValue, &b_jetSmearValue);
+}
+
+inline Int_t MvaEvent::GetEntry(const Long64_t entry)
+{
+    if (!systematic_)
+    {
+        return AnalysisEvent::GetEntry(entry);
+    }
+    const Int_t bytes{systematic_->GetEntry(entry)};
+    if (bytes <= 0)
+    {
+        return bytes;
+    }
+    // Entries of the systematic trees refer to the payload of the same file
+    const Long64_t offset{payloadOffsets_.empty() ? 0 : payloadOffsets_.at(static_cast<size_t>(systematic_->GetTreeNumber()))};
+    return bytes + AnalysisEvent::GetEntry(offset + payloadEntry_);
+}
+
+inline bool MvaEvent::slimLayout(const std::string& file)
+{
+    std::unique_ptr<TFile> inFile{TFile::Open(file.c_str(), "READ")};
+    return inFile && !inFile->IsZombie() && inFile->Get("payload");
+}
+
 #endif
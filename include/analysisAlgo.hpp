@@ -1,14 +1,17 @@
 #ifndef _analysisAlgo_hpp_
 #define _analysisAlgo_hpp_
 
+#include "config_parser.hpp"
 #include "cutClass.hpp"
 #include "dataset.hpp"
 #include "histogramPlotter.hpp"
 
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
+class Fingerprint;
 class TH1D;
 class TFile;
 class TChain;
@@ -28,12 +31,47 @@ class AnalysisAlgo
     void runMainAnalysis();
     void savePlots();
 
+    // The skim provenance hash of every dataset, for opposite and same sign
+    // leptons, as -g stamps it and -u checks it. Only needs the command line
+    // parsed.
+    struct SkimProvenance
+    {
+        std::string dataset;
+        std::string plotLabel;
+        std::string treeName; // Chained, from the inputs or the skims
+        std::string opposite;
+        std::string inverted;
+    };
+    std::vector<SkimProvenance> skimProvenances();
+
     private:
     // functions
     std::string channelSetup(unsigned);
+    void makePlots(std::map<std::string, std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>> histograms,
+                   std::map<std::string, TH1D*> cutFlows,
+                   const std::vector<std::string>& legendOrder,
+                   const std::vector<std::string>& histogramOrder,
+                   const std::map<std::string, datasetInfo>& infos,
+                   const std::string& outputFolder,
+                   const std::string& histogramFolder);
+    bool isWeightOnlySystematic(const int systMask, const std::string& datasetName) const;
+    double weightVariation(const AnalysisEvent& event, const int systMask, const bool hasLHE) const;
+    std::pair<std::string, std::string> splitSystChannel(const std::string& systChannel) const;
+    // Summary of the histograms booked by the plots, see Plots::memoryUsage
+    void printPlotMemory() const;
+    // Provenance hashes, see provenance.hpp. A dataset's skim ("skim") or MVA
+    // trees ("mva") are for the current channel.
+    std::string datasetProvenance(Dataset& dataset, const std::string& artefact, const bool invertedLeptons) const;
+    std::string histogramProvenance();
+    void addSelectionProvenance(Fingerprint& fingerprint) const;
+    std::vector<std::string> histogramFiles() const;
 
     // variables?
     std::string config;
+    // Signal point configs run together, sharing one pass over the
+    // backgrounds
+    std::vector<std::string> gridConfigs;
+    std::vector<Parser::GridPoint> gridPoints;
     bool plots;
     bool makeHistos;
     bool useHistos;
@@ -41,6 +79,9 @@ class AnalysisAlgo
     long nEvents;
     std::string outFolder;
     std::string histoDir;
+    int histoCompression;
+    unsigned plotWorkers;
+    bool forcePlots;
     std::string postfix;
     std::string channel;
     bool invertLepCut; // For z+jets background estimation
@@ -50,14 +91,34 @@ class AnalysisAlgo
     std::string cutConfName;
     std::string plotConfName;
     bool makePostLepTree;
+    std::string skimConfName;
+    int skimCompression;
+    Parser::SkimConfig skimConfig;
+    std::string outputPolicyName;
+    Parser::OutputPolicy outputPolicy;
+    bool entryListSkim;
+    std::string entryListName;
+    std::string skimDir;
+    bool remake;
+    bool ignoreProvenance;
+    std::string derivedDir;
+    std::string catalogDir;
+    // Whether everything run so far is described by its provenance, i.e.
+    // wasn't cut short or run over skims with another provenance
+    bool provenanceComplete;
+    std::string histoProvenance;
+    bool histogramsUpToDate;
     bool makeMVATree;
+    bool slimMva;
     bool usePostLepTree;
     bool usebTagWeight;
     int systToRun;
+    bool separateWeightSysts;
     int channelsToRun;
     bool skipTrig;
     bool skipScalarCut;
     std::string mvaDir;
+    std::string scanDir;
     bool customJetRegion;
     float metCut;
     float msCut;
@@ -78,6 +139,10 @@ class AnalysisAlgo
     // Plotting stuff
     std::map<std::string, std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>> plotsMap;
     std::map<std::string, TH1D*> cutFlowMap;
+    // Filled in place of cutFlowMap during the run, by fill histogram and
+    // systematic index. Added to cutFlowMap by savePlots.
+    std::map<std::pair<std::string, unsigned>, CutFlow> cutFlowCounters;
+    void writeCutFlowTable() const;
 
     std::vector<std::pair<std::string, std::string>> stageNames;
 
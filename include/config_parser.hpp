@@ -11,6 +11,14 @@
 #include <vector>
 
 namespace Parser {
+    // One signal point of a grid run, see parse_grid
+    struct GridPoint {
+        std::string config;
+        std::string outFolder;
+        std::vector<std::string> datasets;
+        std::vector<std::string> histograms;
+    };
+
     void parse_config(const std::string conf,
                       std::vector<Dataset>& datasets,
                       double& lumi,
@@ -47,6 +55,29 @@ namespace Parser {
                      std::vector<std::string>&,
                      std::vector<std::string>&,
                      std::vector<int>&);
+    std::vector<std::string> parse_grid(const std::vector<std::string>& confs,
+                                        std::vector<GridPoint>& points);
+
+    // Branches kept by the post lepton selection skim, and its compression
+    struct SkimConfig {
+        std::vector<std::string> branches; // TTree::SetBranchStatus patterns
+        int compression; // ROOT compression settings
+    };
+    SkimConfig parse_skim(const std::string& conf);
+
+    // Compression and basket size of the branches of the trees written,
+    // see tuneCompression.exe. -1 leaves the tree's own setting.
+    struct OutputPolicy {
+        struct Rule {
+            std::string pattern; // Branch name, wildcards allowed
+            int compression; // ROOT compression settings
+            int basketSize; // Bytes
+        };
+        int compression; // Of the branches no rule matches, or whose rule
+        int basketSize; // doesn't give one
+        std::vector<Rule> rules; // The first matching a branch applies
+    };
+    OutputPolicy parse_output_policy(const std::string& conf);
 } // namespace Parser
 
 #endif
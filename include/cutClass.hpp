@@ -3,6 +3,9 @@
 
 #include "AnalysisEvent.hpp"
 #include "RoccoR.h"
+#include "cutFlow.hpp"
+#include "cutPipeline.hpp"
+#include "cutScan.hpp"
 #include "plots.hpp"
 
 #include <TH1F.h>
@@ -15,17 +18,32 @@
 
 class Cuts
 {
+    public:
+    // How far the selection got in the last makeCuts call, so the post lepton
+    // selection skim knows which of the event's indices are current
+    enum class SelectionStep
+    {
+        None,
+        Muons, // Passed the muon selection, kept in the skim
+        Dilepton,
+        ChargedHadrons,
+        Dihadron,
+        Jets
+    };
+
     private:
     bool makeLeptonCuts(AnalysisEvent& event,
                         double& eventWeight,
                         std::map<std::string, std::shared_ptr<Plots>>& plotMap,
-                        TH1D& cutFlow,
+                        CutFlow& cutFlow,
                         const int& syst);
     std::pair<std::vector<int>, std::vector<double>>
         makeJetCuts(const AnalysisEvent& event,
                     const int syst,
                     double& eventWeight,
                     const bool isProper = true) const;
+    // Stores the jet selection, invalidating cached plot variables if it changed
+    void setJets(AnalysisEvent& event, std::pair<std::vector<int>, std::vector<double>> jets) const;
     [[gnu::pure]] std::vector<int> makeBCuts(const AnalysisEvent& event,
                                              const std::vector<int> jets,
                                              const int syst = 0) const;
@@ -57,6 +75,26 @@ class Cuts
     int getMuonTrackPairIndex(const AnalysisEvent& event) const;
     // grab the chs track pair index for selected muons
     int getChsTrackPairIndex(const AnalysisEvent& event) const;
+    bool passPairVertexCuts(const PairVertices& vertices, const int index, const double minSigXY, const double maxChi2Ndof, const double minCosPointingXY) const;
+
+    // Ordered selection stages run by makeCuts. Declared in the cut config,
+    // defaults to the standard selection order.
+    CutPipeline pipeline_;
+    std::vector<std::pair<std::string, std::string>> pipelineStages_;
+    void buildPipeline(
+        const std::vector<std::pair<std::string, std::string>>& stages);
+    // Working point grid, evaluated in place of the cuts it covers when
+    // scan mode is enabled
+    CutScan scan_;
+    // Plots and cut flow of the current makeCuts call, used by the stages
+    std::map<std::string, std::shared_ptr<Plots>>* plotMap_;
+    CutFlow* cutFlow_;
+    // Cut flows of the weight-only systematics filled in the nominal pass,
+    // see AnalysisEvent::weightVariations
+    std::vector<CutFlow*> weightCutFlows_;
+    // Start of the current event, or the last cut flow stage it reached
+    CutFlow::Clock::time_point cutFlowMark_;
+    void fillCutFlow(CutFlow& cutFlow, const AnalysisEvent& event, const size_t stage, const double eventWeight);
 
     // set to true to fill in histograms/spit out other info
     bool doPlots_;
@@ -101,6 +139,14 @@ class Cuts
     double higgsMassCut_;
     double invWMassCut_;
 
+    // Refitted vertex cuts on the chosen dimuon and charged hadron pairs
+    double minMumuVtxSigXY_;
+    double maxMumuVtxChi2Ndof_;
+    double minMumuVtxCosPointingXY_;
+    double minChsVtxSigXY_;
+    double maxChsVtxChi2Ndof_;
+    double minChsVtxCosPointingXY_;
+
     // Tight jet cuts
     unsigned numJets_;
     unsigned maxJets_;
@@ -158,7 +204,7 @@ class Cuts
     bool isZplusCR_;
 
     // For producing post-lepsel skims
-    TTree* postLepSelTree_;
+    SelectionStep lastStep_;
 
     // For removing trigger cuts. Will be set to false by default
     bool skipTrigger_;
@@ -223,15 +269,15 @@ class Cuts
     bool makeCuts(AnalysisEvent& event,
                   double& eventWeight,
                   std::map<std::string, std::shared_ptr<Plots>>& plotMap,
-                  TH1D& cutFlow,
+                  CutFlow& cutFlow,
                   const int systToRun);
     void setMC(bool isMC)
     {
         isMC_ = isMC;
     }
-    void setCloneTree(TTree* tree)
+    SelectionStep lastStep() const
     {
-        postLepSelTree_ = tree;
+        return lastStep_;
     }
     void setNumLeps(const unsigned tightMu,
                     const unsigned looseMu,
@@ -255,6 +301,10 @@ class Cuts
     {
         triggerFlag_ = triggerFlag;
     }
+    void setWeightCutFlows(std::vector<CutFlow*> cutFlows)
+    {
+        weightCutFlows_ = std::move(cutFlows);
+    }
     void setBTagPlots(std::vector<TH2D*> vec, bool makePlotsOrRead)
     {
         makeBTagEffPlots_ = makePlotsOrRead;
@@ -308,6 +358,20 @@ class Cuts
     {
         isZplusCR_ = isZplusCR;
     }
+    void printPipelineSummary() const;
+    void resetPipeline()
+    {
+        pipeline_.reset();
+    }
+    void enableScan();
+    void resetScan()
+    {
+        scan_.reset();
+    }
+    void writeScan(const std::string& fileName) const
+    {
+        scan_.write(fileName);
+    }
 
     // Simple deltaR function, because the reco namespace doesn't work or
     // something
@@ -0,0 +1,61 @@
+#ifndef _cutFlow_hpp_
+#define _cutFlow_hpp_
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class TH1D;
+
+// Weighted event counts after each cut flow stage (lepSel, zMass, ...), filled
+// by stage index. Also keeps the wall time spent reaching each stage from the
+// previous one. Filled in place of the cut flow histograms, which are only
+// updated by addTo when they are saved.
+class CutFlow
+{
+    public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit CutFlow(std::vector<std::string> stageNames);
+
+    void fill(const size_t stage, const double weight)
+    {
+        Stage& s{stages_[stage]};
+        s.sumW += weight;
+        s.sumW2 += weight * weight;
+        s.count++;
+    }
+    // Adds the time since the previous mark to the stage, and moves the mark
+    void addTime(const size_t stage, Clock::time_point& mark)
+    {
+        const Clock::time_point now{Clock::now()};
+        stages_[stage].nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(now - mark).count();
+        mark = now;
+    }
+
+    size_t size() const
+    {
+        return stages_.size();
+    }
+    // Adds the counts to a histogram with one bin per stage, keeping its
+    // statistics as if it had been filled at the bin centres. Doesn't reset.
+    void addTo(TH1D& hist) const;
+    void reset();
+    // One tab separated line per stage, after the given leading columns
+    void writeTable(std::ostream& os, const std::string& prefix) const;
+    static void writeTableHeader(std::ostream& os, const std::string& prefix);
+
+    private:
+    struct Stage
+    {
+        std::string name;
+        double sumW;
+        double sumW2;
+        long long count;
+        long long nanoseconds;
+    };
+    std::vector<Stage> stages_;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef _cutPipeline_hpp_
+#define _cutPipeline_hpp_
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class AnalysisEvent;
+
+// A single step of the event selection. The cut returns false to reject the
+// event and may modify the event weight. Commutative stages must not touch
+// the event content (only the weight), so they can be run in any order with
+// respect to their commutative neighbours.
+struct CutStage
+{
+    std::string name;
+    std::function<bool(AnalysisEvent&, double&, const int)> cut;
+    bool commutative;
+
+    // Bookkeeping, filled while running
+    long long eventsIn;
+    long long eventsPassed;
+    double sumWeightsIn;
+    double sumWeightsPassed;
+    long long nanoseconds;
+};
+
+// Ordered list of cut stages run by Cuts::makeCuts. Keeps per-stage weighted
+// counters and timers, and can reorder runs of adjacent commutative stages so
+// that the cheapest, most rejecting stages are run first. The physics cut
+// flow is filled by non-commutative stages, so its order never changes.
+class CutPipeline
+{
+    public:
+    CutPipeline();
+
+    void addStage(const std::string& name,
+                  std::function<bool(AnalysisEvent&, double&, const int)> cut,
+                  const bool commutative);
+    void clear();
+    void setReordering(const bool reorder, const long long interval)
+    {
+        reorder_ = reorder;
+        reorderInterval_ = interval;
+    }
+    bool run(AnalysisEvent& event, double& eventWeight, const int syst);
+
+    // Resets counters and restores the declared order. Called per dataset.
+    void reset();
+    void printSummary(std::ostream& os) const;
+    std::vector<std::string> stageOrder() const;
+    size_t size() const
+    {
+        return stages_.size();
+    }
+
+    private:
+    void reorderStages();
+
+    std::vector<CutStage> stages_; // In the order declared in the config
+    std::vector<size_t> order_; // Current execution order
+    bool reorder_;
+    long long reorderInterval_;
+    long long eventsSinceReorder_;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef _cutScan_hpp_
+#define _cutScan_hpp_
+
+#include <TLorentzVector.h>
+#include <array>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+class AnalysisEvent;
+
+// Evaluates a grid of selection working points in a single pass over the
+// events. Events are preselected at the loosest working point of every axis,
+// then the dilepton and dihadron candidates of each grid point are found from
+// per-event caches and compared against the threshold vector of each axis.
+// Yields and cut flows are kept separately for every grid point.
+class CutScan
+{
+    public:
+    // Grid axes, in the order in which they are nested in the output
+    enum Axis
+    {
+        MuonPtLeading,
+        MuonPt,
+        MaxDileptonDeltaR,
+        MaxChsDeltaR,
+        ScalarMass,
+        HiggsMass,
+        NumAxes
+    };
+
+    // Cut flow stages kept for each grid point, as in the nominal cut flow
+    enum Stage
+    {
+        LepSel,
+        ZMass,
+        TrackSel,
+        HiggsSel,
+        NumStages
+    };
+
+    CutScan();
+
+    void parse_config(const YAML::Node& scan);
+    bool empty() const
+    {
+        return axesGiven_ == 0;
+    }
+    // Axes not given in the config are fixed to the nominal cut value
+    void setNominal(const Axis axis, const double value);
+    void setMuonSelection(const bool is2016, const unsigned minMuons);
+    // Loosest value of an axis, to be used for the preselection
+    double loosest(const Axis axis) const;
+    size_t size() const;
+
+    // Takes the loose muons and charged hadrons found at the loosest working
+    // point and fills every grid point the event passes.
+    void fill(const AnalysisEvent& event, const double eventWeight);
+    void reset();
+    void write(const std::string& fileName) const;
+
+    private:
+    struct Candidate
+    {
+        TLorentzVector first; // Leading pT
+        TLorentzVector second;
+        int firstIndex;
+        int secondIndex;
+        double mass;
+        double deltaR;
+    };
+
+    void findDileptons(const AnalysisEvent& event);
+    void findDihadrons(const AnalysisEvent& event, const size_t dilepton);
+
+    std::array<std::vector<double>, NumAxes> axes_;
+    unsigned axesGiven_;
+    bool is2016_;
+    unsigned minMuons_;
+
+    // Per-event caches, kept as members to avoid reallocating every event.
+    // dileptonChoice_ holds the dilepton candidate for every (muonPtLeading,
+    // muonPt, maxDileptonDeltaR) point, dihadronChoice_ the dihadron candidate
+    // for every (dilepton candidate, maxChsDeltaR) pair, -1 if there is none.
+    std::vector<int> muons_;
+    std::vector<Candidate> dileptons_;
+    std::vector<Candidate> dihadrons_;
+    std::vector<int> dileptonChoice_;
+    std::vector<int> dihadronChoice_;
+    std::vector<TLorentzVector> chsVecs_;
+    std::vector<double> chsEta_;
+    std::vector<double> chsPhi_;
+    std::vector<double> chsDeltaR2_;
+
+    // Indexed by grid point * NumStages + stage
+    std::vector<double> sumWeights_;
+    std::vector<double> sumWeights2_;
+    std::vector<long long> events_;
+};
+
+#endif
@@ -23,6 +23,7 @@ class Dataset {
     std::string plotType_;
     std::string triggerFlag_;
     TH1I* generatorWeightPlot_;
+    static std::string cacheDir_;
 
     public:
     Dataset(std::string name,
@@ -60,7 +61,13 @@ class Dataset {
     std::string getPlotType() {
         return plotType_;
     }
-    int fillChain(TChain* chain);
+    std::vector<std::string> locations() {
+        return locations_;
+    }
+    // With a catalog directory, files are added with their entries from
+    // the location catalogs there (see DatasetCatalog), rather than by
+    // wildcard
+    int fillChain(TChain* chain, const std::string& catalogDir = "");
     float getDatasetWeight(double);
     std::string getTriggerFlag() {
         return triggerFlag_;
@@ -73,6 +80,13 @@ class Dataset {
         return generatorWeightPlot_;
     }
 
+    // Directory the generator weight sums of each location are cached in,
+    // for datasets made from then on. Empty, the default, to always read
+    // them from the files.
+    static void setCacheDir(const std::string& cacheDir) {
+        cacheDir_ = cacheDir;
+    }
+
 };
 
 #endif
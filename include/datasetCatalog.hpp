@@ -0,0 +1,58 @@
+#ifndef _datasetCatalog_hpp_
+#define _datasetCatalog_hpp_
+
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TChain;
+
+// The ROOT files of a dataset location with their tree entries, kept in
+// <cacheDir>/<hash of the location>.catalog so that chains can be built
+// without opening every file to count its entries. Loading a catalog lists
+// the directory and only opens the files added or changed (by size or
+// modification time) since it was last written. The checksums of catalogued
+// files are kept for the rest of the process, so that entry lists and derived
+// columns don't open the files again for them.
+class DatasetCatalog
+{
+    public:
+    struct File
+    {
+        std::string path;
+        unsigned long long size;
+        std::time_t modified;
+        std::string checksum; // As EntryList::checksum
+        long long entries;
+        std::vector<long long> clusters; // First entry of each cluster
+    };
+
+    DatasetCatalog(const std::string& location, const std::string& treeName, const std::string& cacheDir);
+
+    // Adds the files in name order, with their entries
+    void fillChain(TChain& chain) const;
+
+    const std::vector<File>& files() const
+    {
+        return files_;
+    }
+    long long entries() const;
+    // Checksum of a file of the tree catalogued by this process, empty if it
+    // wasn't or has no tree
+    static std::string checksum(const std::string& path, const std::string& treeName);
+    // Splits the entries of the chain filled from the catalog into about
+    // equal ranges [first, last), each starting at a cluster boundary
+    std::vector<std::pair<long long, long long>> partition(const unsigned parts) const;
+
+    private:
+    File scan(const std::string& path, const unsigned long long size, const std::time_t modified) const;
+    void read(const std::string& file);
+    void write(const std::string& file) const;
+
+    const std::string location_;
+    const std::string treeName_;
+    std::vector<File> files_;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _deltaRKernel_hpp_
+#define _deltaRKernel_hpp_
+
+#include <cmath>
+#include <cstddef>
+
+// ΔR/Δφ between collections of objects, for cross-cleaning and matching.
+// Everything works with ΔR² so no square roots are taken in the loops, and the
+// phi difference is wrapped with a floor rather than a branch or atan2 so the
+// loops over a collection vectorise. Collections are passed as separate eta
+// and phi arrays, as they are stored in AnalysisEvent.
+namespace DeltaR
+{
+constexpr double pi{3.14159265358979323846};
+constexpr double twoPi{2. * pi};
+
+// Phi difference wrapped into [-pi, pi)
+template <typename T>
+inline T deltaPhi(const T phi1, const T phi2)
+{
+    const T dPhi{phi1 - phi2};
+    return dPhi - T(twoPi) * std::floor(dPhi * T(1. / twoPi) + T(0.5));
+}
+
+template <typename T>
+inline T deltaR2(const T eta1, const T phi1, const T eta2, const T phi2)
+{
+    const T dEta{eta1 - eta2};
+    const T dPhi{deltaPhi(phi1, phi2)};
+    return dEta * dEta + dPhi * dPhi;
+}
+
+// ΔR² of each object of a collection to a single object
+void deltaR2Row(const float* eta, const float* phi, const size_t n, const float eta0, const float phi0, float* out);
+void deltaR2Row(const double* eta, const double* phi, const size_t n, const double eta0, const double phi0, double* out);
+
+// ΔR² between every pair of objects, out[i * n2 + j] for object i of the first
+// collection and object j of the second
+void deltaR2Matrix(const float* eta1, const float* phi1, const size_t n1, const float* eta2, const float* phi2, const size_t n2, float* out);
+void deltaR2Matrix(const double* eta1, const double* phi1, const size_t n1, const double* eta2, const double* phi2, const size_t n2, double* out);
+
+// For each object of the first collection, ΔR² to the closest object of the
+// second collection. Infinity if the second collection is empty.
+void minDeltaR2(const float* eta1, const float* phi1, const size_t n1, const float* eta2, const float* phi2, const size_t n2, float* out);
+void minDeltaR2(const double* eta1, const double* phi1, const size_t n1, const double* eta2, const double* phi2, const size_t n2, double* out);
+
+// Index of the object closest to (eta0, phi0) with ΔR < maxDeltaR, -1 if none
+int bestMatch(const float* eta, const float* phi, const size_t n, const float eta0, const float phi0, const float maxDeltaR);
+int bestMatch(const double* eta, const double* phi, const size_t n, const double eta0, const double phi0, const double maxDeltaR);
+
+// Number of objects with ΔR < cone around (eta0, phi0)
+size_t countWithin(const float* eta, const float* phi, const size_t n, const float eta0, const float phi0, const float cone);
+size_t countWithin(const double* eta, const double* phi, const size_t n, const double eta0, const double phi0, const double cone);
+} // namespace DeltaR
+
+#endif
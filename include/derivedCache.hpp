@@ -0,0 +1,101 @@
+#ifndef _derivedCache_hpp_
+#define _derivedCache_hpp_
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+class AnalysisEvent;
+
+// Memoises plot variables within an event, so that a variable filled at
+// several cut stages, or for several systematics, is only computed once
+// while the selection state it depends on is unchanged. Values are indexed
+// by plot variable ID. Everything is invalidated when a new entry is read;
+// the selection invalidates the dependencies it changes.
+class DerivedCache
+{
+    public:
+    using ScalarFill = float (*)(const AnalysisEvent&);
+    using VectorFill = void (*)(const AnalysisEvent&, std::vector<float>&);
+
+    // Selection state a variable depends on, besides the event branches
+    enum Dependency : unsigned
+    {
+        Branches = 0,
+        Leptons = 1u << 0, // Selected leptons and the dilepton candidate
+        Hadrons = 1u << 1, // Charged hadrons and the dihadron candidate
+        Jets = 1u << 2, // Selected jets, b-jets and their smearing
+    };
+
+    void newEvent();
+    void invalidate(const unsigned dependencies);
+
+    float scalar(const unsigned id, const unsigned dependencies, const ScalarFill fill, const AnalysisEvent& event)
+    {
+        Entry& entry{entryFor(id)};
+        if (!entry.valid)
+        {
+            entry.value = fill(event);
+            markValid(id, entry, dependencies);
+        }
+        else
+        {
+            reused_++;
+        }
+        return entry.value;
+    }
+
+    const std::vector<float>& values(const unsigned id, const unsigned dependencies, const VectorFill fill, const AnalysisEvent& event)
+    {
+        Entry& entry{entryFor(id)};
+        if (!entry.valid)
+        {
+            entry.values.clear();
+            fill(event, entry.values);
+            markValid(id, entry, dependencies);
+        }
+        else
+        {
+            reused_++;
+        }
+        return entry.values;
+    }
+
+    // Number of variables computed and of values served from the cache,
+    // summed over all events
+    void printSummary(std::ostream& os) const;
+    void resetCounters();
+
+    private:
+    struct Entry
+    {
+        bool valid{false};
+        unsigned dependencies{0};
+        float value{0.f};
+        std::vector<float> values;
+    };
+
+    Entry& entryFor(const unsigned id)
+    {
+        if (id >= entries_.size())
+        {
+            entries_.resize(id + 1);
+        }
+        return entries_[id];
+    }
+    void markValid(const unsigned id, Entry& entry, const unsigned dependencies)
+    {
+        entry.valid = true;
+        entry.dependencies = dependencies;
+        valid_.emplace_back(id);
+        computed_++;
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<unsigned> valid_; // IDs of the valid entries
+    long long events_{0};
+    long long computed_{0};
+    long long reused_{0};
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef _derivedColumnStore_hpp_
+#define _derivedColumnStore_hpp_
+
+#include <string>
+#include <vector>
+
+class AnalysisEvent;
+class TChain;
+
+// Per-event quantities which are costly to compute but depend on neither the
+// selection nor the systematic, currently the track pair vertices of
+// PairVertex::compute. They are computed once for each input file and saved
+// as <directory>/<file checksum>.root, a tree aligned entry by entry with the
+// input, which later passes add as a friend of their chain and read with the
+// rest of the event. Each file is stamped with a hash of the code version and
+// columns, and made again whenever it changes.
+class DerivedColumnStore
+{
+    public:
+    DerivedColumnStore(const std::string& directory, const bool isMC, const bool is2016, const bool is2018);
+    ~DerivedColumnStore();
+    DerivedColumnStore(const DerivedColumnStore&) = delete;
+    DerivedColumnStore& operator=(const DerivedColumnStore&) = delete;
+
+    // Makes the columns of every file of the chain without up to date ones,
+    // then adds them as a friend of the chain. From then on, reading an entry
+    // of the chain fills the event's pair vertices.
+    void attach(TChain& chain, AnalysisEvent& event);
+
+    // Hash the columns are stamped with
+    const std::string& version() const
+    {
+        return version_;
+    }
+
+    private:
+    // Columns of a file, made if they are missing or out of date
+    std::string columnsFile(const std::string& file, const std::string& inputTree);
+    void produce(const std::string& file, const std::string& inputTree, const std::string& output) const;
+
+    const std::string directory_;
+    const bool isMC_;
+    const bool is2016_;
+    const bool is2018_;
+    std::string version_;
+
+    TChain* chain_;
+    TChain* friend_;
+    // Branch addresses, which must outlive the friend
+    std::vector<std::vector<float>*> addresses_;
+    unsigned made_;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef _entryList_hpp_
+#define _entryList_hpp_
+
+#include <map>
+#include <string>
+#include <vector>
+
+class TChain;
+
+// Entries of a set of input files which passed a selection, kept instead of
+// a copy of the events. Files are identified by a checksum of their ROOT UUID,
+// size and number of tree entries rather than by path, so a list made over
+// one copy of the inputs can be used with another, and a file rewritten since
+// the list was made is caught when the list is used.
+class EntryList
+{
+    public:
+    EntryList() = default;
+    // Reads a list saved by write()
+    explicit EntryList(const std::string& file);
+
+    // Checksum of a tree file, from its dataset catalog if it was catalogued
+    // (see DatasetCatalog), otherwise opened on the way
+    static std::string checksum(const std::string& file, const std::string& treeName);
+
+    // Splits sorted entries of a chain into its files. Files of the chain
+    // without entries are kept too, as having none passing.
+    void add(TChain& chain, const std::vector<long long>& entries);
+    // Entries of a chain which are in the list, in chain order. Throws if a
+    // file of the chain isn't in the list, or has changed since.
+    std::vector<long long> chainEntries(TChain& chain) const;
+
+    // Keeps the entries in both lists. Files missing from either list are
+    // dropped, as nothing is known of them.
+    EntryList& intersect(const EntryList& other);
+    // Keeps the entries in either list
+    EntryList& unite(const EntryList& other);
+
+    void write(const std::string& file) const;
+    size_t files() const
+    {
+        return files_.size();
+    }
+    // Passing entries over all files
+    size_t size() const;
+
+    private:
+    struct FileEntries
+    {
+        long long treeEntries;
+        std::vector<long long> entries; // Sorted
+    };
+    // The files of a chain, with their offset in it
+    struct ChainFile
+    {
+        std::string checksum;
+        long long offset;
+        long long treeEntries;
+    };
+    static std::vector<ChainFile> chainFiles(TChain& chain);
+
+    std::map<std::string, FileEntries> files_; // By checksum
+};
+
+#endif
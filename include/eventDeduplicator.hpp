@@ -0,0 +1,95 @@
+#ifndef _eventDeduplicator_hpp_
+#define _eventDeduplicator_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Set of (run, lumi block, event) for removing the events already taken from
+// another primary dataset. Events are added first, then looked up, with
+// freeze() in between:
+//  - Within a run, the lumi block and event number are packed into a 64-bit
+//    key, and each run keeps its keys in a sorted vector, 8 bytes per event.
+//  - A blocked bloom filter over every event answers most lookups of events
+//    which aren't in the set without touching the runs.
+//  - Given a spill directory, runs are written out to a new directory within
+//    it whenever the keys in memory pass the memory budget, and loaded back
+//    as lookups need them, keeping the most recently used within the budget.
+//    The new directory is removed with the deduplicator.
+// Adding and looking up are both thread safe.
+class EventDeduplicator
+{
+    public:
+    // Without a spill directory everything stays in memory, whatever the
+    // budget, which is in bytes
+    explicit EventDeduplicator(const size_t memoryBudget = 0, const std::string& spillDir = "");
+    ~EventDeduplicator();
+    EventDeduplicator(const EventDeduplicator&) = delete;
+    EventDeduplicator& operator=(const EventDeduplicator&) = delete;
+
+    struct Event
+    {
+        int32_t run;
+        uint32_t lumi;
+        uint32_t event;
+    };
+    void add(const Event& event);
+    // Takes the lock once
+    void add(const std::vector<Event>& events);
+
+    // Sorts the runs and builds the bloom filter. Nothing can be added after.
+    void freeze();
+    bool contains(const Event& event) const;
+
+    // Distinct events, once frozen
+    size_t size() const
+    {
+        return size_;
+    }
+    // Keys and bloom filter held in memory
+    size_t bytes() const;
+
+    private:
+    static uint64_t key(const Event& event)
+    {
+        return static_cast<uint64_t>(event.lumi) << 32 | event.event;
+    }
+    static uint64_t hash(const int32_t run, const uint64_t key);
+
+    struct Run
+    {
+        // Sorted once frozen, unless spilled
+        std::shared_ptr<std::vector<uint64_t>> keys;
+        size_t spilledKeys{0};
+        // Position in loadOrder_ while loaded, of spilled runs
+        std::list<int32_t>::iterator loaded;
+    };
+    std::string spillFile(const int32_t run) const;
+    // Appends the run's keys in memory to its spill file. Call with the lock
+    // held.
+    void spill(const int32_t run, Run& keys);
+    // The keys of a run, loading them if spilled. Takes the lock.
+    std::shared_ptr<const std::vector<uint64_t>> runKeys(const int32_t run) const;
+
+    const size_t memoryBudget_;
+    // Of this deduplicator only, within the given spill directory
+    const std::string spillDir_;
+    bool frozen_;
+    size_t size_;
+
+    mutable std::mutex mutex_;
+    mutable std::map<int32_t, Run> runs_;
+    mutable size_t keysInMemory_;
+    // Loaded spilled runs, least recently used first
+    mutable std::list<int32_t> loadOrder_;
+
+    // 512-bit blocks of eight words
+    std::vector<uint64_t> bloom_;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _fingerprint_hpp_
+#define _fingerprint_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 64-bit FNV-1a hash, for telling whether the inputs of an output changed
+// since it was last made. Not meant to be collision resistant against
+// anything but accidents.
+class Fingerprint
+{
+    public:
+    Fingerprint& add(const void* data, const size_t size)
+    {
+        const unsigned char* bytes{static_cast<const unsigned char*>(data)};
+        for (size_t i{0}; i < size; i++)
+        {
+            hash_ ^= bytes[i];
+            hash_ *= prime_;
+        }
+        return *this;
+    }
+    Fingerprint& add(const std::string& value)
+    {
+        // The length keeps consecutive strings apart
+        add(value.size());
+        return add(value.data(), value.size());
+    }
+    Fingerprint& add(const char* value)
+    {
+        return add(std::string{value});
+    }
+    Fingerprint& add(const std::vector<std::string>& values)
+    {
+        add(values.size());
+        for (const auto& value : values)
+        {
+            add(value);
+        }
+        return *this;
+    }
+    template <typename T>
+    Fingerprint& add(const T value)
+    {
+        return add(&value, sizeof value);
+    }
+
+    uint64_t value() const
+    {
+        return hash_;
+    }
+    // Sixteen hex digits
+    std::string hex() const
+    {
+        static const char digits[]{"0123456789abcdef"};
+        std::string out(16, '0');
+        for (size_t i{0}; i < 16; i++)
+        {
+            out[15 - i] = digits[(hash_ >> (4 * i)) & 0xf];
+        }
+        return out;
+    }
+
+    private:
+    static constexpr uint64_t prime_{1099511628211ULL};
+    uint64_t hash_{14695981039346656037ULL};
+};
+
+#endif
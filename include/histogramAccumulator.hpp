@@ -0,0 +1,182 @@
+#ifndef _histogramAccumulator_hpp_
+#define _histogramAccumulator_hpp_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+class TAxis;
+class TH1D;
+class TH2D;
+
+// Lightweight stand-ins for TH1D/TH2D while filling. The bins live in one
+// contiguous array and a fill is a bin lookup plus a few additions, without
+// virtual calls or the axis/statistics bookkeeping of TH1::Fill. Accumulators
+// aren't shared between threads: each thread fills its own instances, which
+// are merged in a fixed order and added to the ROOT histograms only when they
+// are saved, so the result doesn't depend on the scheduling.
+class AccumulatorAxis
+{
+    public:
+    AccumulatorAxis(const int nBins, const double min, const double max);
+    explicit AccumulatorAxis(const TAxis& axis);
+
+    // Same numbering as TAxis: 0 is the underflow, nBins + 1 the overflow
+    // (which also takes NaN)
+    int findBin(const double x) const
+    {
+        if (x < min_)
+        {
+            return 0;
+        }
+        if (!(x < max_))
+        {
+            return nBins_ + 1;
+        }
+        if (edges_.empty())
+        {
+            // Uniform binning: arithmetic instead of a search, written as in
+            // TAxis::FindFixBin so values on a bin edge round the same way
+            return 1 + static_cast<int>(nBins_ * (x - min_) / width_);
+        }
+        return static_cast<int>(std::upper_bound(edges_.begin(), edges_.end(), x) - edges_.begin());
+    }
+    int nBins() const
+    {
+        return nBins_;
+    }
+    bool operator==(const AccumulatorAxis& other) const
+    {
+        return nBins_ == other.nBins_ && min_ == other.min_ && max_ == other.max_ && edges_ == other.edges_;
+    }
+
+    private:
+    int nBins_;
+    double min_;
+    double max_;
+    double width_; // max - min
+    std::vector<double> edges_; // Only for variable bins
+};
+
+// The bins of a HistogramAccumulator are only allocated by its first fill, so
+// accumulators which are never filled cost next to nothing.
+class HistogramAccumulator
+{
+    public:
+    HistogramAccumulator(const int nBins, const double min, const double max);
+    // Same binning as the histogram, which is not modified
+    explicit HistogramAccumulator(const TH1D& hist);
+
+    void fill(const double x, const double w)
+    {
+        if (bins_.empty())
+        {
+            allocate();
+        }
+        const int bin{axis_.findBin(x)};
+        Bin& b{bins_[static_cast<size_t>(bin)]};
+        b.sumW += w;
+        b.sumW2 += w * w;
+        entries_++;
+        // Like TH1, the moments only count values inside the axis range
+        if (bin > 0 && bin <= axis_.nBins())
+        {
+            sumW_ += w;
+            sumW2_ += w * w;
+            sumWX_ += w * x;
+            sumWX2_ += w * x * x;
+        }
+    }
+
+    // Adds another accumulator with the same binning. Merge in a fixed order
+    // for reproducible sums.
+    void merge(const HistogramAccumulator& other);
+    // Adds the contents to the histogram (creating its sum of weights squared)
+    // and keeps its statistics consistent, as if the values had been filled
+    // directly. Does not reset the accumulator.
+    void addTo(TH1D& hist) const;
+    void reset();
+    bool empty() const
+    {
+        return entries_ == 0;
+    }
+    // Memory held by the bins
+    size_t bytes() const
+    {
+        return bins_.capacity() * sizeof(Bin);
+    }
+
+    private:
+    struct Bin
+    {
+        double sumW;
+        double sumW2;
+    };
+
+    void allocate();
+
+    AccumulatorAxis axis_;
+    std::vector<Bin> bins_; // Including under- and overflow, empty until filled
+    long long entries_;
+    double sumW_;
+    double sumW2_;
+    double sumWX_;
+    double sumWX2_;
+};
+
+class HistogramAccumulator2D
+{
+    public:
+    HistogramAccumulator2D(const int nBinsX, const double minX, const double maxX, const int nBinsY, const double minY, const double maxY);
+    explicit HistogramAccumulator2D(const TH2D& hist);
+
+    void fill(const double x, const double y, const double w)
+    {
+        const int binX{xAxis_.findBin(x)};
+        const int binY{yAxis_.findBin(y)};
+        // Global bin numbering of TH2
+        Bin& b{bins_[static_cast<size_t>(binX + (xAxis_.nBins() + 2) * binY)]};
+        b.sumW += w;
+        b.sumW2 += w * w;
+        entries_++;
+        if (binX > 0 && binX <= xAxis_.nBins() && binY > 0 && binY <= yAxis_.nBins())
+        {
+            sumW_ += w;
+            sumW2_ += w * w;
+            sumWX_ += w * x;
+            sumWX2_ += w * x * x;
+            sumWY_ += w * y;
+            sumWY2_ += w * y * y;
+            sumWXY_ += w * x * y;
+        }
+    }
+
+    void merge(const HistogramAccumulator2D& other);
+    void addTo(TH2D& hist) const;
+    void reset();
+    bool empty() const
+    {
+        return entries_ == 0;
+    }
+
+    private:
+    struct Bin
+    {
+        double sumW;
+        double sumW2;
+    };
+
+    AccumulatorAxis xAxis_;
+    AccumulatorAxis yAxis_;
+    std::vector<Bin> bins_;
+    long long entries_;
+    double sumW_;
+    double sumW2_;
+    double sumWX_;
+    double sumWX2_;
+    double sumWY_;
+    double sumWY2_;
+    double sumWXY_;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef _histogramFile_hpp_
+#define _histogramFile_hpp_
+
+#include <map>
+#include <memory>
+#include <string>
+
+class TH1D;
+
+// Saved histograms of a whole run in a single ROOT file, laid out as
+// dataset/channel/stage/systematic/plot. The file also holds an "index"
+// string listing the path of every histogram, one per line, so that it can be
+// read back in one pass without walking the directories.
+namespace HistogramFile
+{
+// Name of the file within the histogram directory
+const std::string fileName{"histograms.root"};
+// Systematic directory of the nominal histograms
+const std::string nominal{"nominal"};
+
+struct Key
+{
+    std::string dataset;
+    std::string channel;
+    std::string stage;
+    std::string systematic;
+    std::string plot;
+};
+std::string path(const Key& key);
+
+// Collects histograms and writes them all at once, a directory at a time
+class Writer
+{
+    public:
+    // The histogram must stay alive until write() is called
+    void add(const Key& key, TH1D* hist);
+    // A negative compression keeps the ROOT default
+    void write(const std::string& file, const int compression = -1) const;
+    bool empty() const
+    {
+        return histograms_.empty();
+    }
+
+    private:
+    std::map<std::string, TH1D*> histograms_; // By path
+};
+
+// Reads every histogram of a file, detached from it
+class Reader
+{
+    public:
+    explicit Reader(const std::string& file);
+
+    // Throws if the histogram isn't in the file
+    TH1D* get(const Key& key) const;
+
+    private:
+    std::string file_;
+    std::map<std::string, std::unique_ptr<TH1D>> histograms_;
+};
+} // namespace HistogramFile
+
+#endif
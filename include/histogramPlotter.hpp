@@ -2,6 +2,7 @@
 #define _histogramPlotter_hpp_
 
 #include "TPaveText.h"
+#include "histogramFile.hpp"
 #include "plots.hpp"
 
 #include <map>
@@ -28,6 +29,11 @@ class HistogramPlotter
     const bool is2016_; // Era
     const bool is2018_; // Era
     bool loadHistos_;
+    // Saved histograms, all in one file in the histogram directory
+    HistogramFile::Writer histogramWriter_;
+    std::unique_ptr<HistogramFile::Reader> histogramReader_;
+    int histogramCompression_;
+    const HistogramFile::Reader& histogramReader();
 
     // Orders of various things and information regarding plotting.
     std::vector<std::string> plotOrder_;
@@ -44,6 +50,39 @@ class HistogramPlotter
     TPad* canvy_1;
     TPad* canvy_2;
 
+    // Plots queued by makePlot, drawn by renderPlots
+    struct PlotJob
+    {
+        std::map<std::string, TH1D*> plotMap;
+        std::string title;
+        std::string name;
+        std::string subLabel;
+        std::vector<std::string> xAxisLabels;
+    };
+    struct PlotResult
+    {
+        bool done; // False if the worker drawing it died first
+        bool ok;
+        double seconds;
+        std::string error;
+    };
+    std::vector<PlotJob> pendingPlots_;
+    unsigned plotWorkers_;
+    // Plots whose inputs match the manifest in the output folder are kept
+    // unless this is set
+    bool forceReplot_;
+
+    // Hash of everything that goes into a plot: histogram contents, stack
+    // composition, styles, labels, postfix and the drawing code
+    std::string plotFingerprint(const PlotJob& job) const;
+    std::map<std::string, std::string> readPlotManifest() const;
+    void writePlotManifest(const std::map<std::string, std::string>& manifest) const;
+
+    // Draws and saves one plot. Throws if there is nothing to draw.
+    void drawPlot(PlotJob& job);
+    PlotResult renderPlot(PlotJob& job);
+    void renderInWorkers(std::vector<PlotResult>& results, const unsigned workers);
+
     // writes the lumi information and the CMS "logo" in the FigGuidelines style
     void CMS_lumi(TPad*, int = 10);
     void setTDRStyle();
@@ -82,13 +121,30 @@ class HistogramPlotter
     }
     void setOutputFolder(std::string output);
     void setHistogramFolder(std::string histoDir);
+    void setHistogramCompression(const int compression)
+    {
+        histogramCompression_ = compression;
+    }
     void changeExtensions(std::vector<std::string> extentions)
     {
         extensions_ = extentions;
     }
-    // Actual plotting commands
+    // Number of processes drawing the plots. ROOT graphics isn't thread-safe,
+    // so each worker is a forked process in batch mode.
+    void setPlotWorkers(const unsigned workers)
+    {
+        plotWorkers_ = workers;
+    }
+    void setForceReplot(const bool force)
+    {
+        forceReplot_ = force;
+    }
+    // Actual plotting commands. The channel and systematic are only used to
+    // find the histograms when loading them.
     void plotHistos(
-        std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>);
+        std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>,
+        const std::string& channel,
+        const std::string& systematic);
     void loadHistos()
     {
         loadHistos_ = true;
@@ -96,8 +152,14 @@ class HistogramPlotter
     std::map<std::string, TH1D*> loadCutFlowMap(std::string, std::string);
     void saveHistos(std::map<std::string, TH1D*>, std::string, std::string);
     void saveHistos(
-        std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>);
+        std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>,
+        const std::string& channel,
+        const std::string& systematic);
+    // Writes everything passed to saveHistos
+    void writeHistos();
     void plotCutFlows(std::map<std::string, TH1D*>);
+    // The makePlot overloads only queue the plot. The histograms must stay
+    // alive until renderPlots is called.
     void makePlot(std::map<std::string, TH1D*>, std::string, std::string);
     void makePlot(std::map<std::string, TH1D*>,
                   std::string,
@@ -116,6 +178,10 @@ class HistogramPlotter
         std::vector<std::string>); // Adds a subLabel AND bin labels to the
                                    // plot. Might get confusing later. May come
                                    // up with another name.
+    // Draws all queued plots and reports the time taken by each. Plots which
+    // are unchanged since they were last drawn are skipped. A plot which
+    // fails is reported and skipped. Returns the number of failed plots.
+    unsigned renderPlots();
 };
 
 struct datasetInfo
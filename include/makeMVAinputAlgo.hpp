@@ -1,6 +1,7 @@
 #ifndef _makeMVAinputAlgo_hpp
 #define _makeMVAinputAlgo_hpp_
 
+#include "config_parser.hpp"
 #include "jetCorrectionUncertainty.hpp"
 
 #include <map>
@@ -77,6 +78,8 @@ class MakeMvaInputs
     bool is2016;
     std::string inputDir;
     std::string outputDir;
+    std::string outputPolicyName;
+    Parser::OutputPolicy outputPolicy;
     std::string era;
 };
 
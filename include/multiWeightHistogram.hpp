@@ -0,0 +1,91 @@
+#ifndef _multiWeightHistogram_hpp_
+#define _multiWeightHistogram_hpp_
+
+#include "histogramAccumulator.hpp"
+
+#include <cstddef>
+#include <vector>
+
+class TH1D;
+
+// Histogram accumulator with several weight channels, for systematics which
+// only change the event weight. One fill takes a weight per channel, so every
+// channel costs one bin lookup in total. The channels of a bin are stored next
+// to each other, and are unpacked into one TH1D per channel when saved. As in
+// HistogramAccumulator, the bins are allocated by the first fill.
+class MultiWeightHistogram
+{
+    public:
+    MultiWeightHistogram(const TH1D& hist, const size_t channels);
+    MultiWeightHistogram(const AccumulatorAxis& axis, const size_t channels);
+
+    // weights must hold one weight per channel
+    void fill(const double x, const double* weights)
+    {
+        if (bins_.empty())
+        {
+            allocate();
+        }
+        const int bin{axis_.findBin(x)};
+        Bin* b{&bins_[static_cast<size_t>(bin) * channels_]};
+        for (size_t k{0}; k < channels_; k++)
+        {
+            b[k].sumW += weights[k];
+            b[k].sumW2 += weights[k] * weights[k];
+        }
+        entries_++;
+        if (bin > 0 && bin <= axis_.nBins())
+        {
+            for (size_t k{0}; k < channels_; k++)
+            {
+                Moments& m{moments_[k]};
+                m.sumW += weights[k];
+                m.sumW2 += weights[k] * weights[k];
+                m.sumWX += weights[k] * x;
+                m.sumWX2 += weights[k] * x * x;
+            }
+        }
+    }
+
+    size_t channels() const
+    {
+        return channels_;
+    }
+    void merge(const MultiWeightHistogram& other);
+    // Adds one channel to a histogram, like HistogramAccumulator::addTo
+    void addTo(TH1D& hist, const size_t channel) const;
+    void reset();
+    bool empty() const
+    {
+        return entries_ == 0;
+    }
+    // Memory held by the bins and moments
+    size_t bytes() const
+    {
+        return bins_.capacity() * sizeof(Bin) + moments_.capacity() * sizeof(Moments);
+    }
+
+    private:
+    struct Bin
+    {
+        double sumW;
+        double sumW2;
+    };
+    struct Moments
+    {
+        double sumW;
+        double sumW2;
+        double sumWX;
+        double sumWX2;
+    };
+
+    void allocate();
+
+    AccumulatorAxis axis_;
+    size_t channels_;
+    std::vector<Bin> bins_; // channels_ entries per bin, under- and overflow included. Empty until filled.
+    std::vector<Moments> moments_;
+    long long entries_;
+};
+
+#endif
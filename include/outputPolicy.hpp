@@ -0,0 +1,13 @@
+#ifndef _outputPolicy_hpp_
+#define _outputPolicy_hpp_
+
+#include "config_parser.hpp"
+
+class TTree;
+
+// Sets the compression and basket size of every branch of a tree about to be
+// written from an output policy. Call once the branches are made and before
+// the first Fill.
+void applyOutputPolicy(const Parser::OutputPolicy& policy, TTree* tree);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _pairVertex_hpp_
+#define _pairVertex_hpp_
+
+#include <cstddef>
+#include <vector>
+
+class AnalysisEvent;
+
+// Displacement, fit quality and pointing of the refitted vertex of every
+// stored track pair, indexed as the chsTkPair*/muonTkPair* arrays.
+// Displacements are taken from the leading primary vertex (the beam spot if
+// there is none), with the uncertainty from the sum of the pair vertex and
+// primary vertex covariances.
+struct PairVertices
+{
+    std::vector<float> distXY;
+    std::vector<float> sigXY; // distXY over its uncertainty
+    std::vector<float> distXYZ;
+    std::vector<float> sigXYZ;
+    std::vector<float> chi2Ndof; // -1 if the fit has no degrees of freedom
+    // Cosine of the angle between the displacement and the vertex momentum,
+    // 0 if either vanishes
+    std::vector<float> cosPointingXY;
+    std::vector<float> cosPointingXYZ;
+
+    size_t size() const
+    {
+        return distXY.size();
+    }
+    void resize(const size_t n);
+};
+
+namespace PairVertex
+{
+// Fills event.chsTkPairVertices and event.muonTkPairVertices for all pairs
+// of the current entry
+void compute(AnalysisEvent& event);
+} // namespace PairVertex
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef _plotVariableRegistry_hpp_
+#define _plotVariableRegistry_hpp_
+
+#include "plots.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Process-wide, immutable table of the plot variables, built on first use.
+// fillExp names are resolved to variable IDs when plots are booked, so the
+// plots themselves only keep the ID.
+class PlotVariableRegistry
+{
+    public:
+    struct Variable
+    {
+        std::string name;
+        unsigned dependencies; // DerivedCache::Dependency flags
+        Plots::ScalarFill fillScalar; // Only one of the two is set
+        Plots::VectorFill fillVector;
+    };
+
+    static const PlotVariableRegistry& instance();
+
+    PlotVariableRegistry(const PlotVariableRegistry&) = delete;
+    PlotVariableRegistry& operator=(const PlotVariableRegistry&) = delete;
+
+    // Throws if the name is unknown
+    unsigned id(const std::string& fillExp) const;
+    const Variable& variable(const unsigned id) const
+    {
+        return variables_[id];
+    }
+    size_t size() const
+    {
+        return variables_.size();
+    }
+    // Throws listing every unknown name, to be called before booking plots
+    void check(const std::vector<std::string>& fillExps) const;
+
+    private:
+    PlotVariableRegistry();
+
+    std::vector<Variable> variables_;
+    std::unordered_map<std::string, unsigned> ids_;
+};
+
+#endif
@@ -2,10 +2,13 @@
 #define _plots_hpp_
 
 #include "AnalysisEvent.hpp"
+#include "derivedCache.hpp"
+#include "histogramAccumulator.hpp"
+#include "multiWeightHistogram.hpp"
+
+#include <memory>
 
-#include <functional>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 typedef struct plot plot;
@@ -14,8 +17,52 @@ class TH1D;
 
 class Plots
 {
+    public:
+    // A plot variable either has exactly one value per event, returned
+    // directly (NaN if there is nothing to fill), or appends any number of
+    // values to a buffer which is reused between calls
+    using ScalarFill = DerivedCache::ScalarFill;
+    using VectorFill = DerivedCache::VectorFill;
+
+    // Definition of a plot variable, with the selection state it depends on
+    // (DerivedCache::Dependency flags)
+    template <typename Fill>
+    struct VariableDef
+    {
+        std::string name;
+        unsigned dependencies;
+        Fill fill;
+    };
+
+    // Memory held by a set of plots, see memoryUsage()
+    struct MemoryUsage
+    {
+        size_t plots;
+        size_t filled; // Histograms booked when flushing what was filled
+        size_t bookedEmpty; // Histograms booked empty for saving
+        size_t bytes;
+        size_t eagerBytes; // If every histogram had been booked up front
+    };
+
     private:
+    // Histograms are booked the first time something is added to them, or
+    // when getPlotPoint is called. Until then plotHist is null.
+    struct Binning
+    {
+        int nBins;
+        double min;
+        double max;
+    };
     std::vector<plot> plotPoint;
+    std::vector<Binning> binnings_;
+    size_t bookedEmpty_;
+    TH1D* histogram(const unsigned i);
+    // Filled instead of the histograms, see flush()
+    std::vector<HistogramAccumulator> accumulators_;
+    // Plots of the weight-only systematics filled along with these ones
+    std::vector<std::shared_ptr<Plots>> weightChannels_;
+    std::vector<MultiWeightHistogram> multiWeight_;
+    std::vector<double> channelWeights_;
 
     public:
     Plots(const std::vector<std::string> titles,
@@ -30,24 +77,37 @@ class Plots
           const std::string postfixName);
     ~Plots();
     void fillAllPlots(const AnalysisEvent& event, const double eventWeight);
+    // For filling from several threads: each thread fills its own set of
+    // accumulators, which are merged back in a fixed order
+    std::vector<HistogramAccumulator> newAccumulators() const;
+    void fillAllPlots(const AnalysisEvent& event, const double eventWeight, std::vector<HistogramAccumulator>& accumulators) const;
+    void merge(const std::vector<HistogramAccumulator>& accumulators);
+    // Fills the plots of the given weight-only systematics whenever these
+    // plots are filled for an event with AnalysisEvent::weightVariations set,
+    // one ratio to the nominal weight per channel. Replaces the previous
+    // channels, which are flushed first.
+    void setWeightChannels(std::vector<std::shared_ptr<Plots>> channels);
+    // Adds everything filled so far to the histograms. Must be called before
+    // the histograms are read or saved.
+    void flush();
     void saveAllPlots();
     void fillOnePlot(std::string, AnalysisEvent&, float);
     void saveOnePlots(int);
-    std::vector<plot> getPlotPoint()
-    {
-        return plotPoint;
-    }
-    std::unordered_map<std::string,
-                       std::function<std::vector<float>(const AnalysisEvent&)>>
-        getFncMap() const;
+    // Books any histogram which hasn't been yet, so all of them can be drawn
+    // or saved
+    std::vector<plot> getPlotPoint();
+    MemoryUsage memoryUsage() const;
+    static std::vector<VariableDef<ScalarFill>> getScalarVariables();
+    static std::vector<VariableDef<VectorFill>> getVectorVariables();
 };
 
 struct plot
 {
     std::string name;
+    std::string configName; // Name in the plot config, without the postfix
     std::string title;
-    TH1D* plotHist;
-    std::function<std::vector<float>(const AnalysisEvent&)> fillExp;
+    TH1D* plotHist; // Booked lazily, see Plots
+    unsigned variable; // ID in the PlotVariableRegistry
     std::string xAxisLabel;
     bool fillPlot;
 };
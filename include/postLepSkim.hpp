@@ -0,0 +1,50 @@
+#ifndef _postLepSkim_hpp_
+#define _postLepSkim_hpp_
+
+#include "cutClass.hpp"
+
+#include <string>
+#include <vector>
+
+class AnalysisEvent;
+class TDirectory;
+class TTree;
+
+// Post lepton selection skim made by -g. Copies only the configured branches
+// of the input tree, and adds the selection indices found for each event, so
+// that later passes over the skim don't have to read or store the rest.
+// Indices of selection steps the event didn't reach are -1 or empty.
+class PostLepSkim
+{
+    public:
+    // The branches are TTree::SetBranchStatus patterns. The input tree must
+    // already have its branch addresses set.
+    PostLepSkim(TTree* input, TDirectory* output, const std::vector<std::string>& branches);
+    ~PostLepSkim();
+    PostLepSkim(const PostLepSkim&) = delete;
+    PostLepSkim& operator=(const PostLepSkim&) = delete;
+
+    // Call after Cuts::makeCuts. Events which didn't pass the muon selection
+    // are not kept.
+    void fill(const AnalysisEvent& event, const Cuts::SelectionStep step);
+    TTree* tree() const
+    {
+        return tree_;
+    }
+
+    private:
+    TTree* tree_;
+
+    int selectionStep_;
+    std::vector<int> muonIndex_;
+    int zPairIndex1_;
+    int zPairIndex2_;
+    int mumuTrkIndex_;
+    std::vector<int> chsIndex_;
+    int chsPairIndex1_;
+    int chsPairIndex2_;
+    int chsPairTrkIndex_;
+    std::vector<int> jetIndex_;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _provenance_hpp_
+#define _provenance_hpp_
+
+#include <string>
+#include <vector>
+
+class Fingerprint;
+
+// Provenance of the files made from the inputs (skims, MVA trees,
+// histograms): a hash of the configs, code version and input files they were
+// made from, saved next to each as <file>.provenance once it is complete. A
+// file whose provenance matches needn't be made again, and one which doesn't
+// is out of date.
+namespace Provenance
+{
+// git describe of the code the executables were built from, followed by a
+// hash of the uncommitted changes if there are any
+std::string codeVersion();
+
+// Adds the contents of a file, e.g. a config. A missing file adds nothing
+// but its name.
+void addFile(Fingerprint& fingerprint, const std::string& file);
+// Adds the names, sizes and modification times of the ROOT files in the
+// locations of a dataset, without opening them
+void addInputs(Fingerprint& fingerprint, const std::vector<std::string>& locations);
+
+// The hash saved with a file, empty if it has none
+std::string read(const std::string& file);
+// Whether the file exists and was made with this hash
+bool matches(const std::string& file, const std::string& hash);
+// Call once the file is complete
+void stamp(const std::string& file, const std::string& hash);
+} // namespace Provenance
+
+#endif
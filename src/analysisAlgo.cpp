@@ -11,15 +11,26 @@
 #include "TTree.h"
 #include "analysisAlgo.hpp"
 #include "config_parser.hpp"
+#include "derivedColumnStore.hpp"
+#include "entryList.hpp"
+#include "fingerprint.hpp"
+#include "outputPolicy.hpp"
+#include "pairVertex.hpp"
+#include "plotVariableRegistry.hpp"
+#include "postLepSkim.hpp"
+#include "provenance.hpp"
 
 #include <LHAPDF/LHAPDF.h>
 #include <boost/filesystem.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/program_options.hpp>
+#include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
 
@@ -37,6 +48,19 @@ AnalysisAlgo::AnalysisAlgo()
     , is2018_{false}
     , doNPLs_{false}
     , doZplusCR_{false}
+    , separateWeightSysts{false}
+    , histoCompression{-1}
+    , plotWorkers{1}
+    , forcePlots{false}
+    , skimCompression{-1}
+    , skimConfig{{}, -1}
+    , outputPolicy{-1, -1, {}}
+    , entryListSkim{false}
+    , remake{false}
+    , ignoreProvenance{false}
+    , provenanceComplete{true}
+    , histogramsUpToDate{false}
+    , slimMva{false}
 {}
 
 AnalysisAlgo::~AnalysisAlgo() {}
@@ -54,8 +78,14 @@ void AnalysisAlgo::parseCommandLineArguements(int argc, char* argv[]){
     po::options_description desc("Options");
     desc.add_options()("help,h", "Print this message.")(
         "config,c",
-        po::value<std::string>(&config)->required(),
+        po::value<std::string>(&config),
         "The configuration file to be used.")(
+        "grid",
+        po::value<std::vector<std::string>>(&gridConfigs)->multitoken(),
+        "Run over several configuration files which differ only in their "
+        "signal datasets and output folder, e.g. a grid of signal points. "
+        "Each dataset is processed once and the plots of each configuration "
+        "are written to its own output folder.")(
         "2016",
         po::bool_switch(&is2016_),
         "Use 2016 conditions (SFs, et al.).")(
@@ -75,6 +105,17 @@ void AnalysisAlgo::parseCommandLineArguements(int argc, char* argv[]){
         "histoDir",
         po::value<std::string>(&histoDir)->default_value("histos/mz20mw50/"),
         "The output directory for the histos used to make the plots.")(
+        "histoCompression",
+        po::value<int>(&histoCompression)->default_value(-1),
+        "ROOT compression setting of the saved histos (e.g. 404 for LZ4 "
+        "level 4). The ROOT default if negative.")(
+        "plotWorkers",
+        po::value<unsigned>(&plotWorkers)->default_value(1),
+        "Number of processes drawing the plots.")(
+        "forcePlots",
+        po::bool_switch(&forcePlots),
+        "Redraw every plot, even those whose inputs haven't changed since "
+        "they were last drawn.")(
         "outFolder,o",
         po::value<std::string>(&outFolder)->default_value("plots/"),
         "The output directory for the plots. Overrides the config file.")(
@@ -114,15 +155,69 @@ void AnalysisAlgo::parseCommandLineArguements(int argc, char* argv[]){
         ",g",
         po::bool_switch(&makePostLepTree),
         "Make post lepton selection trees and bTag efficiencies.")(
+        "skimConf",
+        po::value<std::string>(&skimConfName)->default_value("configs/skims/postLepSelSkim.yaml"),
+        "Branches and compression of the post lepton selection trees.")(
+        "skimCompression",
+        po::value<int>(&skimCompression)->default_value(-1),
+        "ROOT compression setting of the post lepton selection trees (e.g. "
+        "404 for LZ4 level 4). Overrides --skimConf if not negative.")(
+        "outputPolicy",
+        po::value<std::string>(&outputPolicyName),
+        "Compression and basket sizes of the branches of the skims and MVA "
+        "trees, e.g. made by tuneCompression.exe. Branches it matches take "
+        "its settings over --skimConf.")(
+        "entryListSkim",
+        po::bool_switch(&entryListSkim),
+        "With -g, save the entries of the inputs passing the lepton selection "
+        "instead of a copy of the events. With -u, run over the passing "
+        "entries of the original inputs.")(
+        "entryList",
+        po::value<std::string>(&entryListName),
+        "Only run over the entries in this entry list, e.g. one combined by "
+        "combineEntryLists.exe. With -u --entryListSkim, the entries must "
+        "also be in the skim entry list.")(
+        "skimDir",
+        po::value<std::string>(&skimDir),
+        "Directory of the post lepton selection skims, written by -g and read "
+        "by -u. Defaults to the IIHE ones of the era.")(
+        "remake",
+        po::bool_switch(&remake),
+        "Remake skims, MVA trees and histograms even if their provenance "
+        "shows they are up to date.")(
+        "ignoreProvenance",
+        po::bool_switch(&ignoreProvenance),
+        "Use skims made from other configs, code or inputs than the current "
+        "ones, with a warning.")(
+        "catalogDir",
+        po::value<std::string>(&catalogDir)->default_value("catalogs/"),
+        "Directory of the catalogs of the dataset locations, listing their "
+        "files with their entries so that they needn't be opened to count "
+        "them. Catalogs are updated for files added or changed since. Empty "
+        "to add the files by wildcard.")(
+        "derivedDir",
+        po::value<std::string>(&derivedDir),
+        "Directory of the derived column store. The track pair vertices of "
+        "each input file are computed once, saved there, and read back in "
+        "later runs.")(
         ",u",
         po::bool_switch(&usePostLepTree),
         "Use post lepton selection trees.")(
         "makeMVATree,z",
         po::bool_switch(&makeMVATree),
         "Produce trees after event selection for multivariate analysis.")(
+        "slimMva",
+        po::bool_switch(&slimMva),
+        "With -z, write the events selected by any systematic once, with the "
+        "selection of each systematic in its own slim tree referring to them.")(
         "syst,v",
         po::value<int>(&systToRun)->default_value(0),
         "Mask for systematics to be run. 65535 enables all systematics.")(
+        "separateWeightSysts",
+        po::bool_switch(&separateWeightSysts),
+        "Run the selection separately for systematics which only change the "
+        "event weight. By default they are filled in the nominal pass when "
+        "only making plots.")(
         "channels,k",
         po::value<int>(&channelsToRun)->default_value(2),
         "Mask describing the channels to be run over. The mask "
@@ -139,6 +234,11 @@ void AnalysisAlgo::parseCommandLineArguements(int argc, char* argv[]){
         "mvaDir",
         po::value<std::string>(&mvaDir),
         "Output directory for the MVA files.")(
+        "scanDir",
+        po::value<std::string>(&scanDir),
+        "Run the working point scan given in the cut configuration and write "
+        "the yields and cut flows of each point to this directory. No events "
+        "pass the nominal selection in this mode.")(
         "jetRegion",
         po::value<std::vector<unsigned>>(&jetRegVars),
         "Set a sustom jet region in the format NJETS NBJETS MAXJETS MAXBJETS.")(
@@ -175,9 +275,14 @@ void AnalysisAlgo::parseCommandLineArguements(int argc, char* argv[]){
                 "condition to be BOTH 2016 AND 2018! Chose only "
                 " one or none!");
         }
-        if (vm.count("channels") && !vm.count("config")) {
+        if (vm.count("config") == vm.count("grid")) {
             throw std::logic_error(
-                "--channels requires --config to be specified");
+                "Exactly one of --config and --grid must be given");
+        }
+        if (vm.count("grid") && doNPLs_) {
+            throw std::logic_error(
+                "--NPLs can't be used with --grid as the NPL shapes are made "
+                "from every dataset");
         }
         if (vm.count("jetRegion")) {
             if (jetRegVars.size() != 4) {
@@ -205,12 +310,40 @@ void AnalysisAlgo::parseCommandLineArguements(int argc, char* argv[]){
     if (vm.count("plotConf")) {
         plots = true;
     }
+    // Generator weight sums are cached alongside the catalogs
+    Dataset::setCacheDir(catalogDir);
 
     // Some vectors that will be filled in the parsing.
     totalLumi = 0;
 
     try {
-        Parser::parse_config(config, datasets, totalLumi, plotTitles, plotNames, xMin, xMax, nBins, fillExp, xAxisLabels, cutStage, cutConfName, plotConfName, outFolder, postfix, channel, usePostLepTree,  doNPLs_);
+        // For a grid, everything is taken from the first config and the
+        // datasets only in the other configs are added on
+        std::vector<std::string> gridDatasetConfs;
+        if (!gridConfigs.empty()) {
+            gridDatasetConfs = Parser::parse_grid(gridConfigs, gridPoints);
+            config = gridConfigs.front();
+        }
+        // With --entryListSkim, -u reads the selected entries of the
+        // original ntuples rather than skim trees
+        const bool readsSkimTrees{usePostLepTree && !entryListSkim};
+        Parser::parse_config(config, datasets, totalLumi, plotTitles, plotNames, xMin, xMax, nBins, fillExp, xAxisLabels, cutStage, cutConfName, plotConfName, outFolder, postfix, channel, readsSkimTrees, doNPLs_);
+        if (!gridDatasetConfs.empty()) {
+            Parser::parse_files(gridDatasetConfs, datasets, totalLumi, readsSkimTrees, doNPLs_);
+        }
+        // Catch typos in the plot config before any plots are booked
+        if (plots) {
+            PlotVariableRegistry::instance().check(fillExp);
+        }
+        if (makePostLepTree) {
+            skimConfig = Parser::parse_skim(skimConfName);
+            if (skimCompression >= 0) {
+                skimConfig.compression = skimCompression;
+            }
+        }
+        if (!outputPolicyName.empty()) {
+            outputPolicy = Parser::parse_output_policy(outputPolicyName);
+        }
     }
     catch (const std::exception)  {
         std::cerr << "ERROR Problem with a confugration file, see previous "
@@ -372,6 +505,12 @@ void AnalysisAlgo::setupCuts()
     {
         cutObj->setZplusControlRegionFlag(true);
     }
+    // Must come last as the scan takes the nominal cuts set above
+    if (!scanDir.empty())
+    {
+        cutObj->enableScan();
+        boost::filesystem::create_directories(scanDir);
+    }
 }
 
 void AnalysisAlgo::setupPlots()
@@ -400,8 +539,26 @@ void AnalysisAlgo::runMainAnalysis() {
     if (is2016_) era = "2016";
     else if (is2018_) era = "2018";
     else era = "2017";
-    const std::string postLepSelSkimOutputDir{std::string{"/user/almorton/HToSS_analysis/postLepSkims"} + era + "/"};
-    const std::string postLepSelSkimInputDir{std::string{"/pnfs/iihe/cms/store/user/almorton/MC/postLepSkims/postLepSkims"} + era + "/"};
+    const std::string postLepSelSkimOutputDir{skimDir.empty() ? std::string{"/user/almorton/HToSS_analysis/postLepSkims"} + era + "/" : skimDir + "/"};
+    const std::string postLepSelSkimInputDir{skimDir.empty() ? std::string{"/pnfs/iihe/cms/store/user/almorton/MC/postLepSkims/postLepSkims"} + era + "/" : skimDir + "/"};
+    if (makePostLepTree) {
+        boost::filesystem::create_directories(postLepSelSkimOutputDir);
+    }
+
+    // Histograms already made from the same configs, code and inputs are
+    // kept as they are
+    if (makeHistos && plots) {
+        histoProvenance = histogramProvenance();
+        const std::vector<std::string> files{histogramFiles()};
+        histogramsUpToDate = !remake && !makePostLepTree && !makeMVATree
+                             && std::all_of(files.begin(), files.end(), [this](const std::string& file) {
+                                    return Provenance::matches(file, histoProvenance);
+                                });
+        if (histogramsUpToDate) {
+            std::cout << "Histograms in " << histoDir << " are up to date, not remaking them" << std::endl;
+            return;
+        }
+    }
 
 
     // Begin to loop over all datasets
@@ -449,7 +606,7 @@ void AnalysisAlgo::runMainAnalysis() {
                         == cutFlowMap.end())
                     {
                         const size_t numCutFlowBins{stageNames.size()};
-                        cutFlowMap[histoName] = new TH1D{
+                        cutFlowMap[histoName + systNames[systInd]] = new TH1D{
                             (histoName + systNames[systInd] + "cutFlow")
                                 .c_str(),
                             (histoName + systNames[systInd] + "cutFlow")
@@ -457,6 +614,12 @@ void AnalysisAlgo::runMainAnalysis() {
                             boost::numeric_cast<int>(numCutFlowBins),
                             0,
                             boost::numeric_cast<double>(numCutFlowBins)};
+                        std::vector<std::string> cutFlowStages;
+                        for (const auto& stage : stageNames)
+                        {
+                            cutFlowStages.emplace_back(stage.first);
+                        }
+                        cutFlowCounters.emplace(std::make_pair(histoName, systInd), CutFlow{cutFlowStages});
                         if (systInd == 0
                             && datasetInfos.find(histoName)
                                    == datasetInfos.end())
@@ -473,7 +636,7 @@ void AnalysisAlgo::runMainAnalysis() {
                             std::cout << "Made plots under " << histoName
                                       << " : " << systNames[systInd] + channel
                                       << std::endl;
-                            if (plotsMap.find(channel) == plotsMap.end())
+                            if (plotsMap.find(systNames[systInd] + channel) == plotsMap.end())
                             {
                                 plotsVec.emplace_back(systNames[systInd]
                                                       + channel);
@@ -512,11 +675,28 @@ void AnalysisAlgo::runMainAnalysis() {
             if (plots && useHistos)
                 continue;
 
+            // Skims and MVA trees already made from the same configs, code
+            // and inputs are kept, and the dataset is skipped if there is
+            // nothing else to make
+            bool datasetProvenanceComplete{true};
+            const std::string skimOutputFile{postLepSelSkimOutputDir + dataset->name() + postfix + (invertLepCut ? "invLep" : "") + "SmallSkim.root"};
+            const std::string mvaOutputFile{mvaDir + dataset->name() + postfix + (invertLepCut ? "invLep" : "") + "mvaOut.root"};
+            const std::string skimProvenance{makePostLepTree ? datasetProvenance(*dataset, "skim", invertLepCut) : ""};
+            const std::string mvaProvenance{makeMVATree ? datasetProvenance(*dataset, "mva", invertLepCut) : ""};
+            if (!remake && !plots && (makePostLepTree || makeMVATree)
+                && (!makePostLepTree || Provenance::matches(skimOutputFile, skimProvenance))
+                && (!makeMVATree || Provenance::matches(mvaOutputFile, mvaProvenance))) {
+                std::cout << "Outputs of " << dataset->name() << " " << chanName
+                          << " are up to date, skipping" << std::endl;
+                continue;
+            }
+
             // If making either plots, make cut flow object.
             std::cerr << "Processing dataset " << dataset->name() << std::endl;
-            if (!usePostLepTree) {
+            std::string skimEntryListFile;
+            if (!usePostLepTree || entryListSkim) {
                 if (!datasetFilled) {
-                    if (!dataset->fillChain(datasetChain)) {
+                    if (!dataset->fillChain(datasetChain, catalogDir)) {
                         std::cerr
                             << "There was a problem constructing the chain for "
                             << dataset->name() << ". Continuing with next dataset.\n";
@@ -525,7 +705,7 @@ void AnalysisAlgo::runMainAnalysis() {
                     datasetFilled = true;
                 }
             }
-            else {
+            if (usePostLepTree) {
                 std::string inputPostfix{};
                 inputPostfix += postfix;
                 if (invertLepCut)
@@ -547,12 +727,30 @@ void AnalysisAlgo::runMainAnalysis() {
                     cutObj->setNplFlag(false);
                     cutObj->setInvLepCut(false);
                 }
-                std::cout << postLepSelSkimInputDir + dataset->name() + inputPostfix
-                                 + "SmallSkim.root"
-                          << std::endl;
-                datasetChain->Add((postLepSelSkimInputDir + dataset->name()
-                                   + inputPostfix + "SmallSkim.root")
-                                      .c_str());
+                // Skims from other configs, code or inputs would silently
+                // give other results
+                const std::string skimInputFile{postLepSelSkimInputDir + dataset->name() + inputPostfix + "SmallSkim.root"};
+                const bool invertedLeptons{inputPostfix.find("invLep") != std::string::npos};
+                if (!Provenance::matches(skimInputFile, datasetProvenance(*dataset, "skim", invertedLeptons))) {
+                    const std::string message{skimInputFile + " wasn't made from the current configs, code and inputs of " + dataset->name()};
+                    if (!ignoreProvenance) {
+                        throw std::runtime_error(message + ". Remake it with -g, or pass --ignoreProvenance.");
+                    }
+                    std::cerr << "WARNING: " << message << std::endl;
+                    datasetProvenanceComplete = false;
+                }
+                if (entryListSkim) {
+                    skimEntryListFile = postLepSelSkimInputDir + dataset->name() + inputPostfix + "SmallSkim.entries";
+                    std::cout << skimEntryListFile << std::endl;
+                }
+                else {
+                    std::cout << postLepSelSkimInputDir + dataset->name() + inputPostfix
+                                     + "SmallSkim.root"
+                              << std::endl;
+                    datasetChain->Add((postLepSelSkimInputDir + dataset->name()
+                                       + inputPostfix + "SmallSkim.root")
+                                          .c_str());
+                }
             }
 
             cutObj->setMC(dataset->isMC());
@@ -666,7 +864,9 @@ void AnalysisAlgo::runMainAnalysis() {
             // Adding in some stuff here to make a skim file out of post lep sel
             // stuff
             TFile* outFile1{nullptr};
-            TTree* cloneTree{nullptr};
+            std::unique_ptr<PostLepSkim> postLepSkim;
+            // Or only the entries passing, in entry list mode
+            std::vector<long long> skimEntries;
 
             // If we're making the post lepton selection trees, set them up
             // here.
@@ -676,14 +876,22 @@ void AnalysisAlgo::runMainAnalysis() {
                     invPostFix = "invLep";
 
                 outFile1 = new TFile{(postLepSelSkimOutputDir + dataset->name() + postfix + invPostFix + "SmallSkim.root").c_str(), "RECREATE"};
-                cloneTree = datasetChain->CloneTree(0);
-                cloneTree->SetDirectory(outFile1);
-                cutObj->setCloneTree(cloneTree);
+                if (skimConfig.compression >= 0) {
+                    outFile1->SetCompressionSettings(skimConfig.compression);
+                }
+                if (!entryListSkim) {
+                    postLepSkim.reset(new PostLepSkim{datasetChain, outFile1, skimConfig.branches});
+                    applyOutputPolicy(outputPolicy, postLepSkim->tree());
+                }
             }
 
             // If we're making the MVA tree, set it up here.
             TFile* mvaOutFile{nullptr};
             std::vector<TTree*> mvaTree;
+            // With --slimMva, the events selected by any systematic, which
+            // the systematic trees refer to by entry
+            TTree* mvaPayload{nullptr};
+            long long payloadEntry{-1};
             // Add a few variables into the MVA tree for easy access of stuff
             // like lepton index etc
             double eventWeight{0.};
@@ -712,7 +920,8 @@ void AnalysisAlgo::runMainAnalysis() {
                                         + "mvaOut.root")
                                            .c_str(),
                                        "RECREATE"};
-                mvaOutFile->SetCompressionSettings(ROOT::CompressionSettings(ROOT::kLZ4, 4));
+                mvaOutFile->SetCompressionSettings(outputPolicy.compression >= 0 ? outputPolicy.compression
+                                                                                 : ROOT::CompressionSettings(ROOT::kLZ4, 4));
                 if (!mvaOutFile->IsOpen())
                 {
                     throw std::runtime_error(
@@ -731,11 +940,22 @@ void AnalysisAlgo::runMainAnalysis() {
                       if (systIn > 0) systMask = systMask << 1;
                       continue;
                       }*/
-                    mvaTree.emplace_back(datasetChain->CloneTree(0));
-                    mvaTree[systIn]->SetDirectory(mvaOutFile);
-                    mvaTree[systIn]->SetName(
-                        (mvaTree[systIn]->GetName() + systNames[systIn])
-                            .c_str());
+                    if (slimMva)
+                    {
+                        mvaTree.emplace_back(new TTree{
+                            (datasetChain->GetName() + systNames[systIn]).c_str(),
+                            ("Selection of the " + std::string{datasetChain->GetName()} + " payload").c_str()});
+                        mvaTree[systIn]->SetDirectory(mvaOutFile);
+                        mvaTree[systIn]->Branch("payloadEntry", &payloadEntry, "payloadEntry/L");
+                    }
+                    else
+                    {
+                        mvaTree.emplace_back(datasetChain->CloneTree(0));
+                        mvaTree[systIn]->SetDirectory(mvaOutFile);
+                        mvaTree[systIn]->SetName(
+                            (mvaTree[systIn]->GetName() + systNames[systIn])
+                                .c_str());
+                    }
                     mvaTree[systIn]->Branch("eventWeight", &eventWeight, "eventWeight/D");
                     mvaTree[systIn]->Branch(
                         "zLep1Index", &zLep1Index, "zLep1Index/I");
@@ -753,19 +973,50 @@ void AnalysisAlgo::runMainAnalysis() {
                     mvaTree[systIn]->Branch(
                         "bJetInd", &bJetInd, "bJetInd[10]/I");
                     mvaTree[systIn]->Branch("isMC", &isMC, "isMC/I");
+                    applyOutputPolicy(outputPolicy, mvaTree[systIn]);
                     if (systIn > 0)
                     {
                         systMask = systMask << 1;
                     }
                 }
+                if (slimMva)
+                {
+                    mvaPayload = datasetChain->CloneTree(0);
+                    mvaPayload->SetDirectory(mvaOutFile);
+                    mvaPayload->SetName("payload");
+                    applyOutputPolicy(outputPolicy, mvaPayload);
+                }
                 std::cout << std::endl;
             }
 
-            long long numberOfEvents{datasetChain->GetEntries()};
+            // Derived columns are read with the rest of the event rather
+            // than computed
+            std::unique_ptr<DerivedColumnStore> derivedColumns;
+            if (!derivedDir.empty()) {
+                derivedColumns.reset(new DerivedColumnStore{derivedDir, dataset->isMC(), is2016_, is2018_});
+                derivedColumns->attach(*datasetChain, event);
+            }
+
+            // Entries to run over, if not all of them
+            const bool useEntryList{!skimEntryListFile.empty() || !entryListName.empty()};
+            std::vector<long long> selectedEntries;
+            if (useEntryList) {
+                EntryList entryList{skimEntryListFile.empty() ? entryListName : skimEntryListFile};
+                if (!skimEntryListFile.empty() && !entryListName.empty()) {
+                    entryList.intersect(EntryList{entryListName});
+                }
+                selectedEntries = entryList.chainEntries(*datasetChain);
+                std::cout << "Running over " << selectedEntries.size()
+                          << " entries of the entry list" << std::endl;
+            }
+
+            long long numberOfEvents{useEntryList ? static_cast<long long>(selectedEntries.size()) : datasetChain->GetEntries()};
             if (nEvents && nEvents < numberOfEvents)
             {
                 numberOfEvents = nEvents;
+                datasetProvenanceComplete = false;
             }
+            provenanceComplete = provenanceComplete && datasetProvenanceComplete;
             //    datasetChain->Draw("numElePF2PAT","numMuonPF2PAT > 2");
             //    TH1F * htemp = (TH1F*)gPad->GetPrimitive("htemp");
             //    htemp->SaveAs("tempCanvas.png");
@@ -810,6 +1061,72 @@ void AnalysisAlgo::runMainAnalysis() {
                hasLHE = false;
             }
 
+            cutObj->resetPipeline();
+            if (!scanDir.empty()) {
+                cutObj->resetScan();
+            }
+
+            // When only plotting, systematics which just change the event
+            // weight are filled along with the nominal rather than running
+            // the selection again for each of them
+            std::vector<int> foldedSystMasks;
+            if (plots && dataset->isMC() && !separateWeightSysts && !makeMVATree && !makePostLepTree) {
+                const std::string histoName{dataset->getFillHisto()};
+                std::vector<unsigned> foldedSystInds;
+                std::vector<CutFlow*> weightCutFlows;
+                int systMask{1};
+                for (unsigned systInd{1}; systInd < systNames.size(); systInd++) {
+                    if ((systToRun & systMask) && isWeightOnlySystematic(systMask, dataset->name())) {
+                        foldedSystMasks.emplace_back(systMask);
+                        foldedSystInds.emplace_back(systInd);
+                        weightCutFlows.emplace_back(&cutFlowCounters.at({histoName, systInd}));
+                    }
+                    systMask = systMask << 1;
+                }
+                for (auto& stagePlots : plotsMap[channel][histoName]) {
+                    std::vector<std::shared_ptr<Plots>> weightChannels;
+                    for (const unsigned systInd : foldedSystInds) {
+                        weightChannels.emplace_back(plotsMap[systNames[systInd] + channel][histoName][stagePlots.first]);
+                    }
+                    stagePlots.second->setWeightChannels(weightChannels);
+                }
+                cutObj->setWeightCutFlows(weightCutFlows);
+            }
+            else if (plots) {
+                for (auto& stagePlots : plotsMap[channel][dataset->getFillHisto()]) {
+                    stagePlots.second->setWeightChannels({});
+                }
+                cutObj->setWeightCutFlows({});
+            }
+
+            // Plots and cut flow of each systematic run, looked up once here
+            // rather than for every event
+            std::vector<std::map<std::string, std::shared_ptr<Plots>>*> systPlots(systNames.size(), nullptr);
+            std::vector<CutFlow*> systCutFlows(systNames.size(), nullptr);
+            // Without plots no cut flows are booked, and makeCuts doesn't
+            // fill the one it is given
+            CutFlow unbookedCutFlow{std::vector<std::string>{}};
+            {
+                const std::string histoName{dataset->getFillHisto()};
+                int systMask{1};
+                for (unsigned systInd{0}; systInd < systNames.size(); systInd++) {
+                    if (systInd == 0 || (systToRun & systMask)) {
+                        const auto cutFlow{cutFlowCounters.find({histoName, systInd})};
+                        if (cutFlow != cutFlowCounters.end()) {
+                            systCutFlows[systInd] = &cutFlow->second;
+                        }
+                        else if (!plots) {
+                            systCutFlows[systInd] = &unbookedCutFlow;
+                        }
+                        else {
+                            throw std::logic_error("No cut flow booked for " + histoName + systNames[systInd]);
+                        }
+                        systPlots[systInd] = &plotsMap[systNames[systInd] + channel][histoName];
+                    }
+                    if (systInd > 0) systMask = systMask << 1;
+                }
+            }
+
             TMVA::Timer* lEventTimer{
                 new TMVA::Timer{boost::numeric_cast<int>(numberOfEvents), "Running over dataset ...", false}};
             lEventTimer->DrawProgressBar(0, "");
@@ -818,7 +1135,23 @@ void AnalysisAlgo::runMainAnalysis() {
                 lSStrFoundEvents << foundEvents;
                 lEventTimer->DrawProgressBar(
                     i, ("Found " + lSStrFoundEvents.str() + " events."));
-                event.GetEntry(i);
+                const long long entry{useEntryList ? selectedEntries[i] : i};
+                event.GetEntry(entry);
+                payloadEntry = -1;
+                // Pair vertex quantities don't depend on the systematic
+                if (!derivedColumns) {
+                    PairVertex::compute(event);
+                }
+                // Weight-only systematics ride along with the nominal pass,
+                // unless the nominal weight vanishes for this event
+                event.weightVariations.clear();
+                for (const int systMask : foldedSystMasks) {
+                    event.weightVariations.emplace_back(weightVariation(event, systMask, hasLHE));
+                }
+                if (!std::all_of(event.weightVariations.begin(), event.weightVariations.end(), [](const double ratio) { return std::isfinite(ratio); })) {
+                    event.weightVariations.clear();
+                }
+                const bool weightsFolded{!event.weightVariations.empty()};
                 // Do the systematics indicated by the systematic flag, oooor
                 // just do data if that's your thing. Whatevs.
                 int systMask{1};
@@ -837,6 +1170,17 @@ void AnalysisAlgo::runMainAnalysis() {
                         }
                         continue;
                     }
+                    if (systInd > 0)
+                    {
+                        // Only the nominal pass fills the weight variations
+                        event.weightVariations.clear();
+                        if (weightsFolded
+                            && std::find(foldedSystMasks.begin(), foldedSystMasks.end(), systMask) != foldedSystMasks.end())
+                        {
+                            systMask = systMask << 1;
+                            continue;
+                        }
+                    }
 
                     eventWeight = 1;
 
@@ -928,15 +1272,72 @@ void AnalysisAlgo::runMainAnalysis() {
                     //          std::cout << "eventWeight: " << eventWeight <<
                     //          std::endl;
 
+                    // LHE PDF, alpha_s and PS weights, applied before the
+                    // selection so that they reach the plots and cut flows,
+                    // as they do when folded into the nominal pass
+                    if ((systMask == 1024 || systMask == 2048)
+                        && isWeightOnlySystematic(systMask, dataset->name()))
+                    {
+                        if (systMask == 1024)
+                        {
+                            eventWeight *= event.weight_pdfMax; // Max
+                        }
+                        if (systMask == 2048)
+                        {
+                            eventWeight *= event.weight_pdfMin; // Min
+                        }
+                    }
+                    if (systMask == 16384 || systMask == 32768)
+                    {
+                        if (systMask == 16384)
+                        {
+                            eventWeight *=
+                                event.weight_alphaMin; // Max, but incorrectly
+                                                       // named branch
+                        }
+                        if (systMask == 32768)
+                        {
+                            eventWeight *=
+                                event.weight_alphaMax; // Min, but incorrectly
+                                                       // named branch
+                        }
+                    }
+
+                    // PSWeights
+                    if (systMask == 65536)
+                    {
+                        eventWeight *= event.isrDefLo;
+                    }
+                    if (systMask == 131072)
+                    {
+                        eventWeight *= event.isrDefHi;
+                    }
+                    if (systMask == 262144)
+                    {
+                        eventWeight *= event.fsrDefLo;
+                    }
+                    if (systMask == 524288)
+                    {
+                        eventWeight *= event.fsrDefHi;
+                    }
+
                     //	  std::cout << "channel: " << channel << std::endl;
-                    std::string histoName{dataset->getFillHisto()};
-
-                    if (!cutObj->makeCuts(
-                            event,
-                            eventWeight,
-                            plotsMap[systNames[systInd] + channel][histoName],
-                            *cutFlowMap[histoName + systNames[systInd]],
-                            systInd ? systMask : systInd))
+                    const bool passedCuts{cutObj->makeCuts(
+                        event,
+                        eventWeight,
+                        *systPlots[systInd],
+                        *systCutFlows[systInd],
+                        systInd ? systMask : systInd)};
+                    if (postLepSkim)
+                    {
+                        postLepSkim->fill(event, cutObj->lastStep());
+                    }
+                    else if (makePostLepTree && cutObj->lastStep() >= Cuts::SelectionStep::Muons
+                             && (skimEntries.empty() || skimEntries.back() != entry))
+                    {
+                        skimEntries.push_back(entry);
+                    }
+                    if (!passedCuts)
                     {
                         if (systInd)
                         {
@@ -946,8 +1347,8 @@ void AnalysisAlgo::runMainAnalysis() {
                     }
 
                     // Do Run 1 style PDF reweighting things for tW samples as
-                    // they use Powerheg V1 Everything else uses LHE event
-                    // weights
+                    // they use Powerheg V1. Everything else uses LHE event
+                    // weights, applied before the selection.
                     if (systMask == 1024 || systMask == 2048) {
                         if (is2016_ && (dataset->name() == "tWInclusive"
                                 || dataset->name() == "tbarWInclusive"
@@ -1035,51 +1436,6 @@ void AnalysisAlgo::runMainAnalysis() {
                             // << std::setprecision(9) << " " << min << " " <<
                             // max << " " << eventWeight << std::endl;
                         }
-                        // LHE event weights for everything else
-                        else
-                        {
-                            if (systMask == 1024)
-                            {
-                                eventWeight *= event.weight_pdfMax; // Max
-                            }
-                            if (systMask == 2048)
-                            {
-                                eventWeight *= event.weight_pdfMin; // Min
-                            }
-                        }
-                    }
-                    if (systMask == 16384 || systMask == 32768)
-                    {
-                        if (systMask == 16384)
-                        {
-                            eventWeight *=
-                                event.weight_alphaMin; // Max, but incorrectly
-                                                       // named branch
-                        }
-                        if (systMask == 32768)
-                        {
-                            eventWeight *=
-                                event.weight_alphaMax; // Min, but incorrectly
-                                                       // named branch
-                        }
-                    }
-
-                    // PSWeights
-                    if (systMask == 65536)
-                    {
-                        eventWeight *= event.isrDefLo;
-                    }
-                    if (systMask == 131072)
-                    {
-                        eventWeight *= event.isrDefHi;
-                    }
-                    if (systMask == 262144)
-                    {
-                        eventWeight *= event.fsrDefLo;
-                    }
-                    if (systMask == 524288)
-                    {
-                        eventWeight *= event.fsrDefHi;
                     }
 
                     // Do the Zpt reweighting here
@@ -1118,6 +1474,11 @@ void AnalysisAlgo::runMainAnalysis() {
                         {
                             muonMomentumSF[i] = event.muonMomentumSF[i];
                         }
+                        if (mvaPayload && payloadEntry < 0)
+                        {
+                            mvaPayload->Fill();
+                            payloadEntry = mvaPayload->GetEntries() - 1;
+                        }
                         mvaTree[systInd]->Fill();
                     }
 
@@ -1134,12 +1495,30 @@ void AnalysisAlgo::runMainAnalysis() {
             if (makePostLepTree)
             {
                 outFile1->cd();
-                std::cout << "\nPrinting some info on the tree "
-                          << dataset->name() << " " << cloneTree->GetEntries()
-                          << std::endl;
-                std::cout << "But there were :" << datasetChain->GetEntries()
-                          << " entries in the original tree" << std::endl;
-                cloneTree->Write();
+                if (postLepSkim)
+                {
+                    std::cout << "\nPrinting some info on the tree "
+                              << dataset->name() << " " << postLepSkim->tree()->GetEntries()
+                              << std::endl;
+                    std::cout << "But there were :" << datasetChain->GetEntries()
+                              << " entries in the original tree" << std::endl;
+                    postLepSkim->tree()->Write();
+                }
+                else
+                {
+                    // The histograms below are still saved in the skim file
+                    std::string invPostFix;
+                    if (invertLepCut)
+                        invPostFix = "invLep";
+                    const std::string entryListFile{postLepSelSkimOutputDir + dataset->name() + postfix + invPostFix + "SmallSkim.entries"};
+                    EntryList entryList;
+                    entryList.add(*datasetChain, skimEntries);
+                    entryList.write(entryListFile);
+                    std::cout << "\nSaved " << skimEntries.size() << " of "
+                              << datasetChain->GetEntries() << " entries of "
+                              << dataset->name() << " to " << entryListFile
+                              << std::endl;
+                }
                 // Write out mc generator level info
                 if (dataset->isMC())
                 {
@@ -1150,11 +1529,14 @@ void AnalysisAlgo::runMainAnalysis() {
                     bTagEffPlots[i]->Write();
                 }
 
-                delete cloneTree;
-                cloneTree = nullptr;
+                postLepSkim.reset();
                 outFile1->Write();
                 outFile1->Close();
                 outFile1 = nullptr;
+                if (datasetProvenanceComplete)
+                {
+                    Provenance::stamp(skimOutputFile, skimProvenance);
+                }
             }
 
             // Save mva outputs
@@ -1194,6 +1576,11 @@ void AnalysisAlgo::runMainAnalysis() {
                         break;
                     }
                 }
+                if (mvaPayload)
+                {
+                    std::cout << "payload: " << mvaPayload->GetEntriesFast();
+                    mvaPayload->FlushBaskets();
+                }
                 std::cout << std::endl;
                 // Save the efficiency plots for b-tagging here if we're doing
                 // that.
@@ -1209,10 +1596,21 @@ void AnalysisAlgo::runMainAnalysis() {
                 {
                     delete mvaTree[i];
                 }
+                delete mvaPayload;
                 mvaOutFile->Close();
+                if (datasetProvenanceComplete)
+                {
+                    Provenance::stamp(mvaOutputFile, mvaProvenance);
+                }
             }
             std::cerr << "\nFound " << foundEvents << " in " << dataset->name() << std::endl;
             std::cerr << "Found " << foundEventsNorm << " after normalisation in " << dataset->name() << std::endl;
+            cutObj->printPipelineSummary();
+            event.derivedCache.printSummary(std::cout);
+            event.derivedCache.resetCounters();
+            if (!scanDir.empty()) {
+                cutObj->writeScan(scanDir + "/" + dataset->name() + postfix + "_" + chanName + "Scan.txt");
+            }
             std::cerr << "\n\n";
             // Delete generator level plot. Avoid memory leaks, kids.
             delete generatorWeightPlot;
@@ -1233,6 +1631,270 @@ void AnalysisAlgo::runMainAnalysis() {
 }
 
 void AnalysisAlgo::savePlots()
+{
+    if (histogramsUpToDate)
+    {
+        return;
+    }
+    // Plots and cut flows are filled through accumulators, move their
+    // contents into the histograms before anything reads them
+    writeCutFlowTable();
+    for (auto& cutFlow : cutFlowCounters)
+    {
+        cutFlow.second.addTo(*cutFlowMap.at(cutFlow.first.first + systNames[cutFlow.first.second]));
+        cutFlow.second.reset();
+    }
+    for (auto& systChannel : plotsMap)
+    {
+        for (auto& histoPlots : systChannel.second)
+        {
+            for (auto& stagePlots : histoPlots.second)
+            {
+                stagePlots.second->flush();
+            }
+        }
+    }
+
+    if (gridPoints.empty())
+    {
+        makePlots(plotsMap, cutFlowMap, legOrder, plotOrder, datasetInfos, outFolder, histoDir);
+        printPlotMemory();
+        return;
+    }
+
+    // Write out each grid point as if it had been run on its own, using only
+    // the histograms filled by its datasets
+    for (const auto& point : gridPoints)
+    {
+        const auto inPoint{[&point](const std::string& histoName) {
+            return std::find(point.histograms.begin(), point.histograms.end(), histoName) != point.histograms.end();
+        }};
+
+        std::map<std::string, std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>> pointPlots;
+        for (const auto& systChannel : plotsVec)
+        {
+            pointPlots[systChannel] = {};
+            for (const auto& histoPlots : plotsMap[systChannel])
+            {
+                if (inPoint(histoPlots.first))
+                {
+                    pointPlots[systChannel].insert(histoPlots);
+                }
+            }
+        }
+        std::map<std::string, TH1D*> pointCutFlows;
+        for (const auto& cutFlow : cutFlowMap)
+        {
+            for (const auto& systName : systNames)
+            {
+                if (cutFlow.first.size() >= systName.size()
+                    && inPoint(cutFlow.first.substr(0, cutFlow.first.size() - systName.size()))
+                    && cutFlow.first.compare(cutFlow.first.size() - systName.size(), std::string::npos, systName) == 0)
+                {
+                    pointCutFlows.insert(cutFlow);
+                    break;
+                }
+            }
+        }
+        std::vector<std::string> pointLegOrder;
+        std::copy_if(legOrder.begin(), legOrder.end(), std::back_inserter(pointLegOrder), inPoint);
+        std::vector<std::string> pointPlotOrder;
+        std::copy_if(plotOrder.begin(), plotOrder.end(), std::back_inserter(pointPlotOrder), inPoint);
+        std::map<std::string, datasetInfo> pointInfos;
+        for (const auto& info : datasetInfos)
+        {
+            if (inPoint(info.first))
+            {
+                pointInfos.insert(info);
+            }
+        }
+
+        std::cout << "Saving plots for " << point.config << std::endl;
+        makePlots(pointPlots,
+                  pointCutFlows,
+                  pointLegOrder,
+                  pointPlotOrder,
+                  pointInfos,
+                  point.outFolder.empty() ? outFolder : point.outFolder,
+                  // Each point has its own histogram file
+                  (boost::filesystem::path{histoDir} / boost::filesystem::path{point.config}.stem()).string() + "/");
+    }
+    printPlotMemory();
+}
+
+// Cut flows of the whole run as a tab separated table, for scripts
+void AnalysisAlgo::writeCutFlowTable() const
+{
+    if (cutFlowCounters.empty())
+    {
+        return;
+    }
+    boost::filesystem::create_directories(outFolder);
+    const std::string fileName{(boost::filesystem::path{outFolder} / ("cutFlow_" + channel + postfix + ".tsv")).string()};
+    std::ofstream table{fileName};
+    CutFlow::writeTableHeader(table, "dataset\tsystematic");
+    for (const auto& cutFlow : cutFlowCounters)
+    {
+        const std::string& systName{systNames[cutFlow.first.second]};
+        cutFlow.second.writeTable(
+            table, cutFlow.first.first + "\t" + (systName.empty() ? HistogramFile::nominal : systName.substr(2)));
+    }
+    if (!table)
+    {
+        std::cerr << "Couldn't write the cut flow table " << fileName << std::endl;
+        return;
+    }
+    std::cout << "Cut flows written to " << fileName << std::endl;
+}
+
+void AnalysisAlgo::printPlotMemory() const
+{
+    Plots::MemoryUsage total{0, 0, 0, 0, 0};
+    for (const auto& systChannel : plotsMap)
+    {
+        for (const auto& histoPlots : systChannel.second)
+        {
+            for (const auto& stagePlots : histoPlots.second)
+            {
+                const Plots::MemoryUsage usage{stagePlots.second->memoryUsage()};
+                total.plots += usage.plots;
+                total.filled += usage.filled;
+                total.bookedEmpty += usage.bookedEmpty;
+                total.bytes += usage.bytes;
+                total.eagerBytes += usage.eagerBytes;
+            }
+        }
+    }
+    if (total.plots == 0)
+    {
+        return;
+    }
+    const double megabyte{1024. * 1024.};
+    std::cout << "Histograms: " << total.plots << " declared, " << total.filled
+              << " filled, " << total.bookedEmpty << " booked empty for saving, "
+              << total.plots - total.filled - total.bookedEmpty << " never booked" << std::endl;
+    std::cout << "Histogram memory: " << std::setprecision(1)
+              << static_cast<double>(total.bytes) / megabyte << " MB, "
+              << static_cast<double>(total.eagerBytes) / megabyte
+              << " MB if booked up front" << std::setprecision(6) << std::endl;
+}
+
+// The code version, cut config and the options which change the selection
+void AnalysisAlgo::addSelectionProvenance(Fingerprint& fingerprint) const
+{
+    fingerprint.add(Provenance::codeVersion());
+    Provenance::addFile(fingerprint, cutConfName);
+    fingerprint.add(is2016_).add(is2018_).add(skipTrig).add(skipScalarCut).add(doZplusCR_);
+    fingerprint.add(metCut).add(mwCut).add(msCut).add(mhCut).add(chsMass);
+    fingerprint.add(customJetRegion).add(jetRegVars.size());
+    for (const unsigned jetRegVar : jetRegVars)
+    {
+        fingerprint.add(jetRegVar);
+    }
+}
+
+std::string AnalysisAlgo::datasetProvenance(Dataset& dataset, const std::string& artefact, const bool invertedLeptons) const
+{
+    Fingerprint fingerprint;
+    fingerprint.add(artefact);
+    addSelectionProvenance(fingerprint);
+    fingerprint.add(postfix).add(invertedLeptons).add(entryListSkim);
+    if (artefact == "skim" || usePostLepTree)
+    {
+        Provenance::addFile(fingerprint, skimConfName);
+    }
+    if (artefact != "skim")
+    {
+        fingerprint.add(usePostLepTree).add(doNPLs_).add(systToRun);
+        if (artefact == "mva")
+        {
+            fingerprint.add(slimMva);
+        }
+        if (!entryListName.empty())
+        {
+            Provenance::addFile(fingerprint, entryListName);
+        }
+    }
+    // Not the tree name, which -u sets to that of the skims, nor for skims the
+    // plot label, which --NPLs sets on the datasets reading same sign skims,
+    // so that -u finds the hash -g stamped
+    fingerprint.add(dataset.name()).add(dataset.isMC()).add(dataset.getTriggerFlag());
+    if (artefact != "skim")
+    {
+        fingerprint.add(dataset.getPlotLabel());
+    }
+    Provenance::addInputs(fingerprint, dataset.locations());
+    return fingerprint.hex();
+}
+
+std::vector<AnalysisAlgo::SkimProvenance> AnalysisAlgo::skimProvenances()
+{
+    std::vector<SkimProvenance> provenances;
+    for (auto& dataset : datasets)
+    {
+        provenances.push_back({dataset.name(),
+                               dataset.getPlotLabel(),
+                               dataset.treeName(),
+                               datasetProvenance(dataset, "skim", false),
+                               datasetProvenance(dataset, "skim", true)});
+    }
+    return provenances;
+}
+
+// Skims used by -u are checked against the same configs and inputs, so are
+// covered too
+std::string AnalysisAlgo::histogramProvenance()
+{
+    Fingerprint fingerprint;
+    fingerprint.add("histograms");
+    addSelectionProvenance(fingerprint);
+    Provenance::addFile(fingerprint, config);
+    for (const auto& gridConfig : gridConfigs)
+    {
+        Provenance::addFile(fingerprint, gridConfig);
+    }
+    Provenance::addFile(fingerprint, plotConfName);
+    fingerprint.add(channelsToRun).add(systToRun).add(invertLepCut).add(doNPLs_).add(totalLumi);
+    fingerprint.add(usePostLepTree).add(entryListSkim);
+    if (usePostLepTree)
+    {
+        Provenance::addFile(fingerprint, skimConfName);
+    }
+    if (!entryListName.empty())
+    {
+        Provenance::addFile(fingerprint, entryListName);
+    }
+    for (auto& dataset : datasets)
+    {
+        fingerprint.add(dataset.name()).add(dataset.treeName()).add(dataset.isMC()).add(dataset.getTriggerFlag());
+        fingerprint.add(dataset.getFillHisto()).add(dataset.lumi()).add(dataset.getTotalEvents());
+        Provenance::addInputs(fingerprint, dataset.locations());
+    }
+    return fingerprint.hex();
+}
+
+std::vector<std::string> AnalysisAlgo::histogramFiles() const
+{
+    if (gridPoints.empty())
+    {
+        return {histoDir + HistogramFile::fileName};
+    }
+    std::vector<std::string> files;
+    for (const auto& point : gridPoints)
+    {
+        files.push_back((boost::filesystem::path{histoDir} / boost::filesystem::path{point.config}.stem()).string() + "/"
+                        + HistogramFile::fileName);
+    }
+    return files;
+}
+
+void AnalysisAlgo::makePlots(std::map<std::string, std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>> histograms,
+                             std::map<std::string, TH1D*> cutFlows,
+                             const std::vector<std::string>& legendOrder,
+                             const std::vector<std::string>& histogramOrder,
+                             const std::map<std::string, datasetInfo>& infos,
+                             const std::string& outputFolder,
+                             const std::string& histogramFolder)
 {
     // Save all plot objects. For testing purposes.
 
@@ -1241,27 +1903,34 @@ void AnalysisAlgo::savePlots()
     if (plots)
     {
         HistogramPlotter plotObj =
-            HistogramPlotter(legOrder, plotOrder, datasetInfos, is2016_, is2018_);
+            HistogramPlotter(legendOrder, histogramOrder, infos, is2016_, is2018_);
 
         // If either making or reading in histos, then set the correct read in
         // directory
         if ((makeHistos || useHistos) && plots)
         {
-            plotObj.setHistogramFolder(histoDir);
+            plotObj.setHistogramFolder(histogramFolder);
         }
 
         // If making histos, save the output!
         if (makeHistos && plots)
         {
             std::cout << "Saving histograms for later use ..." << std::endl;
+            plotObj.setHistogramCompression(histoCompression);
             for (unsigned i{0}; i < plotsVec.size(); i++)
             {
-                plotObj.saveHistos(plotsMap[plotsVec[i]]);
+                const auto [systematic, plotsChannel]{splitSystChannel(plotsVec[i])};
+                plotObj.saveHistos(histograms[plotsVec[i]], plotsChannel, systematic);
             }
             plotObj.saveHistos(
-                cutFlowMap,
+                cutFlows,
                 "cutFlow",
                 channel); // Don't forget to save the cutflow too!
+            plotObj.writeHistos();
+            if (provenanceComplete)
+            {
+                Provenance::stamp(histogramFolder + HistogramFile::fileName, histoProvenance);
+            }
         }
 
         if (!makeHistos)
@@ -1273,14 +1942,17 @@ void AnalysisAlgo::savePlots()
             plotObj.setLabelOne("CMS Preliminary");
             plotObj.setLabelTwo("Some amount of lumi");
             plotObj.setPostfix("");
-            plotObj.setOutputFolder(outFolder);
+            plotObj.setOutputFolder(outputFolder);
+            plotObj.setPlotWorkers(plotWorkers);
+            plotObj.setForceReplot(forcePlots);
 
             for (unsigned i{0}; i < plotsVec.size(); i++)
             {
                 std::cout << plotsVec[i] << std::endl;
                 if (plots)
                 {
-                    plotObj.plotHistos(plotsMap[plotsVec[i]]);
+                    const auto [systematic, plotsChannel]{splitSystChannel(plotsVec[i])};
+                    plotObj.plotHistos(histograms[plotsVec[i]], plotsChannel, systematic);
                 }
             }
 
@@ -1296,10 +1968,16 @@ void AnalysisAlgo::savePlots()
             }
             if (useHistos)
             {
-                cutFlowMap = plotObj.loadCutFlowMap("cutFlow", channel);
+                cutFlows = plotObj.loadCutFlowMap("cutFlow", channel);
             }
             plotObj.makePlot(
-                cutFlowMap, "data/MC Yield", "cutFlow", cutFlowLabels);
+                cutFlows, "data/MC Yield", "cutFlow", cutFlowLabels);
+
+            const unsigned failedPlots{plotObj.renderPlots()};
+            if (failedPlots > 0)
+            {
+                std::cerr << failedPlots << " plots failed, see above" << std::endl;
+            }
         }
     }
 
@@ -1364,3 +2042,96 @@ std::string AnalysisAlgo::channelSetup(unsigned channelInd)
     }
     return chanName;
 }
+
+// Systematics which only change the event weight, independently of the
+// selection. The PDF variations of the 2016 tW samples are computed from
+// LHAPDF after the selection, so they're left out.
+bool AnalysisAlgo::isWeightOnlySystematic(const int systMask, const std::string& datasetName) const
+{
+    if (systMask == 1024 || systMask == 2048)
+    {
+        return !(is2016_
+                 && (datasetName == "tWInclusive"
+                     || datasetName == "tbarWInclusive"
+                     || datasetName == "tWInclusive_scaleup"
+                     || datasetName == "tWInclusive_scaledown"
+                     || datasetName == "tbarWInclusive_scaleup"
+                     || datasetName == "tbarWInclusive_scaledown"));
+    }
+    return systMask == 64 || systMask == 128 || systMask == 4096
+           || systMask == 8192 || systMask == 16384 || systMask == 32768
+           || systMask == 65536 || systMask == 131072 || systMask == 262144
+           || systMask == 524288;
+}
+
+// Ratio of the event weight with a weight-only systematic to the nominal one,
+// following the weights applied in runMainAnalysis. Not finite if the nominal
+// pileup or generator weight vanishes.
+double AnalysisAlgo::weightVariation(const AnalysisEvent& event, const int systMask, const bool hasLHE) const
+{
+    if (systMask == 64 || systMask == 128)
+    {
+        const TH1D* pileupSyst{systMask == 64 ? puSystUp : puSystDown};
+        return pileupSyst->GetBinContent(pileupSyst->GetXaxis()->FindBin(event.numVert))
+               / puReweight->GetBinContent(puReweight->GetXaxis()->FindBin(event.numVert));
+    }
+    if (systMask == 4096 || systMask == 8192)
+    {
+        if (!hasLHE)
+        {
+            return 1.0;
+        }
+        return systMask == 4096
+                   ? sumNegativeWeights_ / sumNegativeWeightsScaleDown_ * (event.weight_muF0p5muR0p5 / event.origWeightForNorm)
+                   : sumNegativeWeights_ / sumNegativeWeightsScaleUp_ * (event.weight_muF2muR2 / event.origWeightForNorm);
+    }
+    if (systMask == 1024)
+    {
+        return event.weight_pdfMax;
+    }
+    if (systMask == 2048)
+    {
+        return event.weight_pdfMin;
+    }
+    if (systMask == 16384)
+    {
+        return event.weight_alphaMin; // Max, but incorrectly named branch
+    }
+    if (systMask == 32768)
+    {
+        return event.weight_alphaMax; // Min, but incorrectly named branch
+    }
+    if (systMask == 65536)
+    {
+        return event.isrDefLo;
+    }
+    if (systMask == 131072)
+    {
+        return event.isrDefHi;
+    }
+    if (systMask == 262144)
+    {
+        return event.fsrDefLo;
+    }
+    if (systMask == 524288)
+    {
+        return event.fsrDefHi;
+    }
+    throw std::logic_error("Not a weight-only systematic: " + std::to_string(systMask));
+}
+
+// Splits a plotsVec entry into its systematic (the histogram file directory
+// name, "nominal" for none) and channel
+std::pair<std::string, std::string> AnalysisAlgo::splitSystChannel(const std::string& systChannel) const
+{
+    std::string systName;
+    for (const auto& name : systNames)
+    {
+        if (name.size() > systName.size() && systChannel.compare(0, name.size(), name) == 0)
+        {
+            systName = name;
+        }
+    }
+    const std::string systematic{systName.empty() ? HistogramFile::nominal : systName.substr(2)};
+    return {systematic, systChannel.substr(systName.size())};
+}
@@ -0,0 +1,324 @@
+#include "deltaRKernel.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks the DeltaR kernels against a scalar reference which wraps the phi
+// difference with atan2 and takes ΔR with a square root, as the selection did
+// before them, and times both. Each event has a first collection of each of
+// --multiplicities objects, e.g. jets or charged tracks, and a second of
+// --others objects, e.g. the leptons, spread uniformly over |eta| < 2.5 and
+// phi. Results are compared on ΔR to within rounding, and matches and counts
+// only away from the cone edge.
+
+namespace po = boost::program_options;
+
+namespace
+{
+template <typename T>
+T referenceDeltaR(const T eta1, const T phi1, const T eta2, const T phi2)
+{
+    const T dEta{eta1 - eta2};
+    const T dPhi{std::atan2(std::sin(phi1 - phi2), std::cos(phi1 - phi2))};
+    return std::sqrt(dEta * dEta + dPhi * dPhi);
+}
+
+template <typename T>
+struct Sample
+{
+    size_t events;
+    size_t n; // Objects of the first collection of each event
+    size_t m; // Of the second
+    std::vector<T> eta1;
+    std::vector<T> phi1;
+    std::vector<T> eta2;
+    std::vector<T> phi2;
+};
+
+template <typename T>
+Sample<T> makeSample(const size_t events, const size_t n, const size_t m, std::mt19937& generator)
+{
+    std::uniform_real_distribution<T> eta{T(-2.5), T(2.5)};
+    std::uniform_real_distribution<T> phi{T(-DeltaR::pi), T(DeltaR::pi)};
+    Sample<T> sample{events, n, m, {}, {}, {}, {}};
+    for (size_t i{0}; i < events * n; i++)
+    {
+        sample.eta1.push_back(eta(generator));
+        sample.phi1.push_back(phi(generator));
+    }
+    for (size_t i{0}; i < events * m; i++)
+    {
+        sample.eta2.push_back(eta(generator));
+        sample.phi2.push_back(phi(generator));
+    }
+    return sample;
+}
+
+struct Timing
+{
+    std::string kernel;
+    double referenceNs; // Per pair of objects
+    double kernelNs;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Time per pair of objects of calling the function for every event
+template <typename T, typename F>
+double nsPerPair(const Sample<T>& sample, F&& function)
+{
+    const auto start{Clock::now()};
+    for (size_t e{0}; e < sample.events; e++)
+    {
+        function(e);
+    }
+    const std::chrono::duration<double> elapsed{Clock::now() - start};
+    const double pairs{static_cast<double>(sample.events * std::max<size_t>(sample.n * sample.m, 1))};
+    return 1e9 * elapsed.count() / pairs;
+}
+
+// Checks every kernel against the reference, and returns the number of
+// mismatches
+template <typename T>
+long long check(const Sample<T>& s, const T cone)
+{
+    // ΔR reaches about 7, and the reference loses a few ulps in atan2
+    const T tolerance{10000 * std::numeric_limits<T>::epsilon()};
+    long long mismatches{0};
+    std::vector<T> matrix(s.n * s.m);
+    std::vector<T> minimum(s.n);
+    for (size_t e{0}; e < s.events; e++)
+    {
+        const T* eta1{s.eta1.data() + e * s.n};
+        const T* phi1{s.phi1.data() + e * s.n};
+        const T* eta2{s.eta2.data() + e * s.m};
+        const T* phi2{s.phi2.data() + e * s.m};
+
+        DeltaR::deltaR2Matrix(eta1, phi1, s.n, eta2, phi2, s.m, matrix.data());
+        DeltaR::minDeltaR2(eta1, phi1, s.n, eta2, phi2, s.m, minimum.data());
+        for (size_t i{0}; i < s.n; i++)
+        {
+            T closest{std::numeric_limits<T>::infinity()};
+            for (size_t j{0}; j < s.m; j++)
+            {
+                const T reference{referenceDeltaR(eta1[i], phi1[i], eta2[j], phi2[j])};
+                closest = std::min(closest, reference);
+                mismatches += std::abs(std::sqrt(matrix[i * s.m + j]) - reference) > tolerance;
+            }
+            mismatches += s.m == 0 ? !std::isinf(minimum[i]) : std::abs(std::sqrt(minimum[i]) - closest) > tolerance;
+        }
+
+        for (size_t j{0}; j < s.m; j++)
+        {
+            int best{-1};
+            T bestDeltaR{cone};
+            size_t countBelow{0}; // Clearly inside the cone
+            size_t countAbove{0}; // Inside or near its edge
+            for (size_t i{0}; i < s.n; i++)
+            {
+                const T reference{referenceDeltaR(eta1[i], phi1[i], eta2[j], phi2[j])};
+                if (reference < bestDeltaR)
+                {
+                    bestDeltaR = reference;
+                    best = static_cast<int>(i);
+                }
+                countBelow += reference < cone - tolerance;
+                countAbove += reference < cone + tolerance;
+            }
+
+            const int match{DeltaR::bestMatch(eta1, phi1, s.n, eta2[j], phi2[j], cone)};
+            const T matchDeltaR{match < 0 ? cone : referenceDeltaR(eta1[match], phi1[match], eta2[j], phi2[j])};
+            mismatches += match != best && std::abs(matchDeltaR - bestDeltaR) > tolerance;
+
+            const size_t count{DeltaR::countWithin(eta1, phi1, s.n, eta2[j], phi2[j], cone)};
+            mismatches += count < countBelow || count > countAbove;
+        }
+    }
+    return mismatches;
+}
+
+template <typename T>
+std::vector<Timing> time(const Sample<T>& s, const T cone)
+{
+    std::vector<Timing> timings;
+    std::vector<T> out(std::max({s.n * s.m, s.n, size_t{1}}));
+    // Keeps the loops from being optimised away
+    volatile double sink{0.};
+    const auto eta1{[&s](const size_t e) { return s.eta1.data() + e * s.n; }};
+    const auto phi1{[&s](const size_t e) { return s.phi1.data() + e * s.n; }};
+    const auto eta2{[&s](const size_t e) { return s.eta2.data() + e * s.m; }};
+    const auto phi2{[&s](const size_t e) { return s.phi2.data() + e * s.m; }};
+
+    timings.push_back({"deltaR2Matrix",
+                       nsPerPair(s,
+                                 [&](const size_t e) {
+                                     for (size_t i{0}; i < s.n; i++)
+                                     {
+                                         for (size_t j{0}; j < s.m; j++)
+                                         {
+                                             out[i * s.m + j] = referenceDeltaR(eta1(e)[i], phi1(e)[i], eta2(e)[j], phi2(e)[j]);
+                                         }
+                                     }
+                                     sink = sink + out[0];
+                                 }),
+                       nsPerPair(s, [&](const size_t e) {
+                           DeltaR::deltaR2Matrix(eta1(e), phi1(e), s.n, eta2(e), phi2(e), s.m, out.data());
+                           sink = sink + out[0];
+                       })});
+
+    timings.push_back({"minDeltaR2",
+                       nsPerPair(s,
+                                 [&](const size_t e) {
+                                     for (size_t i{0}; i < s.n; i++)
+                                     {
+                                         T closest{std::numeric_limits<T>::infinity()};
+                                         for (size_t j{0}; j < s.m; j++)
+                                         {
+                                             closest = std::min(closest, referenceDeltaR(eta1(e)[i], phi1(e)[i], eta2(e)[j], phi2(e)[j]));
+                                         }
+                                         out[i] = closest;
+                                     }
+                                     sink = sink + out[0];
+                                 }),
+                       nsPerPair(s, [&](const size_t e) {
+                           DeltaR::minDeltaR2(eta1(e), phi1(e), s.n, eta2(e), phi2(e), s.m, out.data());
+                           sink = sink + out[0];
+                       })});
+
+    timings.push_back({"bestMatch",
+                       nsPerPair(s,
+                                 [&](const size_t e) {
+                                     for (size_t j{0}; j < s.m; j++)
+                                     {
+                                         int best{-1};
+                                         T bestDeltaR{cone};
+                                         for (size_t i{0}; i < s.n; i++)
+                                         {
+                                             const T dR{referenceDeltaR(eta1(e)[i], phi1(e)[i], eta2(e)[j], phi2(e)[j])};
+                                             if (dR < bestDeltaR)
+                                             {
+                                                 bestDeltaR = dR;
+                                                 best = static_cast<int>(i);
+                                             }
+                                         }
+                                         sink = sink + best;
+                                     }
+                                 }),
+                       nsPerPair(s, [&](const size_t e) {
+                           for (size_t j{0}; j < s.m; j++)
+                           {
+                               sink = sink + DeltaR::bestMatch(eta1(e), phi1(e), s.n, eta2(e)[j], phi2(e)[j], cone);
+                           }
+                       })});
+
+    timings.push_back({"countWithin",
+                       nsPerPair(s,
+                                 [&](const size_t e) {
+                                     for (size_t j{0}; j < s.m; j++)
+                                     {
+                                         size_t count{0};
+                                         for (size_t i{0}; i < s.n; i++)
+                                         {
+                                             count += referenceDeltaR(eta1(e)[i], phi1(e)[i], eta2(e)[j], phi2(e)[j]) < cone;
+                                         }
+                                         sink = sink + static_cast<double>(count);
+                                     }
+                                 }),
+                       nsPerPair(s, [&](const size_t e) {
+                           for (size_t j{0}; j < s.m; j++)
+                           {
+                               sink = sink + static_cast<double>(DeltaR::countWithin(eta1(e), phi1(e), s.n, eta2(e)[j], phi2(e)[j], cone));
+                           }
+                       })});
+    return timings;
+}
+
+template <typename T>
+long long run(const std::string& precision,
+              const std::vector<size_t>& multiplicities,
+              const size_t others,
+              const size_t events,
+              const double cone,
+              std::mt19937& generator)
+{
+    long long mismatches{0};
+    for (const size_t n : multiplicities)
+    {
+        const Sample<T> sample{makeSample<T>(events, n, others, generator)};
+        const long long sampleMismatches{check(sample, T(cone))};
+        mismatches += sampleMismatches;
+        std::cout << precision << ", " << n << " x " << others << " objects, " << sampleMismatches << " mismatches"
+                  << std::endl;
+        for (const auto& timing : time(sample, T(cone)))
+        {
+            std::cout << "  " << std::left << std::setw(16) << timing.kernel << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(10) << timing.referenceNs << " ns/pair reference"
+                      << std::setw(10) << timing.kernelNs << " ns/pair kernel (" << timing.referenceNs / timing.kernelNs
+                      << "x)" << std::endl;
+        }
+    }
+    return mismatches;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<size_t> multiplicities;
+    size_t others;
+    size_t numEvents;
+    double cone;
+    unsigned seed;
+
+    po::options_description desc{"Options"};
+    desc.add_options()("help,h", "Print this message.")(
+        "multiplicities",
+        po::value<std::vector<size_t>>(&multiplicities)->multitoken()->default_value({2, 15, 60, 200}, "2 15 60 200"),
+        "Sizes of the first collection: leptons, jets, charged tracks near "
+        "the leptons and all charged tracks.")(
+        "others",
+        po::value<size_t>(&others)->default_value(2),
+        "Size of the second collection, e.g. the two leptons cleaned "
+        "against.")(
+        "events,n",
+        po::value<size_t>(&numEvents)->default_value(20000),
+        "Number of events of each multiplicity.")(
+        "cone",
+        po::value<double>(&cone)->default_value(0.4),
+        "ΔR of bestMatch and countWithin.")(
+        "seed", po::value<unsigned>(&seed)->default_value(12345), "Random seed.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::mt19937 generator{seed};
+    long long mismatches{run<float>("float", multiplicities, others, numEvents, cone, generator)};
+    mismatches += run<double>("double", multiplicities, others, numEvents, cone, generator);
+    std::cout << "Mismatches with the reference: " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include "AnalysisEvent.hpp"
+#include "TChain.h"
+#include "TH1.h"
+#include "config_parser.hpp"
+#include "cutClass.hpp"
+#include "cutFlow.hpp"
+#include "pairVertex.hpp"
+#include "plots.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Counts the calls to operator new made by Plots::fillAllPlots. The mumu
+// selection of an analysis config is run on one of its datasets, and every
+// event passing it fills the plots of each cut stage, as analysisMain.exe does
+// with --allPlots. Only the filling is counted. The first --warmup filled
+// events are left out, while the plot value buffers grow to their working
+// size. Run from the top of the repository, as the selection reads its scale
+// factors from there.
+
+namespace po = boost::program_options;
+
+namespace
+{
+bool counting{false};
+long long allocations{0};
+} // namespace
+
+void* operator new(const std::size_t size)
+{
+    if (counting)
+    {
+        allocations++;
+    }
+    if (void* const memory{std::malloc(size == 0 ? 1 : size)})
+    {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* const memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* const memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char* argv[])
+{
+    std::string config;
+    std::string datasetName;
+    bool is2016;
+    bool is2018;
+    long long numEntries;
+    long long warmup;
+
+    po::options_description desc{"Options"};
+    desc.add_options()("help,h", "Print this message.")(
+        "config,c",
+        po::value<std::string>(&config)->required(),
+        "Analysis configuration, as given to analysisMain.exe.")(
+        "dataset,d",
+        po::value<std::string>(&datasetName),
+        "Dataset of the configuration to run over. The first one if not "
+        "given.")(
+        "2016", po::bool_switch(&is2016), "Use 2016 conditions (SFs, et al.).")(
+        "2018", po::bool_switch(&is2018), "Use 2018 conditions (SFs, et al.).")(
+        "events,n",
+        po::value<long long>(&numEntries)->default_value(100000),
+        "Number of entries to run the selection over. All if set to 0.")(
+        "warmup",
+        po::value<long long>(&warmup)->default_value(100),
+        "Number of filled events left out of the count.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        std::vector<Dataset> datasets;
+        double lumi{0.};
+        std::vector<std::string> titles;
+        std::vector<std::string> names;
+        std::vector<float> xMins;
+        std::vector<float> xMaxs;
+        std::vector<int> nBins;
+        std::vector<std::string> fillExps;
+        std::vector<std::string> xAxisLabels;
+        std::vector<int> cutStages;
+        std::string cutConfName;
+        std::string plotConfName;
+        std::string outFolder;
+        std::string postfix;
+        std::string channel;
+        Parser::parse_config(config, datasets, lumi, titles, names, xMins, xMaxs, nBins, fillExps, xAxisLabels, cutStages, cutConfName, plotConfName, outFolder, postfix, channel);
+
+        auto dataset{datasets.begin()};
+        while (dataset != datasets.end() && !datasetName.empty() && dataset->name() != datasetName)
+        {
+            ++dataset;
+        }
+        if (dataset == datasets.end())
+        {
+            throw std::runtime_error("No dataset " + datasetName + " in " + config);
+        }
+
+        Cuts cuts{false, false, false, is2016, is2018};
+        cuts.parse_config(cutConfName);
+        cuts.setMC(dataset->isMC());
+        cuts.setTriggerFlag(dataset->getTriggerFlag());
+        cuts.setNumLeps(2, 2, 0, 0);
+        cuts.setCutConfTrigLabel("m");
+
+        TChain chain{dataset->treeName().c_str()};
+        if (!dataset->fillChain(&chain))
+        {
+            throw std::runtime_error("Couldn't make the chain of " + dataset->name());
+        }
+        AnalysisEvent event{dataset->isMC(), &chain, is2016, is2018};
+
+        // The cut stages of AnalysisAlgo::setupPlots
+        TH1::AddDirectory(false);
+        const std::vector<std::string> stages{"lepSel", "zMass", "trackSel", "higgsSel"};
+        std::map<std::string, std::shared_ptr<Plots>> plots;
+        for (unsigned j{0}; j < stages.size(); j++)
+        {
+            plots[stages[j]] = std::make_shared<Plots>(titles, names, xMins, xMaxs, nBins, fillExps, xAxisLabels, cutStages, j, dataset->name() + "_" + stages[j]);
+        }
+        CutFlow cutFlow{stages};
+
+        const long long entries{numEntries > 0 ? std::min(numEntries, chain.GetEntries()) : chain.GetEntries()};
+        long long filledEvents{0};
+        long long countedEvents{0};
+        long long allocatingEvents{0};
+        long long countedAllocations{0};
+        std::chrono::duration<double> fillTime{0.};
+        for (long long entry{0}; entry < entries; entry++)
+        {
+            event.GetEntry(entry);
+            PairVertex::compute(event);
+            double eventWeight{1.};
+            if (!cuts.makeCuts(event, eventWeight, plots, cutFlow, 0))
+            {
+                continue;
+            }
+
+            allocations = 0;
+            const auto start{std::chrono::steady_clock::now()};
+            counting = true;
+            for (const auto& stage : stages)
+            {
+                plots[stage]->fillAllPlots(event, eventWeight);
+            }
+            counting = false;
+            const auto stop{std::chrono::steady_clock::now()};
+
+            if (filledEvents++ < warmup)
+            {
+                continue;
+            }
+            countedEvents++;
+            countedAllocations += allocations;
+            allocatingEvents += allocations > 0;
+            fillTime += stop - start;
+        }
+
+        std::cout << names.size() << " plots at " << stages.size() << " cut stages, " << filledEvents << " of "
+                  << entries << " entries of " << dataset->name() << " passing the selection, " << countedEvents
+                  << " counted" << std::endl;
+        if (countedEvents == 0)
+        {
+            throw std::runtime_error("No events to count, run over more entries or lower --warmup");
+        }
+        const double fills{static_cast<double>(countedEvents * static_cast<long long>(stages.size()))};
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "operator new calls:          " << countedAllocations << " (" << static_cast<double>(countedAllocations) / fills
+                  << " per fillAllPlots)" << std::endl;
+        std::cout << "Events with any allocation:  " << allocatingEvents << std::endl;
+        std::cout << std::setprecision(2) << "Time per fillAllPlots:       " << 1e6 * fillTime.count() / fills << " us" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
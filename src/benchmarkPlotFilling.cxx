@@ -0,0 +1,180 @@
+#include "TH1D.h"
+#include "config_parser.hpp"
+#include "histogramAccumulator.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Times filling the production plot set through TH1D::Fill and through
+// HistogramAccumulator, with the same pseudo-random values and weights, and
+// checks that both give the same histograms. Values are spread 10% beyond each
+// axis range so under- and overflows are exercised too.
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    std::string plotConf;
+    long long numEvents;
+    unsigned numSlots;
+    unsigned seed;
+
+    po::options_description desc{"Options"};
+    desc.add_options()("help,h", "Print this message.")(
+        "plotConf",
+        po::value<std::string>(&plotConf)->default_value("configs/plots/plotDileptonConf.yaml"),
+        "Plot configuration to benchmark.")(
+        "events,n",
+        po::value<long long>(&numEvents)->default_value(100000),
+        "Number of events; every plot is filled once per event.")(
+        "slots",
+        po::value<unsigned>(&numSlots)->default_value(4),
+        "Number of accumulator sets filled in turn and merged, as per-thread "
+        "accumulators would be.")(
+        "seed", po::value<unsigned>(&seed)->default_value(12345), "Random seed.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    numSlots = std::max(numSlots, 1u);
+
+    std::vector<std::string> titles;
+    std::vector<std::string> names;
+    std::vector<float> xMins;
+    std::vector<float> xMaxs;
+    std::vector<int> nBins;
+    std::vector<std::string> fillExps;
+    std::vector<std::string> xAxisLabels;
+    std::vector<int> cutStages;
+    Parser::parse_plots(plotConf, titles, names, xMins, xMaxs, nBins, fillExps, xAxisLabels, cutStages);
+    const size_t numPlots{names.size()};
+
+    TH1::AddDirectory(false);
+    std::vector<std::unique_ptr<TH1D>> rootHists;
+    std::vector<std::unique_ptr<TH1D>> accumulatedHists;
+    for (size_t i{0}; i < numPlots; i++)
+    {
+        rootHists.emplace_back(new TH1D{(names[i] + "_root").c_str(), "", nBins[i], xMins[i], xMaxs[i]});
+        accumulatedHists.emplace_back(new TH1D{(names[i] + "_acc").c_str(), "", nBins[i], xMins[i], xMaxs[i]});
+    }
+
+    // Generate everything up front so only the filling is timed
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<float> unit{-0.1f, 1.1f};
+    std::normal_distribution<double> weight{1., 0.1};
+    std::vector<float> values(static_cast<size_t>(numEvents) * numPlots);
+    std::vector<double> weights(static_cast<size_t>(numEvents));
+    for (size_t event{0}; event < weights.size(); event++)
+    {
+        weights[event] = weight(generator);
+        for (size_t i{0}; i < numPlots; i++)
+        {
+            values[event * numPlots + i] = xMins[i] + (xMaxs[i] - xMins[i]) * unit(generator);
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto seconds{[](const Clock::time_point start, const Clock::time_point stop) {
+        return std::chrono::duration<double>(stop - start).count();
+    }};
+
+    const auto rootStart{Clock::now()};
+    for (size_t event{0}; event < weights.size(); event++)
+    {
+        for (size_t i{0}; i < numPlots; i++)
+        {
+            rootHists[i]->Fill(values[event * numPlots + i], weights[event]);
+        }
+    }
+    const double rootTime{seconds(rootStart, Clock::now())};
+
+    // Each slot fills a contiguous block of events, then the slots are merged
+    // in order and added to the histograms
+    const auto accumulatorStart{Clock::now()};
+    std::vector<std::vector<HistogramAccumulator>> slots(numSlots);
+    for (auto& slot : slots)
+    {
+        for (const auto& hist : accumulatedHists)
+        {
+            slot.emplace_back(*hist);
+        }
+    }
+    const size_t eventsPerSlot{(weights.size() + numSlots - 1) / numSlots};
+    for (size_t s{0}; s < numSlots; s++)
+    {
+        const size_t end{std::min(weights.size(), (s + 1) * eventsPerSlot)};
+        for (size_t event{s * eventsPerSlot}; event < end; event++)
+        {
+            for (size_t i{0}; i < numPlots; i++)
+            {
+                slots[s][i].fill(values[event * numPlots + i], weights[event]);
+            }
+        }
+    }
+    const double fillTime{seconds(accumulatorStart, Clock::now())};
+    for (size_t i{0}; i < numPlots; i++)
+    {
+        for (size_t s{1}; s < numSlots; s++)
+        {
+            slots[0][i].merge(slots[s][i]);
+        }
+        slots[0][i].addTo(*accumulatedHists[i]);
+    }
+    const double accumulatorTime{seconds(accumulatorStart, Clock::now())};
+
+    // Merging slots changes the order of the additions, so allow for rounding
+    double maxRelDiff{0.};
+    long long differentEntries{0};
+    for (size_t i{0}; i < numPlots; i++)
+    {
+        for (int bin{0}; bin <= nBins[i] + 1; bin++)
+        {
+            const double a{rootHists[i]->GetBinContent(bin)};
+            const double b{accumulatedHists[i]->GetBinContent(bin)};
+            const double aErr{rootHists[i]->GetBinError(bin)};
+            const double bErr{accumulatedHists[i]->GetBinError(bin)};
+            const double scale{std::max({std::abs(a), std::abs(b), 1e-300})};
+            const double errScale{std::max({aErr, bErr, 1e-300})};
+            maxRelDiff = std::max({maxRelDiff, std::abs(a - b) / scale, std::abs(aErr - bErr) / errScale});
+        }
+        if (std::llround(rootHists[i]->GetEntries()) != std::llround(accumulatedHists[i]->GetEntries()))
+        {
+            differentEntries++;
+        }
+    }
+
+    const double numFills{static_cast<double>(numEvents) * static_cast<double>(numPlots)};
+    std::cout << numPlots << " plots from " << plotConf << ", " << numEvents << " events, " << numSlots << " accumulator sets" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "TH1D::Fill:            " << 1e9 * rootTime / numFills << " ns/fill" << std::endl;
+    std::cout << "HistogramAccumulator:  " << 1e9 * fillTime / numFills << " ns/fill, " << 1e9 * accumulatorTime / numFills << " ns/fill including merging ("
+              << rootTime / accumulatorTime << "x)" << std::endl;
+    std::cout << std::scientific << "Largest relative difference in bin contents/errors: " << maxRelDiff << std::endl;
+    std::cout << "Plots with different entries: " << differentEntries << std::endl;
+
+    return maxRelDiff < 1e-9 && differentEntries == 0 ? 0 : 1;
+}
@@ -0,0 +1,292 @@
+#include "eventDeduplicator.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Checks EventDeduplicator::contains against the unordered_set of (run, event)
+// pairs postTriggerSkimmer.exe used before, on pseudo-random events, and times
+// both. Event numbers are unique within a run, as in data, with the lumi block
+// following from them. Every event is added twice, as if taken by two primary
+// datasets. Three deduplicators are checked:
+//  - in memory, without a spill directory;
+//  - spilled, with a budget which the added events pass but the distinct ones
+//    fit in, so every run is spilled and loaded back once;
+//  - evicted, with a budget of a tenth of the distinct events, so loaded runs
+//    are evicted, least recently used first, and loaded again;
+//  - reused, spilled as above into a directory already holding a file of
+//    stale keys for every run, as an interrupted run leaves behind.
+// Lookups are half added events and half random ones, some from runs never
+// added, spread over --threads threads.
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace
+{
+using EventKey = std::pair<int, int>; // Run and event number
+using EventSet = std::unordered_set<EventKey, boost::hash<EventKey>>;
+
+constexpr int firstRun{300000};
+constexpr uint32_t eventsPerLumi{1000};
+
+EventDeduplicator::Event makeEvent(const int run, const uint32_t event)
+{
+    return {run, event / eventsPerLumi + 1, event};
+}
+
+// Spilled run files of the deduplicators using the directory, which each
+// spill into a directory of their own within it
+long long countSpilledRuns(const std::string& spillDir)
+{
+    long long runs{0};
+    for (fs::directory_iterator dir{spillDir}; dir != fs::directory_iterator{}; ++dir)
+    {
+        if (fs::is_directory(dir->status()))
+        {
+            runs += std::distance(fs::directory_iterator{dir->path()}, fs::directory_iterator{});
+        }
+    }
+    return runs;
+}
+
+// Fills the directory with a file of random keys for every run, named as
+// the deduplicator names its spill files
+void writeStaleRuns(const std::string& spillDir, const int numRuns, const uint32_t maxEvent, std::mt19937& generator)
+{
+    fs::create_directories(spillDir);
+    std::uniform_int_distribution<uint32_t> eventNumber{1, maxEvent};
+    for (int run{firstRun}; run < firstRun + numRuns; run++)
+    {
+        std::vector<uint64_t> keys;
+        for (int i{0}; i < 1000; i++)
+        {
+            const EventDeduplicator::Event event{makeEvent(run, eventNumber(generator))};
+            keys.push_back(static_cast<uint64_t>(event.lumi) << 32 | event.event);
+        }
+        std::sort(keys.begin(), keys.end());
+        std::ofstream out{spillDir + "/run" + std::to_string(run) + ".keys", std::ios::binary};
+        out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(uint64_t)));
+        if (!out.flush())
+        {
+            throw std::runtime_error("Couldn't write stale keys to " + spillDir);
+        }
+    }
+}
+
+struct Result
+{
+    long long mismatches;
+    long long found;
+    double seconds;
+};
+
+// Looks up every query in parallel
+template <typename Contains>
+Result lookUp(const std::vector<EventDeduplicator::Event>& queries, const std::vector<char>& expected, const unsigned threads, Contains contains)
+{
+    std::atomic<long long> mismatches{0};
+    std::atomic<long long> found{0};
+    const auto start{std::chrono::steady_clock::now()};
+    std::vector<std::thread> workers;
+    for (unsigned t{0}; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            long long threadMismatches{0};
+            long long threadFound{0};
+            for (size_t i{t}; i < queries.size(); i += threads)
+            {
+                const bool isFound{contains(queries[i])};
+                threadFound += isFound;
+                threadMismatches += isFound != static_cast<bool>(expected[i]);
+            }
+            mismatches += threadMismatches;
+            found += threadFound;
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+    return {mismatches, found, elapsed.count()};
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t numEvents;
+    int numRuns;
+    size_t numQueries;
+    unsigned threads;
+    std::string spillDir;
+    unsigned seed;
+
+    po::options_description desc{"Options"};
+    desc.add_options()("help,h", "Print this message.")(
+        "events,n",
+        po::value<size_t>(&numEvents)->default_value(1000000),
+        "Number of events added, each twice.")(
+        "runs",
+        po::value<int>(&numRuns)->default_value(200),
+        "Number of runs the events are spread over.")(
+        "queries",
+        po::value<size_t>(&numQueries)->default_value(2000000),
+        "Number of lookups.")(
+        "threads,j",
+        po::value<unsigned>(&threads)->default_value(4),
+        "Number of threads looking up events.")(
+        "spillDir",
+        po::value<std::string>(&spillDir)->default_value((fs::temp_directory_path() / fs::unique_path("dedup%%%%-%%%%")).string()),
+        "Directory for the spilled runs, removed afterwards.")(
+        "seed", po::value<unsigned>(&seed)->default_value(12345), "Random seed.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+        if (numEvents == 0 || numRuns < 1)
+        {
+            throw po::error("Nothing to add");
+        }
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    threads = std::max(threads, 1u);
+
+    // About one event number in ten of each run is taken
+    std::mt19937 generator{seed};
+    const uint32_t maxEvent{static_cast<uint32_t>(10 * numEvents / static_cast<size_t>(numRuns)) + 1};
+    std::uniform_int_distribution<int> addedRun{firstRun, firstRun + numRuns - 1};
+    std::uniform_int_distribution<int> queriedRun{firstRun, firstRun + numRuns + numRuns / 10};
+    std::uniform_int_distribution<uint32_t> eventNumber{1, maxEvent};
+    std::vector<EventDeduplicator::Event> events;
+    for (size_t i{0}; i < numEvents; i++)
+    {
+        events.push_back(makeEvent(addedRun(generator), eventNumber(generator)));
+    }
+    std::vector<EventDeduplicator::Event> queries;
+    for (size_t i{0}; i < numQueries; i++)
+    {
+        queries.push_back(i % 2 ? makeEvent(queriedRun(generator), eventNumber(generator))
+                                : events[std::uniform_int_distribution<size_t>{0, numEvents - 1}(generator)]);
+    }
+
+    EventSet reference;
+    for (int pass{0}; pass < 2; pass++)
+    {
+        for (const auto& event : events)
+        {
+            reference.emplace(event.run, static_cast<int>(event.event));
+        }
+    }
+    std::vector<char> expected;
+    for (const auto& query : queries)
+    {
+        expected.push_back(reference.count({query.run, static_cast<int>(query.event)}) > 0);
+    }
+    const size_t distinctBytes{reference.size() * sizeof(uint64_t)};
+
+    const Result referenceResult{lookUp(queries, expected, threads, [&reference](const EventDeduplicator::Event& event) {
+        return reference.count({event.run, static_cast<int>(event.event)}) > 0;
+    })};
+    std::cout << reference.size() << " distinct events in " << numRuns << " runs, " << queries.size() << " lookups, "
+              << referenceResult.found << " found" << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(12) << "unordered_set" << std::right
+              << std::setw(10) << 1e9 * referenceResult.seconds / static_cast<double>(queries.size()) << " ns/lookup"
+              << std::endl;
+
+    struct Mode
+    {
+        std::string name;
+        size_t memoryBudget;
+        std::string spillDir;
+        bool staleRuns;
+    };
+    const std::vector<Mode> modes{{"in memory", 0, "", false},
+                                  {"spilled", distinctBytes + distinctBytes / 2, spillDir + "/spilled", false},
+                                  {"evicted", distinctBytes / 10, spillDir + "/evicted", false},
+                                  {"reused", distinctBytes + distinctBytes / 2, spillDir + "/reused", true}};
+
+    bool failed{false};
+    try
+    {
+        for (const auto& mode : modes)
+        {
+            if (mode.staleRuns)
+            {
+                writeStaleRuns(mode.spillDir, numRuns, maxEvent, generator);
+            }
+            EventDeduplicator deduplicator{mode.memoryBudget, mode.spillDir};
+            for (int pass{0}; pass < 2; pass++)
+            {
+                // In batches, as the skimmer adds the events of a file
+                for (size_t begin{0}; begin < events.size(); begin += 10000)
+                {
+                    deduplicator.add({events.begin() + static_cast<std::ptrdiff_t>(begin),
+                                      events.begin() + static_cast<std::ptrdiff_t>(std::min(begin + 10000, events.size()))});
+                }
+            }
+            deduplicator.freeze();
+            const long long spilledRuns{mode.spillDir.empty() ? 0 : countSpilledRuns(mode.spillDir)};
+
+            const Result result{lookUp(queries, expected, threads, [&deduplicator](const EventDeduplicator::Event& event) {
+                return deduplicator.contains(event);
+            })};
+            const bool evicted{deduplicator.bytes() < distinctBytes};
+
+            std::cout << std::left << std::setw(12) << mode.name << std::right << std::setw(10)
+                      << 1e9 * result.seconds / static_cast<double>(queries.size()) << " ns/lookup, "
+                      << deduplicator.size() << " events, " << spilledRuns << " runs spilled, "
+                      << deduplicator.bytes() / 1024 << " kB in memory after the lookups, " << result.mismatches
+                      << " mismatches" << std::endl;
+
+            if (result.mismatches > 0 || deduplicator.size() != reference.size())
+            {
+                std::cerr << "ERROR: " << mode.name << " deduplicator disagrees with the unordered_set" << std::endl;
+                failed = true;
+            }
+            // Make sure each mode took the path it is meant to check
+            if ((mode.spillDir.empty() && spilledRuns > 0) || (!mode.spillDir.empty() && spilledRuns == 0)
+                || evicted != (mode.name == "evicted"))
+            {
+                std::cerr << "ERROR: " << mode.name << " deduplicator didn't spill or evict as expected" << std::endl;
+                failed = true;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        failed = true;
+    }
+    boost::system::error_code error;
+    fs::remove_all(spillDir, error);
+
+    return failed ? 1 : 0;
+}
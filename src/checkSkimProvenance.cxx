@@ -0,0 +1,89 @@
+#include "analysisAlgo.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Checks that the skims analysisMain.exe -g stamps are accepted by -u with the
+// same options, i.e. that both compute the same provenance hash for every
+// dataset, of opposite and same sign skims. Takes the options of
+// analysisMain.exe, without -g or -u, e.g.
+//   ./bin/checkSkimProvenance.exe -c configs/2017/mumu_HtoSS_MS0p8.yaml --NPLs
+// With --NPLs, the NPL datasets are checked against the skim of the dataset
+// they read. With --entryListSkim, the -u run must also chain the tree of the
+// ntuples -g chained, as it reads the entries -g selected from them. Only the
+// configs are read, no ntuples or skims.
+
+namespace
+{
+std::vector<AnalysisAlgo::SkimProvenance> skimProvenances(const std::vector<std::string>& options, const std::string& mode)
+{
+    std::vector<std::string> args{options};
+    args.push_back(mode);
+    std::vector<char*> argv;
+    for (auto& arg : args)
+    {
+        argv.push_back(&arg[0]);
+    }
+    AnalysisAlgo analysis;
+    analysis.parseCommandLineArguements(static_cast<int>(argv.size()), argv.data());
+    return analysis.skimProvenances();
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::vector<std::string> options{argv, argv + argc};
+    bool entryListSkim{false};
+    for (const auto& option : options)
+    {
+        if (option == "-g" || option == "-u")
+        {
+            std::cerr << "ERROR: " << option << " is added by the check, give the options they share" << std::endl;
+            return 1;
+        }
+        entryListSkim = entryListSkim || option == "--entryListSkim";
+    }
+
+    try
+    {
+        const std::vector<AnalysisAlgo::SkimProvenance> made{skimProvenances(options, "-g")};
+        const std::vector<AnalysisAlgo::SkimProvenance> read{skimProvenances(options, "-u")};
+
+        long long mismatches{0};
+        for (const auto& reader : read)
+        {
+            // NPL copies of a dataset read the skim made for the dataset itself
+            auto maker{made.begin()};
+            while (maker != made.end() && (maker->dataset != reader.dataset || maker->plotLabel == "NPL"))
+            {
+                ++maker;
+            }
+            if (maker == made.end())
+            {
+                std::cerr << "ERROR: -g makes no skim of " << reader.dataset << std::endl;
+                mismatches++;
+                continue;
+            }
+            if (maker->opposite != reader.opposite || maker->inverted != reader.inverted)
+            {
+                std::cerr << "ERROR: -u wouldn't accept the " << (maker->opposite != reader.opposite ? "" : "same sign ")
+                          << "skim of " << reader.dataset << " (" << reader.plotLabel << ") made by -g" << std::endl;
+                mismatches++;
+            }
+            if (entryListSkim && maker->treeName != reader.treeName)
+            {
+                std::cerr << "ERROR: -u --entryListSkim chains " << reader.treeName << " of " << reader.dataset
+                          << ", but -g --entryListSkim selected entries of " << maker->treeName << std::endl;
+                mismatches++;
+            }
+        }
+        std::cout << read.size() << " datasets checked, " << mismatches << " mismatches" << std::endl;
+        return mismatches == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,84 @@
+#include "entryList.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Combines entry lists made by analysisMain.exe -g --entryListSkim, e.g. from
+// different selections or datasets, into one which can be passed to
+// analysisMain.exe --entryList.
+
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> inputs;
+    std::string outputFile;
+    std::string operation;
+
+    po::options_description desc{"Options"};
+    desc.add_options()("help,h", "Print this message.")(
+        "input,i",
+        po::value<std::vector<std::string>>(&inputs)->multitoken()->required(),
+        "Entry lists to combine.")(
+        "output,o",
+        po::value<std::string>(&outputFile)->required(),
+        "Combined entry list.")(
+        "operation",
+        po::value<std::string>(&operation)->default_value("intersection"),
+        "intersection keeps the entries passing every selection, union the "
+        "entries passing any. An intersection drops the files which aren't in "
+        "every list.");
+    po::positional_options_description positional;
+    positional.add("input", -1);
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+        if (operation != "intersection" && operation != "union")
+        {
+            throw po::invalid_option_value(operation);
+        }
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        EntryList combined{inputs.front()};
+        for (auto input{inputs.begin() + 1}; input != inputs.end(); ++input)
+        {
+            if (operation == "intersection")
+            {
+                combined.intersect(EntryList{*input});
+            }
+            else
+            {
+                combined.unite(EntryList{*input});
+            }
+        }
+        combined.write(outputFile);
+        std::cout << "Saved " << combined.size() << " entries of " << combined.files() << " files to " << outputFile
+                  << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -1,8 +1,15 @@
 // config_parser.cpp
 #include "config_parser.hpp"
 
+#include "Compression.h"
+#include "RVersion.h"
+
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -169,3 +176,145 @@ void Parser::parse_plots(const std::string plotConf,
         cutStage.emplace_back((*it)["cutStage"].as<int>());
     }
 }
+
+// For running over a grid of signal point configs in one pass. Checks that the
+// configs only differ in their signal datasets and output folder, and that
+// every dataset shared between points has the same definition everywhere.
+// Returns the dataset configs which aren't in the first point, each once.
+std::vector<std::string> Parser::parse_grid(const std::vector<std::string>& confs, std::vector<GridPoint>& points) {
+    struct GridDataset {
+        std::string file;
+        std::string definition;
+        std::string histogram;
+        bool isMC;
+        size_t numPoints;
+    };
+    std::map<std::string, GridDataset> gridDatasets;
+    std::vector<std::string> newDatasetConfs;
+
+    std::string sharedSettings;
+    for (size_t i{0}; i < confs.size(); i++) {
+        const YAML::Node root{YAML::LoadFile(confs[i])};
+
+        // Everything but the datasets and output folder must be shared
+        std::string settings;
+        for (const std::string key : {"cuts", "plots", "outputPostfix", "channelName"}) {
+            settings += key + ": " + (root[key] ? root[key].as<std::string>() : "") + "\n";
+        }
+        if (i == 0) {
+            sharedSettings = settings;
+        }
+        else if (settings != sharedSettings) {
+            throw std::runtime_error("Grid config " + confs[i] + " has different cuts, plots, postfix or channel to " + confs.front());
+        }
+
+        GridPoint point{confs[i], root["outputFolder"] ? root["outputFolder"].as<std::string>() : "", {}, {}};
+        for (const auto& file : root["datasets"].as<std::vector<std::string>>()) {
+            const YAML::Node dataset{YAML::LoadFile(file)};
+            const std::string name{dataset["name"].as<std::string>()};
+            const std::string definition{YAML::Dump(dataset)};
+
+            if (std::find(point.datasets.begin(), point.datasets.end(), name) != point.datasets.end()) {
+                continue;
+            }
+            point.datasets.emplace_back(name);
+
+            const auto found{gridDatasets.find(name)};
+            if (found == gridDatasets.end()) {
+                gridDatasets[name] = {file, definition, dataset["histogram"].as<std::string>(), dataset["mc"].as<bool>(), 1};
+                if (i > 0) {
+                    newDatasetConfs.emplace_back(file);
+                }
+            }
+            else if (found->second.definition != definition) {
+                throw std::runtime_error("Dataset " + name + " is defined differently in " + found->second.file + " and " + file);
+            }
+            else {
+                found->second.numPoints++;
+            }
+        }
+        points.emplace_back(point);
+    }
+
+    // Histograms are filled once for all points, so a point may only use a
+    // histogram if it contains every dataset filling it. Data must be shared
+    // by all points to keep the same luminosity.
+    std::map<std::string, std::vector<std::string>> histogramDatasets;
+    size_t numBackgrounds{0};
+    for (const auto& [name, dataset] : gridDatasets) {
+        histogramDatasets[dataset.histogram].emplace_back(name);
+        if (dataset.numPoints == points.size()) {
+            numBackgrounds++;
+        }
+        else if (!dataset.isMC) {
+            throw std::runtime_error("Data dataset " + name + " must be in every grid config");
+        }
+    }
+    for (auto& point : points) {
+        const std::set<std::string> pointDatasets{point.datasets.begin(), point.datasets.end()};
+        for (const auto& name : point.datasets) {
+            const std::string& histogram{gridDatasets[name].histogram};
+            if (std::find(point.histograms.begin(), point.histograms.end(), histogram) != point.histograms.end()) {
+                continue;
+            }
+            for (const auto& other : histogramDatasets[histogram]) {
+                if (pointDatasets.find(other) == pointDatasets.end()) {
+                    throw std::runtime_error("Histogram " + histogram + " of grid config " + point.config + " would also be filled by dataset " + other + " from another config");
+                }
+            }
+            point.histograms.emplace_back(histogram);
+        }
+    }
+
+    std::cout << "Grid of " << points.size() << " configs sharing " << numBackgrounds << " datasets, with "
+              << gridDatasets.size() - numBackgrounds << " datasets in only some configs" << std::endl;
+
+    return newDatasetConfs;
+}
+
+namespace {
+// ROOT compression settings of a {algorithm, level} node, -1 if there is none
+int parse_compression(const YAML::Node& node, const std::string& conf) {
+    static const std::map<std::string, ROOT::ECompressionAlgorithm> algorithms{
+        {"zlib", ROOT::kZLIB}, {"lzma", ROOT::kLZMA}, {"lz4", ROOT::kLZ4},
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 20, 0)
+        {"zstd", ROOT::kZSTD},
+#endif
+    };
+
+    if (!node) {
+        return -1;
+    }
+    const std::string algorithm{node["algorithm"].as<std::string>()};
+    const auto found{algorithms.find(algorithm)};
+    if (found == algorithms.end() && algorithm == "zstd") {
+        throw std::runtime_error("Compression algorithm zstd in " + conf
+                                 + " needs ROOT 6.20 or later, but this is ROOT " + ROOT_RELEASE);
+    }
+    if (found == algorithms.end()) {
+        throw std::runtime_error("Unknown compression algorithm " + algorithm + " in " + conf);
+    }
+    return ROOT::CompressionSettings(found->second, node["level"].as<int>());
+}
+} // namespace
+
+Parser::SkimConfig Parser::parse_skim(const std::string& conf) {
+    const YAML::Node root{YAML::LoadFile(conf)};
+    SkimConfig skim{root["branches"].as<std::vector<std::string>>(), -1};
+    if (skim.branches.empty()) {
+        throw std::runtime_error("No branches to keep in skim config " + conf);
+    }
+    skim.compression = parse_compression(root["compression"], conf);
+    return skim;
+}
+
+Parser::OutputPolicy Parser::parse_output_policy(const std::string& conf) {
+    const YAML::Node root{YAML::LoadFile(conf)};
+    OutputPolicy policy{parse_compression(root["compression"], conf), root["basketSize"].as<int>(-1), {}};
+    for (const auto& rule : root["branches"]) {
+        policy.rules.push_back({rule["pattern"].as<std::string>(),
+                                parse_compression(rule["compression"], conf),
+                                rule["basketSize"].as<int>(-1)});
+    }
+    return policy;
+}
@@ -0,0 +1,179 @@
+#include "TFile.h"
+#include "TH1D.h"
+#include "config_parser.hpp"
+#include "histogramFile.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Converts a histogram directory in the old layout, one file per plot, cut
+// stage and dataset, into the single file read by analysisMain.exe
+// --useHistos. The old files are named
+//     <plot>_<dataset>_<stage><systematic>_<channel>_Histo.root
+//     <dataset>_<channel>_cutFlow_Histo.root
+// and the plot names are taken from the plot config, as they may contain
+// underscores themselves.
+
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+    std::string inputDir;
+    std::string outputFile;
+    std::string plotConf;
+    int compression;
+
+    po::options_description desc{"Options"};
+    desc.add_options()("help,h", "Print this message.")(
+        "input,i",
+        po::value<std::string>(&inputDir)->required(),
+        "Histogram directory in the old layout.")(
+        "output,o",
+        po::value<std::string>(&outputFile),
+        "Output file. Defaults to the histogram file in the input directory.")(
+        "plotConf",
+        po::value<std::string>(&plotConf)->default_value("configs/plots/plotDileptonConf.yaml"),
+        "Plot configuration the histograms were made with.")(
+        "compression",
+        po::value<int>(&compression)->default_value(-1),
+        "ROOT compression setting of the output. The ROOT default if negative.");
+    po::variables_map vm;
+
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    if (outputFile.empty())
+    {
+        outputFile = (fs::path{inputDir} / HistogramFile::fileName).string();
+    }
+
+    std::vector<std::string> titles;
+    std::vector<std::string> names;
+    std::vector<float> xMins;
+    std::vector<float> xMaxs;
+    std::vector<int> nBins;
+    std::vector<std::string> fillExps;
+    std::vector<std::string> xAxisLabels;
+    std::vector<int> cutStages;
+    Parser::parse_plots(plotConf, titles, names, xMins, xMaxs, nBins, fillExps, xAxisLabels, cutStages);
+
+    const std::regex cutFlowFile{"(.+)_(ee|mumu|emu)_cutFlow_Histo\\.root"};
+    const std::regex plotFile{"(.+)_(lepSel|zMass|trackSel|higgsSel)((?:__[A-Za-z]+__(?:plus|minus))?)_(ee|mumu|emu)_Histo\\.root"};
+
+    HistogramFile::Writer writer;
+    std::vector<std::unique_ptr<TH1D>> histograms;
+    std::vector<HistogramFile::Key> keys;
+    for (const auto& entry : boost::make_iterator_range(fs::directory_iterator{inputDir}, {}))
+    {
+        const std::string fileName{entry.path().filename().string()};
+        std::smatch match;
+        HistogramFile::Key key;
+        std::string histName;
+        if (std::regex_match(fileName, match, cutFlowFile))
+        {
+            key = {match[1], match[2], "cutFlow", HistogramFile::nominal, "cutFlow"};
+            histName = key.dataset + "cutFlow";
+        }
+        else if (std::regex_match(fileName, match, plotFile))
+        {
+            // Longest plot name followed by the dataset
+            const std::string plotDataset{match[1]};
+            std::string plotName;
+            for (const auto& name : names)
+            {
+                if (name.size() > plotName.size() && plotDataset.size() > name.size() + 1
+                    && plotDataset.compare(0, name.size() + 1, name + "_") == 0)
+                {
+                    plotName = name;
+                }
+            }
+            if (plotName.empty())
+            {
+                std::cerr << "Skipping " << fileName << ", plot not in " << plotConf << std::endl;
+                continue;
+            }
+            const std::string systematic{match[3]};
+            key = {plotDataset.substr(plotName.size() + 1),
+                   match[4],
+                   match[2],
+                   systematic.empty() ? HistogramFile::nominal : systematic.substr(2),
+                   plotName};
+            histName = fileName.substr(0, fileName.size() - std::string{"_Histo.root"}.size());
+        }
+        else
+        {
+            continue;
+        }
+
+        TFile inFile{entry.path().string().c_str(), "READ"};
+        TH1D* hist{nullptr};
+        inFile.GetObject(histName.c_str(), hist);
+        if (!hist)
+        {
+            std::cerr << "Skipping " << fileName << ", no histogram " << histName << std::endl;
+            continue;
+        }
+        hist->SetDirectory(nullptr);
+        histograms.emplace_back(hist);
+        writer.add(key, hist);
+        keys.push_back(key);
+        inFile.Close();
+    }
+
+    if (writer.empty())
+    {
+        std::cerr << "No histograms found in " << inputDir << std::endl;
+        return 1;
+    }
+    writer.write(outputFile, compression);
+
+    // Read the file back as --useHistos does, and check that every histogram
+    // comes out as it went in
+    try
+    {
+        const HistogramFile::Reader reader{outputFile};
+        for (size_t i{0}; i < keys.size(); i++)
+        {
+            const TH1D* written{histograms[i].get()};
+            const TH1D* read{reader.get(keys[i])};
+            bool same{read->GetNbinsX() == written->GetNbinsX() && read->GetEntries() == written->GetEntries()};
+            for (int bin{0}; same && bin <= written->GetNbinsX() + 1; bin++)
+            {
+                same = read->GetBinContent(bin) == written->GetBinContent(bin)
+                       && read->GetBinError(bin) == written->GetBinError(bin);
+            }
+            if (!same)
+            {
+                throw std::runtime_error("Histogram " + HistogramFile::path(keys[i]) + " differs when read back");
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Read back " << keys.size() << " histograms from " << outputFile << std::endl;
+}
@@ -6,7 +6,10 @@
 #include "TLorentzVector.h"
 #include "TRandom.h"
 #include "cutClass.hpp"
+#include "deltaRKernel.hpp"
 
+#include <algorithm>
+#include <array>
 #include <boost/functional/hash.hpp>
 #include <cmath>
 #include <fstream>
@@ -15,6 +18,7 @@
 #include <limits>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <yaml-cpp/yaml.h>
 
 Cuts::Cuts(const bool doPlots,
@@ -22,7 +26,9 @@ Cuts::Cuts(const bool doPlots,
            const bool invertLepCut,
            const bool is2016,
            const bool is2018)
-    : doPlots_{doPlots}
+    : plotMap_{nullptr}
+    , cutFlow_{nullptr}
+    , doPlots_{doPlots}
     , fillCutFlow_{fillCutFlows}
     , invertLepCut_{invertLepCut}
     , is2016_{is2016}
@@ -59,6 +65,13 @@ Cuts::Cuts(const bool doPlots,
     , higgsMassCut_{20.}
     , invWMassCut_{999999.}
 
+    , minMumuVtxSigXY_{0.}
+    , maxMumuVtxChi2Ndof_{std::numeric_limits<double>::infinity()}
+    , minMumuVtxCosPointingXY_{-1.}
+    , minChsVtxSigXY_{0.}
+    , maxChsVtxChi2Ndof_{std::numeric_limits<double>::infinity()}
+    , minChsVtxCosPointingXY_{-1.}
+
     , numJets_{0}
     , maxJets_{20}
     , jetPt_{0.}
@@ -84,7 +97,7 @@ Cuts::Cuts(const bool doPlots,
     , isNPL_{false}
     , isZplusCR_{false}
 
-    , postLepSelTree_{nullptr}
+    , lastStep_{SelectionStep::None}
 
     // Skips running trigger stuff
     , skipTrigger_{false}
@@ -99,6 +112,17 @@ Cuts::Cuts(const bool doPlots,
     , metDileptonCut_{50.0}
 
 {
+    buildPipeline({{"stage", "trigger"},
+                   {"stage", "metFilters"},
+                   {"stage", "leptons"},
+                   {"stage", "jets"},
+                   {"stage", "scalarMass"},
+                   {"fill", "trackSel"},
+                   {"stage", "dileptonDeltaR"},
+                   {"stage", "chsDeltaR"},
+                   {"stage", "higgsMass"},
+                   {"fill", "higgsSel"}});
+
     std::cout << "\nInitialises fine" << std::endl;
     initialiseJECCors();
     std::cout << "Gets past JEC Cors" << std::endl;
@@ -289,68 +313,198 @@ void Cuts::parse_config(const std::string confName)
     maxbJetEta_ = jets["maxbJetEta"].as<double>();
     // numcJets_ = jets["numcJets"].as<unsigned>();
 
+    // Optional refitted vertex cuts, applied by the mumuVertex and chsVertex
+    // pipeline stages
+    const auto parseVertexCuts{[](const YAML::Node& vertex, double& minSigXY, double& maxChi2Ndof, double& minCosPointingXY) {
+        if (!vertex) return;
+        if (vertex["minSigXY"]) minSigXY = vertex["minSigXY"].as<double>();
+        if (vertex["maxChi2Ndof"]) maxChi2Ndof = vertex["maxChi2Ndof"].as<double>();
+        if (vertex["minCosPointingXY"]) minCosPointingXY = vertex["minCosPointingXY"].as<double>();
+    }};
+    parseVertexCuts(cuts["mumuVertex"], minMumuVtxSigXY_, maxMumuVtxChi2Ndof_, minMumuVtxCosPointingXY_);
+    parseVertexCuts(cuts["chsVertex"], minChsVtxSigXY_, maxChsVtxChi2Ndof_, minChsVtxCosPointingXY_);
+
+    // Optional selection pipeline. Plain entries are cut stages, entries of
+    // the form "fill: stageName" fill the cut flow and plots for that stage.
+    if (config["pipeline"])
+    {
+        const YAML::Node pipeline{config["pipeline"]};
+        std::vector<std::pair<std::string, std::string>> stages;
+        for (const auto& stage : pipeline["stages"])
+        {
+            if (stage.IsMap() && stage["fill"])
+            {
+                stages.emplace_back("fill", stage["fill"].as<std::string>());
+            }
+            else
+            {
+                stages.emplace_back("stage", stage.as<std::string>());
+            }
+        }
+        buildPipeline(stages);
+        pipeline_.setReordering(
+            pipeline["reorder"] ? pipeline["reorder"].as<bool>() : false,
+            pipeline["reorderInterval"]
+                ? pipeline["reorderInterval"].as<long long>()
+                : 1000);
+    }
+
+    // Optional grid of working points, only used with --scanDir
+    if (config["scan"])
+    {
+        scan_.parse_config(config["scan"]);
+    }
+
     std::cerr << "And so it's looking for " << numTightMu_ << " muons and "
               << numTightEle_ << " electrons" << std::endl;
 }
 
-bool Cuts::makeCuts(AnalysisEvent& event, double& eventWeight, std::map<std::string, std::shared_ptr<Plots>>& plotMap, TH1D& cutFlow, const int systToRun) {
+bool Cuts::makeCuts(AnalysisEvent& event, double& eventWeight, std::map<std::string, std::shared_ptr<Plots>>& plotMap, CutFlow& cutFlow, const int systToRun) {
+    plotMap_ = &plotMap;
+    cutFlow_ = &cutFlow;
+    lastStep_ = SelectionStep::None;
+    if (doPlots_ || fillCutFlow_) cutFlowMark_ = CutFlow::Clock::now();
+    return pipeline_.run(event, eventWeight, systToRun);
+}
 
-    if (!skipTrigger_) {
-        if (!triggerCuts(event, eventWeight, systToRun))  return false; // Do trigger cuts
+void Cuts::fillCutFlow(CutFlow& cutFlow, const AnalysisEvent& event, const size_t stage, const double eventWeight) {
+    cutFlow.fill(stage, eventWeight);
+    cutFlow.addTime(stage, cutFlowMark_);
+    if (event.weightVariations.empty()) return;
+    for (size_t k{0}; k < weightCutFlows_.size(); k++) {
+        weightCutFlows_[k]->fill(stage, eventWeight * event.weightVariations[k]);
     }
+}
 
-    if (!metFilters(event)) return false;
-
-    // Make lepton cuts. If the trigLabel contains d, we are in the ttbar CR so the Z mass cut is skipped
-    if (!makeLeptonCuts(event, eventWeight, plotMap, cutFlow, systToRun)) return false;
-
-    std::tie(event.jetIndex, event.jetSmearValue) =  makeJetCuts(event, systToRun, eventWeight, true);
-    event.bTagIndex = makeBCuts(event, event.jetIndex, systToRun);
-
-    if ( (event.chsPairVec.first + event.chsPairVec.second).M() > scalarMassCut_ && !skipScalarMassCut_ ) return false;
-
-    if (doPlots_ || fillCutFlow_) cutFlow.Fill(2.5, eventWeight);
-    if (doPlots_) plotMap["trackSel"]->fillAllPlots(event, eventWeight);
-
-//    if (event.jetIndex.size() < numJets_) return false;
-//    if (event.jetIndex.size() > maxJets_) return false;
-//    if (event.bTagIndex.size() < numbJets_) return false;
-//    if (event.bTagIndex.size() > maxbJets_) return false;
-
-    if ( event.zPairLeptons.first.DeltaR(event.zPairLeptons.second) < 0.3 ) return false;
-    if ( event.chsPairVec.first.DeltaR(event.chsPairVec.second) < 0.3 ) return false;
-    if ( ((event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).M() - 125.2) > higgsMassCut_ && !skipScalarMassCut_ ) return false;
-
-    if (doPlots_) plotMap["higgsSel"]->fillAllPlots(event, eventWeight);
-    if (doPlots_ || fillCutFlow_) cutFlow.Fill(3.5, eventWeight);
-
-    // Do wMass stuff
-//    double invWmass{0.};
-//    invWmass = getWbosonQuarksCand(event, event.jetIndex, systToRun);
-
-    // Debug chi2 cut
-    //   double topMass = getTopMass(event);
-    //   double topTerm = ( topMass-173.21 )/30.0;
-    //   double wTerm = ( (event.wPairQuarks.first +
-    //   event.wPairQuarks.second).M() - 80.3585 )/8.0;
-
-    //   double chi2 = topTerm*topTerm + wTerm*wTerm;
-    //   if ( chi2 < 2.0 && chi2 > 7.0 ) return false; // control region
-    //   if ( chi2 >= 2.0 ) return false; //signal region
-
-    // Signal Region W mass cut
-//    if (!isZplusCR_) if (std::abs(invWmass) > invWMassCut_) return false;
-
-    // Z+jets Control Region
-/*    else {
-        if (std::abs(invWmass) <= invWMassCut_) return false;
-        if (event.metPF2PATEt >= metDileptonCut_) return false;
+void Cuts::buildPipeline(const std::vector<std::pair<std::string, std::string>>& stages) {
+    // Cut flow stage index of each stage that can be filled from the
+    // pipeline. lepSel and zMass are filled within makeLeptonCuts.
+    static const std::map<std::string, size_t> cutFlowStages{{"trackSel", 2}, {"higgsSel", 3}};
+
+    pipelineStages_ = stages;
+    pipeline_.clear();
+    for (const auto& [type, name] : stages) {
+        if (type == "fill") {
+            if (cutFlowStages.find(name) == cutFlowStages.end()) {
+                throw std::runtime_error("Unknown cut flow stage in pipeline: " + name);
+            }
+            const size_t stage{cutFlowStages.at(name)};
+            pipeline_.addStage("fill_" + name, [this, name, stage](AnalysisEvent& event, double& eventWeight, const int) {
+                if (doPlots_ || fillCutFlow_) fillCutFlow(*cutFlow_, event, stage, eventWeight);
+                if (doPlots_) (*plotMap_)[name]->fillAllPlots(event, eventWeight);
+                return true;
+            }, false);
+        }
+        else if (name == "trigger") {
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double& eventWeight, const int syst) {
+                return triggerCuts(event, eventWeight, syst);
+            }, true);
+        }
+        else if (name == "metFilters") {
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double&, const int) {
+                return metFilters(event);
+            }, true);
+        }
+        else if (name == "leptons") {
+            // Make lepton cuts. If the trigLabel contains d, we are in the ttbar CR so the Z mass cut is skipped
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double& eventWeight, const int syst) {
+                return makeLeptonCuts(event, eventWeight, *plotMap_, *cutFlow_, syst);
+            }, false);
+        }
+        else if (name == "jets") {
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double& eventWeight, const int syst) {
+                setJets(event, makeJetCuts(event, syst, eventWeight, true));
+                std::vector<int> bJets{makeBCuts(event, event.jetIndex, syst)};
+                if (bJets != event.bTagIndex) event.derivedCache.invalidate(DerivedCache::Jets);
+                event.bTagIndex = std::move(bJets);
+                lastStep_ = SelectionStep::Jets;
+                return true;
+            }, false);
+        }
+        else if (name == "scalarMass") {
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double&, const int) {
+                return !((event.chsPairVec.first + event.chsPairVec.second).M() > scalarMassCut_ && !skipScalarMassCut_);
+            }, true);
+        }
+        else if (name == "dileptonDeltaR") {
+            pipeline_.addStage(name, [](AnalysisEvent& event, double&, const int) {
+                return !(event.zPairLeptons.first.DeltaR(event.zPairLeptons.second) < 0.3);
+            }, true);
+        }
+        else if (name == "chsDeltaR") {
+            pipeline_.addStage(name, [](AnalysisEvent& event, double&, const int) {
+                return !(event.chsPairVec.first.DeltaR(event.chsPairVec.second) < 0.3);
+            }, true);
+        }
+        else if (name == "higgsMass") {
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double&, const int) {
+                return !(((event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).M() - 125.2) > higgsMassCut_ && !skipScalarMassCut_);
+            }, true);
+        }
+        else if (name == "mumuVertex") {
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double&, const int) {
+                return passPairVertexCuts(event.muonTkPairVertices, event.mumuTrkIndex, minMumuVtxSigXY_, maxMumuVtxChi2Ndof_, minMumuVtxCosPointingXY_);
+            }, true);
+        }
+        else if (name == "chsVertex") {
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double&, const int) {
+                return passPairVertexCuts(event.chsTkPairVertices, event.chsPairTrkIndex, minChsVtxSigXY_, maxChsVtxChi2Ndof_, minChsVtxCosPointingXY_);
+            }, true);
+        }
+        else if (name == "scan") {
+            // Evaluates every working point of the scan and stops here, the
+            // nominal selection is only used as a preselection in scan mode
+            pipeline_.addStage(name, [this](AnalysisEvent& event, double& eventWeight, const int syst) {
+                if (syst == 0) scan_.fill(event, eventWeight);
+                return false;
+            }, false);
+        }
+        else {
+            throw std::runtime_error("Unknown cut pipeline stage: " + name);
+        }
     }
-*/
-//    if (doPlots_) plotMap["wMass"]->fillAllPlots(event, eventWeight);
-//    if (doPlots_ || fillCutFlow_) cutFlow.Fill(4.5, eventWeight);
+}
 
-    return true;
+void Cuts::enableScan() {
+    if (scan_.empty()) {
+        throw std::runtime_error("Scan mode requires a scan block in the cut configuration");
+    }
+
+    scan_.setNominal(CutScan::MuonPtLeading, looseMuonPtLeading_);
+    scan_.setNominal(CutScan::MuonPt, looseMuonPt_);
+    scan_.setNominal(CutScan::MaxDileptonDeltaR, maxDileptonDeltaR_);
+    scan_.setNominal(CutScan::MaxChsDeltaR, maxChsDeltaR_);
+    scan_.setNominal(CutScan::ScalarMass, scalarMassCut_);
+    scan_.setNominal(CutScan::HiggsMass, higgsMassCut_);
+    scan_.setMuonSelection(is2016_, std::max(numTightMu_, numLooseMu_));
+
+    // Preselect at the loosest working point. The mass cuts can't be
+    // loosened as they are applied after choosing the candidates, so they
+    // are skipped and left to the scan.
+    looseMuonPtLeading_ = scan_.loosest(CutScan::MuonPtLeading);
+    looseMuonPt_ = scan_.loosest(CutScan::MuonPt);
+    maxDileptonDeltaR_ = scan_.loosest(CutScan::MaxDileptonDeltaR);
+    maxChsDeltaR_ = scan_.loosest(CutScan::MaxChsDeltaR);
+    skipScalarMassCut_ = true;
+
+    // The scan replaces the stages it covers and the cut flow fills
+    static const std::vector<std::string> scannedStages{"scalarMass", "dileptonDeltaR", "chsDeltaR", "higgsMass"};
+    std::vector<std::pair<std::string, std::string>> stages;
+    for (const auto& stage : pipelineStages_) {
+        if (stage.first == "fill" || std::find(scannedStages.begin(), scannedStages.end(), stage.second) != scannedStages.end()) continue;
+        stages.emplace_back(stage);
+    }
+    if (std::find(stages.begin(), stages.end(), std::make_pair(std::string{"stage"}, std::string{"leptons"})) == stages.end()) {
+        throw std::runtime_error("Scan mode requires the leptons stage in the cut pipeline");
+    }
+    stages.emplace_back("stage", "scan");
+    buildPipeline(stages);
+
+    std::cout << "Scanning " << scan_.size() << " working points" << std::endl;
+}
+
+void Cuts::printPipelineSummary() const {
+    pipeline_.printSummary(std::cout);
 }
 
 std::vector<double> Cuts::getRochesterSFs(const AnalysisEvent& event) const
@@ -416,7 +570,7 @@ std::vector<double> Cuts::getRochesterSFs(const AnalysisEvent& event) const
 }
 
 // Make lepton cuts. Will become customisable in a config later on.
-bool Cuts::makeLeptonCuts( AnalysisEvent& event, double& eventWeight, std::map<std::string, std::shared_ptr<Plots>>& plotMap, TH1D& cutFlow, const int& syst ) {
+bool Cuts::makeLeptonCuts( AnalysisEvent& event, double& eventWeight, std::map<std::string, std::shared_ptr<Plots>>& plotMap, CutFlow& cutFlow, const int& syst ) {
 
     ////Do lepton selection.
 
@@ -427,7 +581,11 @@ bool Cuts::makeLeptonCuts( AnalysisEvent& event, double& eventWeight, std::map<s
 //    if (event.electronIndexLoose.size() != numLooseEle_) return false;
 
 //    event.muonIndexTight = getTightMuons(event);
-    event.muonIndexTight = getLooseMuons(event);
+    // Cached plot variables are only invalidated when the selection actually
+    // changes, so that they are shared between stages and systematics
+    std::vector<int> muons{getLooseMuons(event)};
+    if (muons != event.muonIndexTight) event.derivedCache.invalidate(DerivedCache::Leptons);
+    event.muonIndexTight = std::move(muons);
     if (event.muonIndexTight.size() < numTightMu_) return false;
 
     event.muonIndexLoose = getLooseMuons(event);
@@ -455,24 +613,38 @@ bool Cuts::makeLeptonCuts( AnalysisEvent& event, double& eventWeight, std::map<s
 
     // This is to make some skims for faster running. Do lepSel and save some
     // files.
-    if (postLepSelTree_) postLepSelTree_->Fill();
+    lastStep_ = SelectionStep::Muons;
 
 //    event.muonMomentumSF = getRochesterSFs(event);
 
-    if ( !getDileptonCand(event, event.muonIndexTight) ) return false;
+    const std::pair<int, int> zPairIndex{event.zPairIndex};
+    const int mumuTrkIndex{event.mumuTrkIndex};
+    const bool foundDilepton{getDileptonCand(event, event.muonIndexTight)};
+    if (event.zPairIndex != zPairIndex || event.mumuTrkIndex != mumuTrkIndex) event.derivedCache.invalidate(DerivedCache::Leptons);
+    if ( !foundDilepton ) return false;
+    lastStep_ = SelectionStep::Dilepton;
 
     // Get CHS
-    event.chsIndex = getChargedHadronTracks(event);
+    std::vector<int> chs{getChargedHadronTracks(event)};
+    bool hadronsChanged{chs != event.chsIndex};
+    event.chsIndex = std::move(chs);
+    if (hadronsChanged) event.derivedCache.invalidate(DerivedCache::Hadrons);
+    lastStep_ = SelectionStep::ChargedHadrons;
     if ( event.chsIndex.size() < 2 ) return false;
 
+    const std::pair<int, int> chsPairIndex{event.chsPairIndex};
+    const int chsPairTrkIndex{event.chsPairTrkIndex};
     getDihadronCand(event, event.chsIndex);
+    hadronsChanged = event.chsPairIndex != chsPairIndex || event.chsPairTrkIndex != chsPairTrkIndex;
+    if (hadronsChanged) event.derivedCache.invalidate(DerivedCache::Hadrons);
+    lastStep_ = SelectionStep::Dihadron;
 //    if ( !getDihadronCand(event) ) return false;
 
 //    eventWeight *= getLeptonWeight(event, syst);
 
-    if (doPlots_ || fillCutFlow_) std::tie(event.jetIndex, event.jetSmearValue) = makeJetCuts(event, syst, eventWeight, false);
+    if (doPlots_ || fillCutFlow_) setJets(event, makeJetCuts(event, syst, eventWeight, false));
     if (doPlots_) plotMap["lepSel"]->fillAllPlots(event, eventWeight);
-    if (doPlots_ || fillCutFlow_) cutFlow.Fill(0.5, eventWeight);
+    if (doPlots_ || fillCutFlow_) fillCutFlow(cutFlow, event, 0, eventWeight);
 
 
     if (isNPL_) { // if is NPL channel
@@ -493,13 +665,19 @@ bool Cuts::makeLeptonCuts( AnalysisEvent& event, double& eventWeight, std::map<s
 
     if ( (event.zPairLeptons.first + event.zPairLeptons.second).M() > scalarMassCut_ && !skipScalarMassCut_ ) return false;
 
-    if (doPlots_ || fillCutFlow_) std::tie(event.jetIndex, event.jetSmearValue) = makeJetCuts(event, syst, eventWeight, false);
+    if (doPlots_ || fillCutFlow_) setJets(event, makeJetCuts(event, syst, eventWeight, false));
     if (doPlots_) plotMap["zMass"]->fillAllPlots(event, eventWeight);
-    if (doPlots_ || fillCutFlow_) cutFlow.Fill(1.5, eventWeight);
+    if (doPlots_ || fillCutFlow_) fillCutFlow(cutFlow, event, 1, eventWeight);
 
     return true;
 }
 
+void Cuts::setJets(AnalysisEvent& event, std::pair<std::vector<int>, std::vector<double>> jets) const {
+    if (jets.first != event.jetIndex || jets.second != event.jetSmearValue) event.derivedCache.invalidate(DerivedCache::Jets);
+    event.jetIndex = std::move(jets.first);
+    event.jetSmearValue = std::move(jets.second);
+}
+
 std::vector<int> Cuts::getTightEles(const AnalysisEvent& event) const {
     std::vector<int> electrons;
 
@@ -698,12 +876,28 @@ bool Cuts::getDileptonCand(AnalysisEvent& event, const std::vector<int>& muons)
 
 bool Cuts::getDihadronCand(AnalysisEvent& event, const std::vector<int>& chs) const {
 
+    // Build each track and its direction once, the ΔR of all pairs with the
+    // first track of a pair is then done in one go
+    std::vector<TLorentzVector> chsVecs;
+    std::vector<double> chsEta;
+    std::vector<double> chsPhi;
+    chsVecs.reserve(chs.size());
+    chsEta.reserve(chs.size());
+    chsPhi.reserve(chs.size());
+    for (const int cand : chs) {
+        chsVecs.emplace_back(event.packedCandsPx[cand], event.packedCandsPy[cand], event.packedCandsPz[cand], event.packedCandsE[cand]);
+        chsEta.emplace_back(chsVecs.back().Eta());
+        chsPhi.emplace_back(chsVecs.back().Phi());
+    }
+    std::vector<double> delR2(chs.size());
 
     for ( unsigned int i{0}; i < chs.size(); i++ ) {
 
         if ( event.packedCandsMuonIndex[chs[i]] == event.muonPF2PATPackedCandIndex[event.zPairIndex.first] ) continue;
         if ( event.packedCandsMuonIndex[chs[i]] == event.muonPF2PATPackedCandIndex[event.zPairIndex.second] ) continue;
 
+        DeltaR::deltaR2Row(chsEta.data() + i + 1, chsPhi.data() + i + 1, chs.size() - i - 1, chsEta[i], chsPhi[i], delR2.data() + i + 1);
+
         for ( unsigned int j{i+1}; j < chs.size(); j++ ) {
             if ( event.packedCandsMuonIndex[chs[j]] == event.muonPF2PATPackedCandIndex[event.zPairIndex.first] ) continue;
             if ( event.packedCandsMuonIndex[chs[j]] == event.muonPF2PATPackedCandIndex[event.zPairIndex.second] ) continue;
@@ -712,13 +906,9 @@ bool Cuts::getDihadronCand(AnalysisEvent& event, const std::vector<int>& chs) co
 
             if (event.packedCandsCharge[chs[i]] * event.packedCandsCharge[chs[j]] >= 0) continue;
 
-            TLorentzVector chs1 {event.packedCandsPx[chs[i]], event.packedCandsPy[chs[i]], event.packedCandsPz[chs[i]], event.packedCandsE[chs[i]]};
-            TLorentzVector chs2 {event.packedCandsPx[chs[j]], event.packedCandsPy[chs[j]], event.packedCandsPz[chs[j]], event.packedCandsE[chs[j]]};
-
-            double delR { chs1.DeltaR(chs2) };
-            double higgsMass { (chs1+chs2+event.zPairLeptons.first+event.zPairLeptons.second).M() };
-
-            if ( delR < maxChsDeltaR_ ) {
+            if ( delR2[j] < maxChsDeltaR_ * maxChsDeltaR_ ) {
+                const TLorentzVector& chs1 {chsVecs[i]};
+                const TLorentzVector& chs2 {chsVecs[j]};
                 event.chsPairVec.first  = chs1.Pt() > chs2.Pt() ? chs1 : chs2;
                 event.chsPairVec.second = chs1.Pt() > chs2.Pt() ? chs2 : chs1;
                 event.chsPairIndex.first = chs1.Pt() > chs2.Pt() ? chs[i] : chs[j];
@@ -822,10 +1012,31 @@ std::pair<std::vector<int>, std::vector<double>>
     double err3{0.};
     double err4{0.};
 
-    for (int i{0}; i < event.numJetPF2PAT; i++)
+    // Corrected and smeared jets, made up front in jet order so that the
+    // cleaning below can take them all at once
+    const size_t numJets{static_cast<size_t>(event.numJetPF2PAT)};
+    std::vector<TLorentzVector> jetVecs;
+    std::array<double, AnalysisEvent::NJETSMAX> jetEta;
+    std::array<double, AnalysisEvent::NJETSMAX> jetPhi;
+    for (size_t i{0}; i < numJets; i++)
     {
-        auto [jetVec, smear] = getJetLVec(event, i, syst, true);
+        auto [jetVec, smear] = getJetLVec(event, static_cast<int>(i), syst, true);
         smears.emplace_back(smear);
+        jetEta[i] = jetVec.Eta();
+        jetPhi[i] = jetVec.Phi();
+        jetVecs.emplace_back(jetVec);
+    }
+
+    // ΔR² of each corrected jet to the closer of the two Z candidate leptons,
+    // for cleaning
+    const double lepEta[2]{event.zPairLeptons.first.Eta(), event.zPairLeptons.second.Eta()};
+    const double lepPhi[2]{event.zPairLeptons.first.Phi(), event.zPairLeptons.second.Phi()};
+    std::array<double, AnalysisEvent::NJETSMAX> lepDeltaR2;
+    DeltaR::minDeltaR2(jetEta.data(), jetPhi.data(), numJets, lepEta, lepPhi, 2, lepDeltaR2.data());
+
+    for (int i{0}; i < event.numJetPF2PAT; i++)
+    {
+        const TLorentzVector& jetVec{jetVecs[static_cast<size_t>(i)]};
 
         if (jetVec.Pt() <= jetPt_ || jetVec.Eta() >= jetEta_)
         {
@@ -983,16 +1194,7 @@ std::pair<std::vector<int>, std::vector<double>>
             continue;
         }
 
-        const double deltaLep{std::min(deltaR(event.zPairLeptons.first.Eta(),
-                                              event.zPairLeptons.first.Phi(),
-                                              jetVec.Eta(),
-                                              jetVec.Phi()),
-                                       deltaR(event.zPairLeptons.second.Eta(),
-                                              event.zPairLeptons.second.Phi(),
-                                              jetVec.Eta(),
-                                              jetVec.Phi()))};
-
-        if (deltaLep < 0.4 && isProper)
+        if (lepDeltaR2[static_cast<size_t>(i)] < 0.4 * 0.4 && isProper)
         {
             continue;
         }
@@ -1280,7 +1482,7 @@ bool Cuts::metFilters(const AnalysisEvent& event) const
 
 double Cuts::deltaPhi(const double& phi1, const double& phi2)
 {
-    return std::atan2(std::sin(phi1 - phi2), std::cos(phi1 - phi2));
+    return DeltaR::deltaPhi(phi1, phi2);
 }
 
 double Cuts::deltaR(const double& eta1,
@@ -1288,8 +1490,7 @@ double Cuts::deltaR(const double& eta1,
                     const double& eta2,
                     const double& phi2)
 {
-    return std::sqrt(std::pow(eta1 - eta2, 2)
-                     + std::pow(deltaPhi(phi1, phi2), 2));
+    return std::sqrt(DeltaR::deltaR2(eta1, phi1, eta2, phi2));
 }
 
 double Cuts::getLeptonWeight(const AnalysisEvent& event, const int& syst) const
@@ -1553,6 +1754,13 @@ int Cuts::getChsTrackPairIndex(const AnalysisEvent& event) const {
     return -1;
 }
 
+// A candidate without a refitted vertex fails
+bool Cuts::passPairVertexCuts(const PairVertices& vertices, const int index, const double minSigXY, const double maxChi2Ndof, const double minCosPointingXY) const {
+    if (index < 0 || static_cast<size_t>(index) >= vertices.size()) return false;
+    const size_t i{static_cast<size_t>(index)};
+    return vertices.sigXY[i] >= minSigXY && vertices.chi2Ndof[i] <= maxChi2Ndof && vertices.cosPointingXY[i] >= minCosPointingXY;
+}
+
 void Cuts::initialiseJECCors()
 {
     std::ifstream jecFile;
@@ -1727,13 +1935,15 @@ std::pair<TLorentzVector, double> Cuts::getJetLVec(const AnalysisEvent& event,
         jerSF -= jerSigma;
     }
 
+    std::array<float, AnalysisEvent::NJETSMAX> genDeltaR2;
+    DeltaR::deltaR2Row(event.genJetPF2PATEta, event.genJetPF2PATPhi, event.NJETSMAX, static_cast<float>(event.jetPF2PATEta[index]), static_cast<float>(event.jetPF2PATPhi[index]), genDeltaR2.data());
+
     std::optional<size_t> matchingGenIndex{std::nullopt};
     for (size_t genIndex{0}; genIndex < event.NJETSMAX; ++genIndex)
     {
-        const double dR{deltaR(event.genJetPF2PATEta[genIndex], event.genJetPF2PATPhi[genIndex], event.jetPF2PATEta[index], event.jetPF2PATPhi[index])};
         const double dPt{event.jetPF2PATPtRaw[index] - event.genJetPF2PATPT[genIndex]};
 
-        if (event.genJetPF2PATPT[genIndex] > 0 && dR < (0.4 / 2.0)
+        if (event.genJetPF2PATPT[genIndex] > 0 && genDeltaR2[genIndex] < (0.4 / 2.0) * (0.4 / 2.0)
                 && std::abs(dPt) < 3.0 * ptRes * event.jetPF2PATPtRaw[index])
         {
             matchingGenIndex = genIndex;
@@ -0,0 +1,76 @@
+#include "cutFlow.hpp"
+
+#include "TH1D.h"
+
+#include <array>
+#include <ostream>
+#include <stdexcept>
+
+CutFlow::CutFlow(std::vector<std::string> stageNames)
+{
+    stages_.reserve(stageNames.size());
+    for (auto& name : stageNames)
+    {
+        stages_.push_back({std::move(name), 0., 0., 0, 0});
+    }
+}
+
+void CutFlow::addTo(TH1D& hist) const
+{
+    if (hist.GetNbinsX() != static_cast<int>(stages_.size()))
+    {
+        throw std::logic_error(std::string{"Cut flow histogram "} + hist.GetName() + " doesn't have one bin per stage");
+    }
+
+    // As HistogramAccumulator::addTo
+    std::array<double, 13> stats{};
+    hist.GetStats(stats.data());
+    double entries{hist.GetEntries()};
+
+    if (hist.GetSumw2N() == 0)
+    {
+        hist.Sumw2();
+    }
+    double* contents{hist.GetArray()};
+    double* sumW2{hist.GetSumw2()->GetArray()};
+    for (size_t i{0}; i < stages_.size(); i++)
+    {
+        const Stage& stage{stages_[i]};
+        const double x{hist.GetXaxis()->GetBinCenter(static_cast<int>(i) + 1)};
+        contents[i + 1] += stage.sumW;
+        sumW2[i + 1] += stage.sumW2;
+        stats[0] += stage.sumW;
+        stats[1] += stage.sumW2;
+        stats[2] += stage.sumW * x;
+        stats[3] += stage.sumW * x * x;
+        entries += static_cast<double>(stage.count);
+    }
+    hist.PutStats(stats.data());
+    hist.SetEntries(entries);
+}
+
+void CutFlow::reset()
+{
+    for (auto& stage : stages_)
+    {
+        stage.sumW = 0.;
+        stage.sumW2 = 0.;
+        stage.count = 0;
+        stage.nanoseconds = 0;
+    }
+}
+
+void CutFlow::writeTableHeader(std::ostream& os, const std::string& prefix)
+{
+    os << prefix << "\tstageIndex\tstage\tsumWeights\tsumWeights2\tevents\tseconds\n";
+}
+
+void CutFlow::writeTable(std::ostream& os, const std::string& prefix) const
+{
+    for (size_t i{0}; i < stages_.size(); i++)
+    {
+        const Stage& stage{stages_[i]};
+        os << prefix << '\t' << i << '\t' << stage.name << '\t' << stage.sumW << '\t' << stage.sumW2 << '\t'
+           << stage.count << '\t' << 1e-9 * static_cast<double>(stage.nanoseconds) << '\n';
+    }
+}
@@ -0,0 +1,148 @@
+#include "cutPipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+CutPipeline::CutPipeline()
+    : reorder_{false}
+    , reorderInterval_{1000}
+    , eventsSinceReorder_{0}
+{}
+
+void CutPipeline::addStage(
+    const std::string& name,
+    std::function<bool(AnalysisEvent&, double&, const int)> cut,
+    const bool commutative)
+{
+    stages_.push_back(CutStage{name, cut, commutative, 0, 0, 0., 0., 0});
+    order_.emplace_back(stages_.size() - 1);
+}
+
+void CutPipeline::clear()
+{
+    stages_.clear();
+    order_.clear();
+    eventsSinceReorder_ = 0;
+}
+
+bool CutPipeline::run(AnalysisEvent& event,
+                      double& eventWeight,
+                      const int syst)
+{
+    if (reorder_ && ++eventsSinceReorder_ >= reorderInterval_)
+    {
+        reorderStages();
+        eventsSinceReorder_ = 0;
+    }
+
+    for (const auto stageIndex : order_)
+    {
+        CutStage& stage{stages_[stageIndex]};
+        stage.eventsIn++;
+        stage.sumWeightsIn += eventWeight;
+
+        const auto start{std::chrono::steady_clock::now()};
+        const bool passed{stage.cut(event, eventWeight, syst)};
+        stage.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+
+        if (!passed)
+        {
+            return false;
+        }
+        stage.eventsPassed++;
+        stage.sumWeightsPassed += eventWeight;
+    }
+    return true;
+}
+
+// Within each run of adjacent commutative stages, run first those which
+// reject the most events per nanosecond spent. Raw counts are used for the
+// rejection rate as MC weights can be negative.
+void CutPipeline::reorderStages()
+{
+    const auto score{[this](const size_t index) {
+        const CutStage& stage{stages_[index]};
+        if (stage.eventsIn == 0)
+        {
+            return 0.;
+        }
+        const double in{static_cast<double>(stage.eventsIn)};
+        const double rejection{1. - static_cast<double>(stage.eventsPassed) / in};
+        const double cost{static_cast<double>(stage.nanoseconds) / in};
+        return rejection / (cost + 1.);
+    }};
+
+    auto runStart{order_.begin()};
+    while (runStart != order_.end())
+    {
+        if (!stages_[*runStart].commutative)
+        {
+            ++runStart;
+            continue;
+        }
+        auto runEnd{runStart};
+        while (runEnd != order_.end() && stages_[*runEnd].commutative)
+        {
+            ++runEnd;
+        }
+        std::stable_sort(runStart, runEnd, [&score](const size_t a, const size_t b) {
+            return score(a) > score(b);
+        });
+        runStart = runEnd;
+    }
+}
+
+void CutPipeline::reset()
+{
+    for (auto& stage : stages_)
+    {
+        stage.eventsIn = 0;
+        stage.eventsPassed = 0;
+        stage.sumWeightsIn = 0.;
+        stage.sumWeightsPassed = 0.;
+        stage.nanoseconds = 0;
+    }
+    for (size_t i{0}; i < order_.size(); i++)
+    {
+        order_[i] = i;
+    }
+    eventsSinceReorder_ = 0;
+}
+
+std::vector<std::string> CutPipeline::stageOrder() const
+{
+    std::vector<std::string> names;
+    for (const auto stageIndex : order_)
+    {
+        names.emplace_back(stages_[stageIndex].name);
+    }
+    return names;
+}
+
+void CutPipeline::printSummary(std::ostream& os) const
+{
+    os << "Cut pipeline summary (declared order):\n";
+    os << std::setw(16) << "stage" << std::setw(12) << "in"
+       << std::setw(12) << "passed" << std::setw(16) << "sumW passed"
+       << std::setw(12) << "ns/event" << '\n';
+    for (const auto& stage : stages_)
+    {
+        const double nsPerEvent{
+            stage.eventsIn ? static_cast<double>(stage.nanoseconds)
+                                 / static_cast<double>(stage.eventsIn)
+                           : 0.};
+        os << std::setw(16) << stage.name << std::setw(12) << stage.eventsIn
+           << std::setw(12) << stage.eventsPassed << std::setw(16)
+           << stage.sumWeightsPassed << std::setw(12) << nsPerEvent << '\n';
+    }
+    os << "Execution order:";
+    for (const auto& name : stageOrder())
+    {
+        os << ' ' << name;
+    }
+    os << std::endl;
+}
@@ -0,0 +1,389 @@
+#include "cutScan.hpp"
+
+#include "AnalysisEvent.hpp"
+#include "deltaRKernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+const std::array<std::string, CutScan::NumAxes> axisNames{{"muonPtLeading",
+                                                           "muonPt",
+                                                           "maxDileptonDeltaR",
+                                                           "maxChsDeltaR",
+                                                           "scalarMass",
+                                                           "higgsMass"}};
+const std::array<std::string, CutScan::NumStages> stageNames{
+    {"lepSel", "zMass", "trackSel", "higgsSel"}};
+
+// As in the dileptonDeltaR and chsDeltaR stages of the nominal selection
+constexpr double minPairDeltaR{0.3};
+constexpr double higgsMass{125.2};
+
+// Returns the index of the candidate, adding it if it isn't there yet
+template <typename T>
+int addCandidate(std::vector<T>& candidates, const T& candidate)
+{
+    for (size_t i{0}; i < candidates.size(); i++)
+    {
+        if (candidates[i].firstIndex == candidate.firstIndex
+            && candidates[i].secondIndex == candidate.secondIndex)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    candidates.emplace_back(candidate);
+    return static_cast<int>(candidates.size() - 1);
+}
+} // namespace
+
+CutScan::CutScan()
+    : axesGiven_{0}
+    , is2016_{false}
+    , minMuons_{2}
+{}
+
+void CutScan::parse_config(const YAML::Node& scan)
+{
+    for (const auto& entry : scan)
+    {
+        const std::string name{entry.first.as<std::string>()};
+        const auto axis{std::find(axisNames.begin(), axisNames.end(), name)};
+        if (axis == axisNames.end())
+        {
+            throw std::runtime_error("Unknown cut scan axis: " + name);
+        }
+
+        auto& values{axes_[static_cast<size_t>(axis - axisNames.begin())]};
+        values = entry.second.as<std::vector<double>>();
+        if (values.empty())
+        {
+            throw std::runtime_error("Cut scan axis " + name
+                                     + " has no working points");
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        axesGiven_++;
+    }
+}
+
+void CutScan::setNominal(const Axis axis, const double value)
+{
+    if (axes_[axis].empty())
+    {
+        axes_[axis] = {value};
+    }
+}
+
+void CutScan::setMuonSelection(const bool is2016, const unsigned minMuons)
+{
+    // The muons of each point are found by tightening the pT cuts on the
+    // muons selected at the loosest point, which is only the same as
+    // selecting them from scratch if no leading threshold is below the
+    // loosest subleading threshold.
+    if (axes_[MuonPtLeading].front() < axes_[MuonPt].front())
+    {
+        throw std::runtime_error(
+            "Cut scan muonPtLeading values must not be below the lowest "
+            "muonPt value");
+    }
+    is2016_ = is2016;
+    minMuons_ = minMuons;
+    reset();
+}
+
+double CutScan::loosest(const Axis axis) const
+{
+    // pT cuts are lower bounds, everything else is an upper bound
+    return axis == MuonPtLeading || axis == MuonPt ? axes_[axis].front()
+                                                   : axes_[axis].back();
+}
+
+size_t CutScan::size() const
+{
+    size_t points{1};
+    for (const auto& axis : axes_)
+    {
+        points *= axis.size();
+    }
+    return points;
+}
+
+void CutScan::reset()
+{
+    sumWeights_.assign(size() * NumStages, 0.);
+    sumWeights2_.assign(size() * NumStages, 0.);
+    events_.assign(size() * NumStages, 0);
+}
+
+// Mirrors Cuts::getLooseMuons and Cuts::getDileptonCand. For each threshold
+// the candidate is the first opposite sign pair closer than it, which is
+// always a pair closer than all the pairs before it, so only those need to
+// be kept while looping over the pairs once.
+void CutScan::findDileptons(const AnalysisEvent& event)
+{
+    const auto& maxDeltaRs{axes_[MaxDileptonDeltaR]};
+    dileptons_.clear();
+    dileptonChoice_.clear();
+
+    std::vector<Candidate> closest;
+    for (const double ptLeading : axes_[MuonPtLeading])
+    {
+        for (const double pt : axes_[MuonPt])
+        {
+            muons_.clear();
+            for (const int muon : event.muonIndexTight)
+            {
+                const double threshold{muons_.empty() ? ptLeading : pt};
+                if (is2016_ ? event.muonPF2PATPt[muon] > threshold
+                            : event.muonPF2PATPt[muon] >= threshold)
+                {
+                    muons_.emplace_back(muon);
+                }
+            }
+
+            closest.clear();
+            if (muons_.size() >= minMuons_)
+            {
+                double minDeltaR{maxDeltaRs.back()};
+                for (size_t i{0}; i < muons_.size() && minDeltaR >= maxDeltaRs.front(); i++)
+                {
+                    for (size_t j{i + 1}; j < muons_.size(); j++)
+                    {
+                        const int muon1{muons_[i]};
+                        const int muon2{muons_[j]};
+                        if (event.muonPF2PATCharge[muon1] * event.muonPF2PATCharge[muon2] >= 0)
+                        {
+                            continue;
+                        }
+
+                        const TLorentzVector lepton1{event.muonPF2PATPX[muon1], event.muonPF2PATPY[muon1], event.muonPF2PATPZ[muon1], event.muonPF2PATE[muon1]};
+                        const TLorentzVector lepton2{event.muonPF2PATPX[muon2], event.muonPF2PATPY[muon2], event.muonPF2PATPZ[muon2], event.muonPF2PATE[muon2]};
+                        const double deltaR{lepton1.DeltaR(lepton2)};
+                        if (!(deltaR < minDeltaR))
+                        {
+                            continue;
+                        }
+
+                        const bool ordered{lepton1.Pt() > lepton2.Pt()};
+                        Candidate candidate{ordered ? lepton1 : lepton2, ordered ? lepton2 : lepton1, ordered ? muon1 : muon2, ordered ? muon2 : muon1, 0., deltaR};
+                        candidate.mass = (candidate.first + candidate.second).M();
+                        closest.emplace_back(candidate);
+                        minDeltaR = deltaR;
+                        if (minDeltaR < maxDeltaRs.front())
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            for (const double maxDeltaR : maxDeltaRs)
+            {
+                const auto found{std::find_if(closest.begin(), closest.end(), [maxDeltaR](const Candidate& candidate) {
+                    return candidate.deltaR < maxDeltaR;
+                })};
+                dileptonChoice_.emplace_back(found == closest.end() ? -1 : addCandidate(dileptons_, *found));
+            }
+        }
+    }
+}
+
+// Mirrors Cuts::getDihadronCand for a given dilepton candidate
+void CutScan::findDihadrons(const AnalysisEvent& event, const size_t dilepton)
+{
+    const auto& maxDeltaRs{axes_[MaxChsDeltaR]};
+    const auto& chs{event.chsIndex};
+    const int muonCand1{event.muonPF2PATPackedCandIndex[dileptons_[dilepton].firstIndex]};
+    const int muonCand2{event.muonPF2PATPackedCandIndex[dileptons_[dilepton].secondIndex]};
+
+    // Candidates are found with the ΔR² of the kernel, as in the nominal
+    // selection
+    std::vector<Candidate> closest;
+    std::vector<double> closestDeltaR2;
+    double minDeltaR2{maxDeltaRs.back() * maxDeltaRs.back()};
+    const double minMaxDeltaR2{maxDeltaRs.front() * maxDeltaRs.front()};
+    for (size_t i{0}; i < chs.size() && minDeltaR2 >= minMaxDeltaR2; i++)
+    {
+        if (event.packedCandsMuonIndex[chs[i]] == muonCand1 || event.packedCandsMuonIndex[chs[i]] == muonCand2)
+        {
+            continue;
+        }
+
+        DeltaR::deltaR2Row(chsEta_.data() + i + 1, chsPhi_.data() + i + 1, chs.size() - i - 1, chsEta_[i], chsPhi_[i], chsDeltaR2_.data() + i + 1);
+
+        for (size_t j{i + 1}; j < chs.size(); j++)
+        {
+            if (event.packedCandsMuonIndex[chs[j]] == muonCand1 || event.packedCandsMuonIndex[chs[j]] == muonCand2)
+            {
+                continue;
+            }
+            if (std::abs(event.packedCandsPdgId[chs[i]]) != 211 || std::abs(event.packedCandsPdgId[chs[j]]) != 211)
+            {
+                continue;
+            }
+            if (event.packedCandsCharge[chs[i]] * event.packedCandsCharge[chs[j]] >= 0)
+            {
+                continue;
+            }
+            if (!(chsDeltaR2_[j] < minDeltaR2))
+            {
+                continue;
+            }
+
+            const TLorentzVector& chs1{chsVecs_[i]};
+            const TLorentzVector& chs2{chsVecs_[j]};
+            const bool ordered{chs1.Pt() > chs2.Pt()};
+            Candidate candidate{ordered ? chs1 : chs2, ordered ? chs2 : chs1, ordered ? chs[i] : chs[j], ordered ? chs[j] : chs[i], 0., chs1.DeltaR(chs2)};
+            candidate.mass = (candidate.first + candidate.second).M();
+            closest.emplace_back(candidate);
+            closestDeltaR2.emplace_back(chsDeltaR2_[j]);
+            minDeltaR2 = chsDeltaR2_[j];
+            if (minDeltaR2 < minMaxDeltaR2)
+            {
+                break;
+            }
+        }
+    }
+
+    for (size_t k{0}; k < maxDeltaRs.size(); k++)
+    {
+        const double maxDeltaR2{maxDeltaRs[k] * maxDeltaRs[k]};
+        const auto found{std::find_if(closestDeltaR2.begin(), closestDeltaR2.end(), [maxDeltaR2](const double deltaR2) {
+            return deltaR2 < maxDeltaR2;
+        })};
+        dihadronChoice_[dilepton * maxDeltaRs.size() + k] = found == closestDeltaR2.end() ? -1 : addCandidate(dihadrons_, closest[static_cast<size_t>(found - closestDeltaR2.begin())]);
+    }
+}
+
+void CutScan::fill(const AnalysisEvent& event, const double eventWeight)
+{
+    const size_t nChsDeltaR{axes_[MaxChsDeltaR].size()};
+
+    findDileptons(event);
+
+    // Tracks and their directions are shared by all dilepton candidates
+    chsVecs_.clear();
+    chsEta_.clear();
+    chsPhi_.clear();
+    for (const int cand : event.chsIndex)
+    {
+        chsVecs_.emplace_back(event.packedCandsPx[cand], event.packedCandsPy[cand], event.packedCandsPz[cand], event.packedCandsE[cand]);
+        chsEta_.emplace_back(chsVecs_.back().Eta());
+        chsPhi_.emplace_back(chsVecs_.back().Phi());
+    }
+    chsDeltaR2_.resize(event.chsIndex.size());
+
+    dihadrons_.clear();
+    dihadronChoice_.assign(dileptons_.size() * nChsDeltaR, -1);
+    for (size_t dilepton{0}; dilepton < dileptons_.size(); dilepton++)
+    {
+        findDihadrons(event, dilepton);
+    }
+
+    // Loop over the grid in the order of the axes, evaluating each cached
+    // quantity at the outermost loop it depends on.
+    size_t point{0};
+    for (const int dilepton : dileptonChoice_)
+    {
+        for (size_t chsDeltaR{0}; chsDeltaR < nChsDeltaR; chsDeltaR++)
+        {
+            const int dihadron{dilepton < 0 ? -1 : dihadronChoice_[static_cast<size_t>(dilepton) * nChsDeltaR + chsDeltaR]};
+
+            double fourBodyMass{0.};
+            bool passDeltaR{false};
+            if (dihadron >= 0)
+            {
+                const Candidate& leptons{dileptons_[static_cast<size_t>(dilepton)]};
+                const Candidate& hadrons{dihadrons_[static_cast<size_t>(dihadron)]};
+                fourBodyMass = (leptons.first + leptons.second + hadrons.first + hadrons.second).M();
+                passDeltaR = !(leptons.deltaR < minPairDeltaR) && !(hadrons.deltaR < minPairDeltaR);
+            }
+
+            for (const double scalarMassCut : axes_[ScalarMass])
+            {
+                for (const double higgsMassCut : axes_[HiggsMass])
+                {
+                    size_t stagesPassed{0};
+                    if (dilepton >= 0)
+                    {
+                        stagesPassed = 1;
+                        if (!(dileptons_[static_cast<size_t>(dilepton)].mass > scalarMassCut))
+                        {
+                            stagesPassed = 2;
+                            if (dihadron >= 0 && !(dihadrons_[static_cast<size_t>(dihadron)].mass > scalarMassCut))
+                            {
+                                stagesPassed = 3;
+                                if (passDeltaR && !(fourBodyMass - higgsMass > higgsMassCut))
+                                {
+                                    stagesPassed = 4;
+                                }
+                            }
+                        }
+                    }
+
+                    for (size_t stage{0}; stage < stagesPassed; stage++)
+                    {
+                        const size_t index{point * NumStages + stage};
+                        sumWeights_[index] += eventWeight;
+                        sumWeights2_[index] += eventWeight * eventWeight;
+                        events_[index]++;
+                    }
+                    point++;
+                }
+            }
+        }
+    }
+}
+
+void CutScan::write(const std::string& fileName) const
+{
+    std::ofstream out{fileName};
+    if (!out.is_open())
+    {
+        throw std::runtime_error("Unable to open cut scan output file "
+                                 + fileName);
+    }
+
+    out << '#';
+    for (const auto& name : axisNames)
+    {
+        out << ' ' << name;
+    }
+    for (const auto& name : stageNames)
+    {
+        out << ' ' << name << ' ' << name << "Err " << name << "Events";
+    }
+    out << '\n' << std::setprecision(8);
+
+    for (size_t point{0}; point < size(); point++)
+    {
+        // Decode the point index, last axis fastest
+        std::array<double, NumAxes> values;
+        size_t remainder{point};
+        for (size_t axis{NumAxes}; axis-- > 0;)
+        {
+            values[axis] = axes_[axis][remainder % axes_[axis].size()];
+            remainder /= axes_[axis].size();
+        }
+        for (size_t axis{0}; axis < NumAxes; axis++)
+        {
+            out << (axis ? " " : "") << values[axis];
+        }
+        for (size_t stage{0}; stage < NumStages; stage++)
+        {
+            const size_t index{point * NumStages + stage};
+            out << ' ' << sumWeights_[index] << ' '
+                << std::sqrt(sumWeights2_[index]) << ' ' << events_[index];
+        }
+        out << '\n';
+    }
+
+    std::cout << "Wrote cut scan of " << size() << " working points to "
+              << fileName << std::endl;
+}
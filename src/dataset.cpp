@@ -1,18 +1,142 @@
 #include "dataset.hpp"
 
+#include "datasetCatalog.hpp"
+#include "fingerprint.hpp"
+#include "provenance.hpp"
+
 #include "TChain.h"
 #include "TColor.h"
 #include "TFile.h"
 #include "TH1.h"
+#include "TROOT.h"
 
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <regex>
+#include <stdexcept>
+#include <thread>
 
 namespace fs = boost::filesystem;
 
+std::string Dataset::cacheDir_;
+
+namespace {
+const std::string weightHistoName{"makeTopologyNtupleMiniAOD/weightHisto"};
+// Reading is mostly waiting for the storage, which gains little from more
+constexpr unsigned maxWeightWorkers{8};
+
+// ROOT files of a location, in directory order as they have always been
+// summed
+std::vector<std::string> rootFiles(const std::string& location) {
+    const std::regex mask{R"(\.root$)"};
+    std::vector<std::string> files;
+    for (const auto& file : boost::make_iterator_range(fs::directory_iterator{location}, {})) {
+        const std::string path{file.path().string()};
+        if (fs::is_regular_file(file.status()) && std::regex_search(path, mask))
+            files.push_back(path);
+    }
+    return files;
+}
+
+// The generator weight histogram of a file, detached from it so that the
+// file is closed on return
+std::unique_ptr<TH1I> readWeightHisto(const std::string& path) {
+    std::unique_ptr<TFile> file{TFile::Open(path.c_str(), "READ")};
+    if (!file || file->IsZombie())
+        throw std::runtime_error("Couldn't open " + path + " for its generator weights");
+    TH1I* histo{nullptr};
+    file->GetObject(weightHistoName.c_str(), histo);
+    if (!histo)
+        throw std::runtime_error("No " + weightHistoName + " in " + path);
+    std::unique_ptr<TH1I> detached{dynamic_cast<TH1I*>(histo->Clone())};
+    detached->SetDirectory(nullptr);
+    return detached;
+}
+
+// Sum of the histograms of the files. They are read in parallel, but added
+// in the order of the files, as a serial loop would.
+std::unique_ptr<TH1I> sumWeightHistos(const std::vector<std::string>& files) {
+    std::vector<std::unique_ptr<TH1I>> histos(files.size());
+    std::vector<std::string> errors(files.size());
+    std::atomic<size_t> next{0};
+    const auto worker{[&]() {
+        for (size_t i{next++}; i < files.size(); i = next++) {
+            try {
+                histos[i] = readWeightHisto(files[i]);
+            }
+            catch (const std::exception& e) {
+                errors[i] = e.what();
+            }
+        }
+    }};
+
+    ROOT::EnableThreadSafety();
+    std::vector<std::thread> threads;
+    const unsigned workers{std::min({maxWeightWorkers, std::max(1u, std::thread::hardware_concurrency()), static_cast<unsigned>(files.size())})};
+    for (unsigned i{0}; i < workers; i++)
+        threads.emplace_back(worker);
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& error : errors) {
+        if (!error.empty())
+            throw std::runtime_error(error);
+    }
+    std::unique_ptr<TH1I> sum{std::move(histos.front())};
+    for (size_t i{1}; i < histos.size(); i++)
+        sum->Add(histos[i].get());
+    return sum;
+}
+
+// Generator weight sum of a location, null if it has no files. With a cache
+// directory, the sum is kept there as <hash of the location>.weights.root,
+// and reused while the names, sizes and modification times of the files stay
+// the same.
+std::unique_ptr<TH1I> locationWeightHisto(const std::string& location, const std::string& cacheDir) {
+    const std::vector<std::string> files{rootFiles(location)};
+    if (files.empty())
+        return nullptr;
+    if (cacheDir.empty())
+        return sumWeightHistos(files);
+
+    Fingerprint name;
+    name.add(fs::canonical(location).string());
+    const std::string cacheFile{(fs::path{cacheDir} / (name.hex() + ".weights.root")).string()};
+    Fingerprint key;
+    key.add(weightHistoName);
+    Provenance::addInputs(key, {location});
+
+    if (Provenance::matches(cacheFile, key.hex())) {
+        TFile in{cacheFile.c_str(), "READ"};
+        TH1I* cached{nullptr};
+        in.GetObject("weightHisto", cached);
+        if (cached) {
+            std::unique_ptr<TH1I> detached{dynamic_cast<TH1I*>(cached->Clone())};
+            detached->SetDirectory(nullptr);
+            return detached;
+        }
+    }
+
+    std::unique_ptr<TH1I> sum{sumWeightHistos(files)};
+    // Written aside and renamed, as jobs may share the cache
+    fs::create_directories(cacheDir);
+    const fs::path tmpFile{fs::unique_path(cacheFile + ".%%%%-%%%%.tmp")};
+    {
+        TFile out{tmpFile.string().c_str(), "RECREATE"};
+        out.WriteObject(sum.get(), "weightHisto");
+        out.Close();
+    }
+    fs::rename(tmpFile, cacheFile);
+    Provenance::stamp(cacheFile, key.hex());
+    return sum;
+}
+} // namespace
+
 Dataset::Dataset(std::string name, float lumi, bool isMC, float crossSection, std::vector<std::string> locations, std::string histoName, std::string treeName, std::string colourHex, std::string plotLabel, std::string plotType, std::string triggerFlag) : colour_{TColor::GetColor(colourHex.c_str())} {
     name_ = name;
     lumi_ = lumi;
@@ -36,38 +160,31 @@ Dataset::Dataset(std::string name, float lumi, bool isMC, float crossSection, st
 
     // Read in generator level plots to determine event weights and total number of events
     if (isMC_) {
-        const std::regex mask{R"(\.root$)"};
-        bool firstFile{true};
         for (const auto& location : locations_) {
-            for (const auto& file : boost::make_iterator_range(fs::directory_iterator{location}, {})) {
-                const std::string path{file.path().string()};
-                if (!fs::is_regular_file(file.status()) || !std::regex_search(path, mask))
-                    continue;
-
-                TFile* tempFile{new TFile{path.c_str(), "READ"}};
-                if (firstFile) {
-                    generatorWeightPlot_ = dynamic_cast<TH1I*>((TH1I*)tempFile->Get("makeTopologyNtupleMiniAOD/weightHisto")->Clone());
-                    firstFile = false;
-                }
-                else {
-                    generatorWeightPlot_->Add((TH1I*)tempFile->Get("makeTopologyNtupleMiniAOD/weightHisto"));
-                    tempFile->Close();
-                    delete tempFile;
-                }
-            }
+            std::unique_ptr<TH1I> locationPlot{locationWeightHisto(location, cacheDir_)};
+            if (!locationPlot)
+                continue;
+            if (generatorWeightPlot_)
+                generatorWeightPlot_->Add(locationPlot.get());
+            else
+                generatorWeightPlot_ = locationPlot.release();
         }
+        if (!generatorWeightPlot_)
+            throw std::runtime_error("No files with generator weights for " + name_);
     }
 
-    totalEvents_ = generatorWeightPlot_->GetBinContent(1)+generatorWeightPlot_->GetBinContent(2);
+    totalEvents_ = generatorWeightPlot_ ? generatorWeightPlot_->GetBinContent(1)+generatorWeightPlot_->GetBinContent(2) : 0;
 }
 
 // Method that fills a TChain with the files that will be used for the analysis.
 // Returns 1 if succesful, otherwise returns 0. This can probably be largely
 // ignored.
-int Dataset::fillChain(TChain* chain) {
+int Dataset::fillChain(TChain* chain, const std::string& catalogDir) {
     for (const auto& location : locations_) {
         const fs::path dir{location};
-        if (fs::is_directory(dir))
+        if (fs::is_directory(dir) && !catalogDir.empty())
+            DatasetCatalog{location, treeName_, catalogDir}.fillChain(*chain);
+        else if (fs::is_directory(dir))
             chain->Add(TString{location + "*.root"});
         else {
             std::cout << "ERROR: " << location << "is not a valid directory" << std::endl;
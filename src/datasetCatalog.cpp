@@ -0,0 +1,246 @@
+#include "datasetCatalog.hpp"
+
+#include "fingerprint.hpp"
+
+#include "TChain.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+// The file is a magic line, the quoted tree name, then a line for each ROOT
+// file: its quoted path, size, modification time, checksum, entries, number
+// of clusters and their first entries.
+namespace
+{
+const std::string magic{"HToSS dataset catalog 1"};
+
+// Checksums of the files catalogued so far, by tree name and path
+std::mutex checksumsMutex;
+std::map<std::pair<std::string, std::string>, std::string> checksums;
+} // namespace
+
+DatasetCatalog::DatasetCatalog(const std::string& location, const std::string& treeName, const std::string& cacheDir)
+    : location_{location}
+    , treeName_{treeName}
+    , files_{}
+{
+    if (!fs::is_directory(location_))
+    {
+        throw std::runtime_error(location_ + " is not a directory");
+    }
+    fs::create_directories(cacheDir);
+    Fingerprint fingerprint;
+    fingerprint.add(fs::canonical(location_).string());
+    const std::string catalogFile{(fs::path{cacheDir} / (fingerprint.hex() + ".catalog")).string()};
+    read(catalogFile);
+
+    std::map<std::string, File> known;
+    for (auto& file : files_)
+    {
+        known.emplace(file.path, std::move(file));
+    }
+    files_.clear();
+
+    // Sorted as TChain::Add sorts a wildcard
+    std::vector<fs::path> paths;
+    for (const auto& entry : boost::make_iterator_range(fs::directory_iterator{location_}, {}))
+    {
+        if (fs::is_regular_file(entry.status()) && entry.path().extension() == ".root")
+        {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    unsigned scanned{0};
+    for (const auto& path : paths)
+    {
+        const unsigned long long size{fs::file_size(path)};
+        const std::time_t modified{fs::last_write_time(path)};
+        const auto found{known.find(path.string())};
+        if (found != known.end() && found->second.size == size && found->second.modified == modified)
+        {
+            files_.push_back(std::move(found->second));
+        }
+        else
+        {
+            files_.push_back(scan(path.string(), size, modified));
+            scanned++;
+        }
+    }
+
+    if (scanned > 0 || known.size() != files_.size())
+    {
+        std::cout << "Catalogued " << scanned << " new or changed of " << files_.size() << " files in " << location_
+                  << std::endl;
+        write(catalogFile);
+    }
+
+    const std::lock_guard<std::mutex> lock{checksumsMutex};
+    for (const auto& file : files_)
+    {
+        checksums[{treeName_, file.path}] = file.checksum;
+    }
+}
+
+DatasetCatalog::File
+    DatasetCatalog::scan(const std::string& path, const unsigned long long size, const std::time_t modified) const
+{
+    std::unique_ptr<TFile> inFile{TFile::Open(path.c_str(), "READ")};
+    if (!inFile || inFile->IsZombie())
+    {
+        throw std::runtime_error("Couldn't open " + path + " for the dataset catalog");
+    }
+    File file{path, size, modified, "", 0, {}};
+    TTree* tree{nullptr};
+    inFile->GetObject(treeName_.c_str(), tree);
+    if (!tree)
+    {
+        std::cerr << "No tree " << treeName_ << " in " << path << std::endl;
+        return file;
+    }
+
+    file.entries = tree->GetEntries();
+    Fingerprint fingerprint;
+    fingerprint.add(std::string{inFile->GetUUID().AsString()}).add(inFile->GetSize()).add(file.entries);
+    file.checksum = fingerprint.hex();
+    auto clusters{tree->GetClusterIterator(0)};
+    for (long long first{clusters.Next()}; first < file.entries; first = clusters.Next())
+    {
+        file.clusters.push_back(first);
+    }
+    return file;
+}
+
+void DatasetCatalog::read(const std::string& file)
+{
+    std::ifstream in{file};
+    std::string header;
+    std::string treeName;
+    if (!std::getline(in, header) || header != magic || !(in >> std::quoted(treeName)) || treeName != treeName_)
+    {
+        return;
+    }
+
+    File entry;
+    size_t numClusters{0};
+    while (in >> std::quoted(entry.path) >> entry.size >> entry.modified >> entry.checksum >> entry.entries
+           >> numClusters)
+    {
+        entry.clusters.resize(numClusters);
+        for (auto& cluster : entry.clusters)
+        {
+            in >> cluster;
+        }
+        if (!in)
+        {
+            break;
+        }
+        if (entry.checksum == "-")
+        {
+            entry.checksum.clear();
+        }
+        files_.push_back(entry);
+    }
+    if (!in.eof())
+    {
+        // A damaged catalog is made again
+        std::cerr << "Dataset catalog " << file << " is corrupt, remaking it" << std::endl;
+        files_.clear();
+    }
+}
+
+void DatasetCatalog::write(const std::string& file) const
+{
+    // Written aside and renamed, so that concurrent jobs never read half a
+    // catalog
+    const fs::path tmpFile{fs::unique_path(file + ".%%%%-%%%%.tmp")};
+    {
+        std::ofstream out{tmpFile.string(), std::ios::trunc};
+        out << magic << '\n' << std::quoted(treeName_) << '\n';
+        for (const auto& entry : files_)
+        {
+            // A file without the tree has no checksum
+            out << std::quoted(entry.path) << ' ' << entry.size << ' ' << entry.modified << ' '
+                << (entry.checksum.empty() ? "-" : entry.checksum) << ' ' << entry.entries << ' '
+                << entry.clusters.size();
+            for (const long long cluster : entry.clusters)
+            {
+                out << ' ' << cluster;
+            }
+            out << '\n';
+        }
+        if (!out.flush())
+        {
+            throw std::runtime_error("Couldn't write dataset catalog " + file);
+        }
+    }
+    fs::rename(tmpFile, file);
+}
+
+void DatasetCatalog::fillChain(TChain& chain) const
+{
+    for (const auto& file : files_)
+    {
+        // Files without entries are left for the chain to look at, as with a
+        // wildcard
+        chain.Add(file.path.c_str(), file.entries > 0 ? file.entries : TTree::kMaxEntries);
+    }
+}
+
+long long DatasetCatalog::entries() const
+{
+    long long entries{0};
+    for (const auto& file : files_)
+    {
+        entries += file.entries;
+    }
+    return entries;
+}
+
+std::string DatasetCatalog::checksum(const std::string& path, const std::string& treeName)
+{
+    const std::lock_guard<std::mutex> lock{checksumsMutex};
+    const auto found{checksums.find({treeName, path})};
+    return found == checksums.end() ? "" : found->second;
+}
+
+std::vector<std::pair<long long, long long>> DatasetCatalog::partition(const unsigned parts) const
+{
+    std::vector<std::pair<long long, long long>> ranges;
+    const long long total{entries()};
+    if (total == 0 || parts == 0)
+    {
+        return ranges;
+    }
+    const long long target{(total + parts - 1) / parts};
+    long long first{0};
+    long long offset{0};
+    for (const auto& file : files_)
+    {
+        for (const long long cluster : file.clusters)
+        {
+            if (offset + cluster - first >= target)
+            {
+                ranges.emplace_back(first, offset + cluster);
+                first = offset + cluster;
+            }
+        }
+        offset += file.entries;
+    }
+    ranges.emplace_back(first, total);
+    return ranges;
+}
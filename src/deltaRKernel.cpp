@@ -0,0 +1,123 @@
+#include "deltaRKernel.hpp"
+
+#include <limits>
+
+// Built with -ftree-vectorize, see the makefile. The loops over the second
+// index are kept free of branches and early exits so that they vectorise.
+namespace
+{
+template <typename T>
+void deltaR2RowImpl(const T* __restrict eta, const T* __restrict phi, const size_t n, const T eta0, const T phi0, T* __restrict out)
+{
+    for (size_t i{0}; i < n; i++)
+    {
+        out[i] = DeltaR::deltaR2(eta[i], phi[i], eta0, phi0);
+    }
+}
+
+template <typename T>
+void minDeltaR2Impl(const T* __restrict eta1, const T* __restrict phi1, const size_t n1, const T* __restrict eta2, const T* __restrict phi2, const size_t n2, T* __restrict out)
+{
+    for (size_t i{0}; i < n1; i++)
+    {
+        out[i] = std::numeric_limits<T>::infinity();
+    }
+    // Loop over the (usually small) second collection outside, so the inner
+    // loop runs over the first
+    for (size_t j{0}; j < n2; j++)
+    {
+        const T eta0{eta2[j]};
+        const T phi0{phi2[j]};
+        for (size_t i{0}; i < n1; i++)
+        {
+            const T dR2{DeltaR::deltaR2(eta1[i], phi1[i], eta0, phi0)};
+            out[i] = dR2 < out[i] ? dR2 : out[i];
+        }
+    }
+}
+
+template <typename T>
+int bestMatchImpl(const T* eta, const T* phi, const size_t n, const T eta0, const T phi0, const T maxDeltaR)
+{
+    int best{-1};
+    T bestDeltaR2{maxDeltaR * maxDeltaR};
+    for (size_t i{0}; i < n; i++)
+    {
+        const T dR2{DeltaR::deltaR2(eta[i], phi[i], eta0, phi0)};
+        if (dR2 < bestDeltaR2)
+        {
+            bestDeltaR2 = dR2;
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+template <typename T>
+size_t countWithinImpl(const T* __restrict eta, const T* __restrict phi, const size_t n, const T eta0, const T phi0, const T cone)
+{
+    const T cone2{cone * cone};
+    size_t count{0};
+    for (size_t i{0}; i < n; i++)
+    {
+        count += DeltaR::deltaR2(eta[i], phi[i], eta0, phi0) < cone2;
+    }
+    return count;
+}
+} // namespace
+
+void DeltaR::deltaR2Row(const float* eta, const float* phi, const size_t n, const float eta0, const float phi0, float* out)
+{
+    deltaR2RowImpl(eta, phi, n, eta0, phi0, out);
+}
+
+void DeltaR::deltaR2Row(const double* eta, const double* phi, const size_t n, const double eta0, const double phi0, double* out)
+{
+    deltaR2RowImpl(eta, phi, n, eta0, phi0, out);
+}
+
+void DeltaR::deltaR2Matrix(const float* eta1, const float* phi1, const size_t n1, const float* eta2, const float* phi2, const size_t n2, float* out)
+{
+    for (size_t i{0}; i < n1; i++)
+    {
+        deltaR2RowImpl(eta2, phi2, n2, eta1[i], phi1[i], out + i * n2);
+    }
+}
+
+void DeltaR::deltaR2Matrix(const double* eta1, const double* phi1, const size_t n1, const double* eta2, const double* phi2, const size_t n2, double* out)
+{
+    for (size_t i{0}; i < n1; i++)
+    {
+        deltaR2RowImpl(eta2, phi2, n2, eta1[i], phi1[i], out + i * n2);
+    }
+}
+
+void DeltaR::minDeltaR2(const float* eta1, const float* phi1, const size_t n1, const float* eta2, const float* phi2, const size_t n2, float* out)
+{
+    minDeltaR2Impl(eta1, phi1, n1, eta2, phi2, n2, out);
+}
+
+void DeltaR::minDeltaR2(const double* eta1, const double* phi1, const size_t n1, const double* eta2, const double* phi2, const size_t n2, double* out)
+{
+    minDeltaR2Impl(eta1, phi1, n1, eta2, phi2, n2, out);
+}
+
+int DeltaR::bestMatch(const float* eta, const float* phi, const size_t n, const float eta0, const float phi0, const float maxDeltaR)
+{
+    return bestMatchImpl(eta, phi, n, eta0, phi0, maxDeltaR);
+}
+
+int DeltaR::bestMatch(const double* eta, const double* phi, const size_t n, const double eta0, const double phi0, const double maxDeltaR)
+{
+    return bestMatchImpl(eta, phi, n, eta0, phi0, maxDeltaR);
+}
+
+size_t DeltaR::countWithin(const float* eta, const float* phi, const size_t n, const float eta0, const float phi0, const float cone)
+{
+    return countWithinImpl(eta, phi, n, eta0, phi0, cone);
+}
+
+size_t DeltaR::countWithin(const double* eta, const double* phi, const size_t n, const double eta0, const double phi0, const double cone)
+{
+    return countWithinImpl(eta, phi, n, eta0, phi0, cone);
+}
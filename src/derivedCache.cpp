@@ -0,0 +1,48 @@
+#include "derivedCache.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+void DerivedCache::newEvent()
+{
+    for (const unsigned id : valid_)
+    {
+        entries_[id].valid = false;
+    }
+    valid_.clear();
+    events_++;
+}
+
+void DerivedCache::invalidate(const unsigned dependencies)
+{
+    size_t kept{0};
+    for (const unsigned id : valid_)
+    {
+        if (entries_[id].dependencies & dependencies)
+        {
+            entries_[id].valid = false;
+        }
+        else
+        {
+            valid_[kept++] = id;
+        }
+    }
+    valid_.resize(kept);
+}
+
+void DerivedCache::printSummary(std::ostream& os) const
+{
+    if (events_ == 0 || computed_ + reused_ == 0)
+    {
+        return;
+    }
+    const double perEvent{1. / static_cast<double>(events_)};
+    os << "Plot variables per event: " << std::fixed << std::setprecision(1) << static_cast<double>(computed_) * perEvent << " computed, " << static_cast<double>(reused_) * perEvent << " reused from the cache" << std::defaultfloat << std::endl;
+}
+
+void DerivedCache::resetCounters()
+{
+    events_ = 0;
+    computed_ = 0;
+    reused_ = 0;
+}
@@ -0,0 +1,164 @@
+#include "derivedColumnStore.hpp"
+
+#include "AnalysisEvent.hpp"
+#include "entryList.hpp"
+#include "fingerprint.hpp"
+#include "pairVertex.hpp"
+#include "provenance.hpp"
+
+#include "TChain.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+// Bump when a column is added, removed or computed differently
+constexpr unsigned columnsVersion{1};
+const std::string treeName{"derivedColumns"};
+
+struct Column
+{
+    const char* name;
+    std::vector<float> PairVertices::*values;
+};
+const Column pairColumns[]{{"DistXY", &PairVertices::distXY},
+                           {"SigXY", &PairVertices::sigXY},
+                           {"DistXYZ", &PairVertices::distXYZ},
+                           {"SigXYZ", &PairVertices::sigXYZ},
+                           {"Chi2Ndof", &PairVertices::chi2Ndof},
+                           {"CosPointingXY", &PairVertices::cosPointingXY},
+                           {"CosPointingXYZ", &PairVertices::cosPointingXYZ}};
+
+// Branches of every column, bound to the pair vertices of an event
+std::vector<std::pair<std::string, std::vector<float>*>> columnAddresses(AnalysisEvent& event)
+{
+    std::vector<std::pair<std::string, std::vector<float>*>> addresses;
+    for (const auto& column : pairColumns)
+    {
+        addresses.emplace_back(std::string{"derivedChsTkPair"} + column.name, &(event.chsTkPairVertices.*column.values));
+        addresses.emplace_back(std::string{"derivedMuonTkPair"} + column.name, &(event.muonTkPairVertices.*column.values));
+    }
+    return addresses;
+}
+
+// Branches PairVertex::compute reads
+const char* const inputBranches[]{"numPVs", "pv*", "beamSpot*", "numChsTrackPairs", "chsTkPairTkV*", "numMuonTrackPairsPF2PAT", "muonTkPairPF2PATTkV*"};
+} // namespace
+
+DerivedColumnStore::DerivedColumnStore(const std::string& directory, const bool isMC, const bool is2016, const bool is2018)
+    : directory_{directory}
+    , isMC_{isMC}
+    , is2016_{is2016}
+    , is2018_{is2018}
+    , version_{}
+    , chain_{nullptr}
+    , friend_{nullptr}
+    , addresses_{}
+    , made_{0}
+{
+    boost::filesystem::create_directories(directory_);
+    Fingerprint fingerprint;
+    fingerprint.add("derivedColumns").add(Provenance::codeVersion()).add(columnsVersion);
+    fingerprint.add(isMC_).add(is2016_).add(is2018_);
+    version_ = fingerprint.hex();
+}
+
+DerivedColumnStore::~DerivedColumnStore()
+{
+    if (chain_)
+    {
+        chain_->RemoveFriend(friend_);
+    }
+    delete friend_;
+}
+
+void DerivedColumnStore::attach(TChain& chain, AnalysisEvent& event)
+{
+    if (friend_)
+    {
+        throw std::logic_error("Derived columns attached twice");
+    }
+    friend_ = new TChain{treeName.c_str()};
+    const TObjArray* elements{chain.GetListOfFiles()};
+    for (int i{0}; i < elements->GetEntriesFast(); i++)
+    {
+        // The title of a chain element is its file name
+        friend_->Add(columnsFile(elements->At(i)->GetTitle(), chain.GetName()).c_str());
+    }
+    if (made_ > 0)
+    {
+        std::cout << "Made the derived columns of " << made_ << " of " << elements->GetEntriesFast() << " files"
+                  << std::endl;
+    }
+
+    const auto addresses{columnAddresses(event)};
+    for (const auto& address : addresses)
+    {
+        addresses_.push_back(address.second);
+    }
+    for (size_t i{0}; i < addresses.size(); i++)
+    {
+        friend_->SetBranchAddress(addresses[i].first.c_str(), &addresses_[i]);
+    }
+    chain.AddFriend(friend_);
+    chain_ = &chain;
+}
+
+std::string DerivedColumnStore::columnsFile(const std::string& file, const std::string& inputTree)
+{
+    const std::string output{directory_ + "/" + EntryList::checksum(file, inputTree) + ".root"};
+    if (!Provenance::matches(output, version_))
+    {
+        produce(file, inputTree, output);
+        Provenance::stamp(output, version_);
+        made_++;
+    }
+    return output;
+}
+
+void DerivedColumnStore::produce(const std::string& file, const std::string& inputTree, const std::string& output) const
+{
+    TChain input{inputTree.c_str()};
+    input.Add(file.c_str());
+    AnalysisEvent event{isMC_, &input, is2016_, is2018_};
+    input.SetBranchStatus("*", false);
+    for (const char* const branch : inputBranches)
+    {
+        input.SetBranchStatus(branch, true);
+    }
+
+    // Written aside and renamed, so that an interrupted job leaves no file
+    // which looks complete
+    const std::string tmpFile{output + ".tmp"};
+    {
+        std::unique_ptr<TFile> outFile{TFile::Open(tmpFile.c_str(), "RECREATE")};
+        if (!outFile || outFile->IsZombie())
+        {
+            throw std::runtime_error("Couldn't open " + tmpFile + " for the derived columns");
+        }
+        TTree* tree{new TTree{treeName.c_str(), ("Derived columns of " + file).c_str()}};
+        tree->SetDirectory(outFile.get());
+        std::vector<std::pair<std::string, std::vector<float>*>> addresses{columnAddresses(event)};
+        for (auto& address : addresses)
+        {
+            tree->Branch(address.first.c_str(), &address.second);
+        }
+
+        const long long entries{input.GetEntries()};
+        for (long long entry{0}; entry < entries; entry++)
+        {
+            event.GetEntry(entry);
+            PairVertex::compute(event);
+            tree->Fill();
+        }
+        outFile->Write();
+        outFile->Close();
+    }
+    boost::filesystem::rename(tmpFile, output);
+}
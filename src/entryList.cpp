@@ -0,0 +1,243 @@
+#include "entryList.hpp"
+
+#include "datasetCatalog.hpp"
+#include "fingerprint.hpp"
+
+#include "TChain.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+// The file is a magic line, the number of files, then for each file its
+// checksum, tree entries and passing entries, the latter as the differences
+// between consecutive entries. Every number is a LEB128 varint, so that a
+// list costs a byte or two per passing entry.
+namespace
+{
+const std::string magic{"HToSS entry list 1\n"};
+
+void writeNumber(std::ostream& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+uint64_t readNumber(std::istream& in, const std::string& file)
+{
+    uint64_t value{0};
+    for (unsigned shift{0}; shift < 64; shift += 7)
+    {
+        const int byte{in.get()};
+        if (byte == std::char_traits<char>::eof())
+        {
+            throw std::runtime_error("Entry list " + file + " is truncated");
+        }
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return value;
+        }
+    }
+    throw std::runtime_error("Entry list " + file + " is corrupt");
+}
+} // namespace
+
+EntryList::EntryList(const std::string& file)
+{
+    std::ifstream in{file, std::ios::binary};
+    if (!in)
+    {
+        throw std::runtime_error("Couldn't open entry list " + file);
+    }
+    std::string header(magic.size(), '\0');
+    in.read(&header[0], static_cast<std::streamsize>(header.size()));
+    if (header != magic)
+    {
+        throw std::runtime_error(file + " is not an entry list");
+    }
+
+    const uint64_t numFiles{readNumber(in, file)};
+    for (uint64_t i{0}; i < numFiles; i++)
+    {
+        std::string checksum(16, '\0');
+        in.read(&checksum[0], static_cast<std::streamsize>(checksum.size()));
+        FileEntries& fileEntries{files_[checksum]};
+        fileEntries.treeEntries = static_cast<long long>(readNumber(in, file));
+        fileEntries.entries.resize(readNumber(in, file));
+        long long entry{0};
+        for (auto& passing : fileEntries.entries)
+        {
+            entry += static_cast<long long>(readNumber(in, file));
+            passing = entry;
+        }
+    }
+}
+
+std::string EntryList::checksum(const std::string& file, const std::string& treeName)
+{
+    const std::string catalogued{DatasetCatalog::checksum(file, treeName)};
+    if (!catalogued.empty())
+    {
+        return catalogued;
+    }
+    std::unique_ptr<TFile> inFile{TFile::Open(file.c_str(), "READ")};
+    if (!inFile || inFile->IsZombie())
+    {
+        throw std::runtime_error("Couldn't open " + file + " for its checksum");
+    }
+    TTree* tree{nullptr};
+    inFile->GetObject(treeName.c_str(), tree);
+    if (!tree)
+    {
+        throw std::runtime_error("No tree " + treeName + " in " + file);
+    }
+    // The UUID is made anew whenever a file is written, the rest guards
+    // against truncated copies
+    Fingerprint fingerprint;
+    fingerprint.add(std::string{inFile->GetUUID().AsString()}).add(inFile->GetSize()).add(tree->GetEntries());
+    return fingerprint.hex();
+}
+
+std::vector<EntryList::ChainFile> EntryList::chainFiles(TChain& chain)
+{
+    // Loads the offset of every file
+    chain.GetEntries();
+    const long long* offsets{chain.GetTreeOffset()};
+    const TObjArray* elements{chain.GetListOfFiles()};
+
+    std::vector<ChainFile> files;
+    for (int i{0}; i < chain.GetNtrees(); i++)
+    {
+        // The title of a chain element is its file name
+        files.push_back({checksum(elements->At(i)->GetTitle(), chain.GetName()), offsets[i], offsets[i + 1] - offsets[i]});
+    }
+    return files;
+}
+
+void EntryList::add(TChain& chain, const std::vector<long long>& entries)
+{
+    auto entry{entries.begin()};
+    for (const auto& file : chainFiles(chain))
+    {
+        FileEntries& fileEntries{files_[file.checksum]};
+        fileEntries.treeEntries = file.treeEntries;
+        fileEntries.entries.clear();
+        for (; entry != entries.end() && *entry < file.offset + file.treeEntries; ++entry)
+        {
+            fileEntries.entries.push_back(*entry - file.offset);
+        }
+    }
+    if (entry != entries.end())
+    {
+        throw std::logic_error("Entry list entries beyond the end of the chain");
+    }
+}
+
+std::vector<long long> EntryList::chainEntries(TChain& chain) const
+{
+    std::vector<long long> entries;
+    for (const auto& file : chainFiles(chain))
+    {
+        const auto fileEntries{files_.find(file.checksum)};
+        if (fileEntries == files_.end())
+        {
+            throw std::runtime_error(std::string{"A file of "} + chain.GetName()
+                                     + " isn't in the entry list, or has changed since it was made");
+        }
+        for (const long long entry : fileEntries->second.entries)
+        {
+            entries.push_back(file.offset + entry);
+        }
+    }
+    return entries;
+}
+
+EntryList& EntryList::intersect(const EntryList& other)
+{
+    for (auto file{files_.begin()}; file != files_.end();)
+    {
+        const auto otherFile{other.files_.find(file->first)};
+        if (otherFile == other.files_.end())
+        {
+            file = files_.erase(file);
+            continue;
+        }
+        std::vector<long long> both;
+        std::set_intersection(file->second.entries.begin(),
+                              file->second.entries.end(),
+                              otherFile->second.entries.begin(),
+                              otherFile->second.entries.end(),
+                              std::back_inserter(both));
+        file->second.entries.swap(both);
+        ++file;
+    }
+    return *this;
+}
+
+EntryList& EntryList::unite(const EntryList& other)
+{
+    for (const auto& otherFile : other.files_)
+    {
+        FileEntries& fileEntries{files_[otherFile.first]};
+        fileEntries.treeEntries = otherFile.second.treeEntries;
+        std::vector<long long> either;
+        std::set_union(fileEntries.entries.begin(),
+                       fileEntries.entries.end(),
+                       otherFile.second.entries.begin(),
+                       otherFile.second.entries.end(),
+                       std::back_inserter(either));
+        fileEntries.entries.swap(either);
+    }
+    return *this;
+}
+
+void EntryList::write(const std::string& file) const
+{
+    // Written aside and renamed, so that an interrupted job leaves no list
+    // which looks complete
+    const std::string tmpFile{file + ".tmp"};
+    {
+        std::ofstream out{tmpFile, std::ios::binary | std::ios::trunc};
+        out << magic;
+        writeNumber(out, files_.size());
+        for (const auto& fileEntries : files_)
+        {
+            out.write(fileEntries.first.data(), static_cast<std::streamsize>(fileEntries.first.size()));
+            writeNumber(out, static_cast<uint64_t>(fileEntries.second.treeEntries));
+            writeNumber(out, fileEntries.second.entries.size());
+            long long previous{0};
+            for (const long long entry : fileEntries.second.entries)
+            {
+                writeNumber(out, static_cast<uint64_t>(entry - previous));
+                previous = entry;
+            }
+        }
+        if (!out.flush())
+        {
+            throw std::runtime_error("Couldn't write entry list " + file);
+        }
+    }
+    boost::filesystem::rename(tmpFile, file);
+}
+
+size_t EntryList::size() const
+{
+    size_t size{0};
+    for (const auto& fileEntries : files_)
+    {
+        size += fileEntries.second.entries.size();
+    }
+    return size;
+}
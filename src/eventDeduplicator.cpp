@@ -0,0 +1,274 @@
+#include "eventDeduplicator.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+constexpr size_t bloomBitsPerKey{10};
+constexpr size_t bloomBlockWords{8};
+constexpr unsigned bloomProbes{6};
+
+// Bit positions within a block of a hash
+template <typename Visit>
+void bloomBits(const uint64_t hash, Visit visit)
+{
+    const unsigned first{static_cast<unsigned>(hash & 0xffff)};
+    const unsigned step{static_cast<unsigned>((hash >> 16) & 0xffff) | 1};
+    for (unsigned i{0}; i < bloomProbes; i++)
+    {
+        const unsigned bit{(first + i * step) & 511};
+        visit(bit / 64, uint64_t{1} << (bit % 64));
+    }
+}
+
+void sortUnique(std::vector<uint64_t>& keys)
+{
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+// A new directory under the spill directory, so that files left by an
+// interrupted run, or another deduplicator spilling there, aren't read back
+std::string instanceSpillDir(const std::string& spillDir)
+{
+    if (spillDir.empty())
+    {
+        return "";
+    }
+    return (boost::filesystem::path{spillDir} / boost::filesystem::unique_path("dedup-%%%%-%%%%-%%%%-%%%%")).string();
+}
+} // namespace
+
+EventDeduplicator::EventDeduplicator(const size_t memoryBudget, const std::string& spillDir)
+    : memoryBudget_{memoryBudget}
+    , spillDir_{instanceSpillDir(spillDir)}
+    , frozen_{false}
+    , size_{0}
+    , mutex_{}
+    , runs_{}
+    , keysInMemory_{0}
+    , loadOrder_{}
+    , bloom_{}
+{
+    if (!spillDir_.empty())
+    {
+        boost::filesystem::create_directories(spillDir_);
+    }
+}
+
+EventDeduplicator::~EventDeduplicator()
+{
+    if (!spillDir_.empty())
+    {
+        boost::system::error_code error;
+        boost::filesystem::remove_all(spillDir_, error);
+    }
+}
+
+uint64_t EventDeduplicator::hash(const int32_t run, const uint64_t key)
+{
+    // splitmix64 finaliser
+    uint64_t x{key ^ (static_cast<uint64_t>(static_cast<uint32_t>(run)) * 0x9e3779b97f4a7c15ULL)};
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+void EventDeduplicator::add(const Event& event)
+{
+    add(std::vector<Event>{event});
+}
+
+void EventDeduplicator::add(const std::vector<Event>& events)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (frozen_)
+    {
+        throw std::logic_error("Events added to a frozen deduplicator");
+    }
+    for (const auto& event : events)
+    {
+        Run& run{runs_[event.run]};
+        if (!run.keys)
+        {
+            run.keys = std::make_shared<std::vector<uint64_t>>();
+        }
+        run.keys->push_back(key(event));
+    }
+    keysInMemory_ += events.size();
+
+    if (!spillDir_.empty() && keysInMemory_ * sizeof(uint64_t) > memoryBudget_)
+    {
+        for (auto& run : runs_)
+        {
+            spill(run.first, run.second);
+        }
+    }
+}
+
+std::string EventDeduplicator::spillFile(const int32_t run) const
+{
+    return spillDir_ + "/run" + std::to_string(run) + ".keys";
+}
+
+void EventDeduplicator::spill(const int32_t run, Run& keys)
+{
+    if (!keys.keys || keys.keys->empty())
+    {
+        return;
+    }
+    keysInMemory_ -= keys.keys->size();
+    sortUnique(*keys.keys);
+    std::ofstream out{spillFile(run), std::ios::binary | std::ios::app};
+    out.write(reinterpret_cast<const char*>(keys.keys->data()),
+              static_cast<std::streamsize>(keys.keys->size() * sizeof(uint64_t)));
+    if (!out.flush())
+    {
+        throw std::runtime_error("Couldn't spill events to " + spillFile(run));
+    }
+    keys.spilledKeys += keys.keys->size();
+    keys.keys.reset();
+}
+
+void EventDeduplicator::freeze()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (frozen_)
+    {
+        return;
+    }
+
+    // Once anything has spilled, everything does, leaving the memory to the
+    // runs loaded by lookups
+    const bool spilling{std::any_of(
+        runs_.begin(), runs_.end(), [](const std::pair<const int32_t, Run>& run) { return run.second.spilledKeys > 0; })};
+    size_t added{0};
+    for (auto& run : runs_)
+    {
+        if (spilling)
+        {
+            spill(run.first, run.second);
+        }
+        added += run.second.spilledKeys + (run.second.keys ? run.second.keys->size() : 0);
+    }
+
+    const size_t blocks{std::max<size_t>(1, (added * bloomBitsPerKey + 511) / 512)};
+    bloom_.assign(blocks * bloomBlockWords, 0);
+    const auto addToBloom{[this, blocks](const int32_t run, const std::vector<uint64_t>& keys) {
+        for (const uint64_t runKey : keys)
+        {
+            const uint64_t keyHash{hash(run, runKey)};
+            uint64_t* const block{&bloom_[((keyHash >> 32) % blocks) * bloomBlockWords]};
+            bloomBits(keyHash, [block](const unsigned word, const uint64_t mask) { block[word] |= mask; });
+        }
+    }};
+
+    for (auto& run : runs_)
+    {
+        if (run.second.spilledKeys == 0)
+        {
+            sortUnique(*run.second.keys);
+            run.second.keys->shrink_to_fit();
+            addToBloom(run.first, *run.second.keys);
+            size_ += run.second.keys->size();
+            continue;
+        }
+
+        // Merge the spilled chunks, one run at a time
+        std::vector<uint64_t> keys(run.second.spilledKeys);
+        {
+            std::ifstream in{spillFile(run.first), std::ios::binary};
+            in.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(uint64_t)));
+            if (!in)
+            {
+                throw std::runtime_error("Couldn't read spilled events from " + spillFile(run.first));
+            }
+        }
+        sortUnique(keys);
+        std::ofstream out{spillFile(run.first), std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(uint64_t)));
+        if (!out.flush())
+        {
+            throw std::runtime_error("Couldn't spill events to " + spillFile(run.first));
+        }
+        run.second.spilledKeys = keys.size();
+        addToBloom(run.first, keys);
+        size_ += keys.size();
+    }
+    keysInMemory_ = spilling ? 0 : size_;
+    frozen_ = true;
+}
+
+std::shared_ptr<const std::vector<uint64_t>> EventDeduplicator::runKeys(const int32_t run) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    const auto it{runs_.find(run)};
+    if (it == runs_.end())
+    {
+        return nullptr;
+    }
+    Run& runEntry{it->second};
+    if (runEntry.spilledKeys == 0)
+    {
+        return runEntry.keys;
+    }
+    if (runEntry.keys)
+    {
+        loadOrder_.splice(loadOrder_.end(), loadOrder_, runEntry.loaded);
+        return runEntry.keys;
+    }
+
+    runEntry.keys = std::make_shared<std::vector<uint64_t>>(runEntry.spilledKeys);
+    std::ifstream in{spillFile(run), std::ios::binary};
+    in.read(reinterpret_cast<char*>(runEntry.keys->data()),
+            static_cast<std::streamsize>(runEntry.keys->size() * sizeof(uint64_t)));
+    if (!in)
+    {
+        runEntry.keys.reset();
+        throw std::runtime_error("Couldn't read spilled events from " + spillFile(run));
+    }
+    keysInMemory_ += runEntry.spilledKeys;
+    runEntry.loaded = loadOrder_.insert(loadOrder_.end(), run);
+
+    // Lookups still using an evicted run keep it alive until they finish
+    while (keysInMemory_ * sizeof(uint64_t) > memoryBudget_ && loadOrder_.size() > 1)
+    {
+        Run& evicted{runs_.at(loadOrder_.front())};
+        keysInMemory_ -= evicted.spilledKeys;
+        evicted.keys.reset();
+        loadOrder_.pop_front();
+    }
+    return runEntry.keys;
+}
+
+bool EventDeduplicator::contains(const Event& event) const
+{
+    if (!frozen_)
+    {
+        throw std::logic_error("Looking up events before freezing the deduplicator");
+    }
+    const uint64_t eventKey{key(event)};
+    const uint64_t keyHash{hash(event.run, eventKey)};
+    const size_t blocks{bloom_.size() / bloomBlockWords};
+    const uint64_t* const block{&bloom_[((keyHash >> 32) % blocks) * bloomBlockWords]};
+    bool maybe{true};
+    bloomBits(keyHash, [block, &maybe](const unsigned word, const uint64_t mask) { maybe = maybe && (block[word] & mask); });
+    if (!maybe)
+    {
+        return false;
+    }
+
+    const auto keys{runKeys(event.run)};
+    return keys && std::binary_search(keys->begin(), keys->end(), eventKey);
+}
+
+size_t EventDeduplicator::bytes() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return (keysInMemory_ + bloom_.size()) * sizeof(uint64_t);
+}
@@ -0,0 +1,239 @@
+#include "histogramAccumulator.hpp"
+
+#include "TAxis.h"
+#include "TH1D.h"
+#include "TH2D.h"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+// TH1::GetStats fills at most this many numbers (TH1::kNstat)
+constexpr size_t numStats{13};
+} // namespace
+
+AccumulatorAxis::AccumulatorAxis(const int nBins, const double min, const double max)
+    : nBins_{nBins}
+    , min_{min}
+    , max_{max}
+    , width_{max - min}
+    , edges_{}
+{
+    if (nBins < 1 || !(max > min))
+    {
+        throw std::logic_error("Invalid histogram binning");
+    }
+}
+
+AccumulatorAxis::AccumulatorAxis(const TAxis& axis)
+    : AccumulatorAxis{axis.GetNbins(), axis.GetXmin(), axis.GetXmax()}
+{
+    const TArrayD* edges{axis.GetXbins()};
+    if (edges->GetSize() > 0)
+    {
+        edges_.assign(edges->GetArray(), edges->GetArray() + edges->GetSize());
+    }
+}
+
+HistogramAccumulator::HistogramAccumulator(const int nBins, const double min, const double max)
+    : axis_{nBins, min, max}
+    , bins_{}
+    , entries_{0}
+    , sumW_{0.}
+    , sumW2_{0.}
+    , sumWX_{0.}
+    , sumWX2_{0.}
+{
+}
+
+HistogramAccumulator::HistogramAccumulator(const TH1D& hist)
+    : axis_{*hist.GetXaxis()}
+    , bins_{}
+    , entries_{0}
+    , sumW_{0.}
+    , sumW2_{0.}
+    , sumWX_{0.}
+    , sumWX2_{0.}
+{
+}
+
+void HistogramAccumulator::merge(const HistogramAccumulator& other)
+{
+    if (!(axis_ == other.axis_))
+    {
+        throw std::logic_error("Merging histogram accumulators with different binning");
+    }
+    if (other.empty())
+    {
+        return;
+    }
+    if (bins_.empty())
+    {
+        allocate();
+    }
+    for (size_t i{0}; i < bins_.size(); i++)
+    {
+        bins_[i].sumW += other.bins_[i].sumW;
+        bins_[i].sumW2 += other.bins_[i].sumW2;
+    }
+    entries_ += other.entries_;
+    sumW_ += other.sumW_;
+    sumW2_ += other.sumW2_;
+    sumWX_ += other.sumWX_;
+    sumWX2_ += other.sumWX2_;
+}
+
+void HistogramAccumulator::addTo(TH1D& hist) const
+{
+    if (!(AccumulatorAxis{*hist.GetXaxis()} == axis_))
+    {
+        throw std::logic_error(std::string{"Histogram accumulator binning doesn't match "} + hist.GetName());
+    }
+    if (empty())
+    {
+        return;
+    }
+
+    // Read before the contents change, TH1 may recompute them from the bins
+    std::array<double, numStats> stats{};
+    hist.GetStats(stats.data());
+    const double entries{hist.GetEntries()};
+
+    if (hist.GetSumw2N() == 0)
+    {
+        hist.Sumw2();
+    }
+    double* contents{hist.GetArray()};
+    double* sumW2{hist.GetSumw2()->GetArray()};
+    for (size_t i{0}; i < bins_.size(); i++)
+    {
+        contents[i] += bins_[i].sumW;
+        sumW2[i] += bins_[i].sumW2;
+    }
+
+    stats[0] += sumW_;
+    stats[1] += sumW2_;
+    stats[2] += sumWX_;
+    stats[3] += sumWX2_;
+    hist.PutStats(stats.data());
+    hist.SetEntries(entries + static_cast<double>(entries_));
+}
+
+void HistogramAccumulator::allocate()
+{
+    bins_.assign(static_cast<size_t>(axis_.nBins() + 2), Bin{0., 0.});
+}
+
+void HistogramAccumulator::reset()
+{
+    std::fill(bins_.begin(), bins_.end(), Bin{0., 0.});
+    entries_ = 0;
+    sumW_ = 0.;
+    sumW2_ = 0.;
+    sumWX_ = 0.;
+    sumWX2_ = 0.;
+}
+
+HistogramAccumulator2D::HistogramAccumulator2D(const int nBinsX, const double minX, const double maxX, const int nBinsY, const double minY, const double maxY)
+    : xAxis_{nBinsX, minX, maxX}
+    , yAxis_{nBinsY, minY, maxY}
+    , bins_(static_cast<size_t>((nBinsX + 2) * (nBinsY + 2)), Bin{0., 0.})
+    , entries_{0}
+    , sumW_{0.}
+    , sumW2_{0.}
+    , sumWX_{0.}
+    , sumWX2_{0.}
+    , sumWY_{0.}
+    , sumWY2_{0.}
+    , sumWXY_{0.}
+{
+}
+
+HistogramAccumulator2D::HistogramAccumulator2D(const TH2D& hist)
+    : xAxis_{*hist.GetXaxis()}
+    , yAxis_{*hist.GetYaxis()}
+    , bins_(static_cast<size_t>((xAxis_.nBins() + 2) * (yAxis_.nBins() + 2)), Bin{0., 0.})
+    , entries_{0}
+    , sumW_{0.}
+    , sumW2_{0.}
+    , sumWX_{0.}
+    , sumWX2_{0.}
+    , sumWY_{0.}
+    , sumWY2_{0.}
+    , sumWXY_{0.}
+{
+}
+
+void HistogramAccumulator2D::merge(const HistogramAccumulator2D& other)
+{
+    if (!(xAxis_ == other.xAxis_) || !(yAxis_ == other.yAxis_))
+    {
+        throw std::logic_error("Merging histogram accumulators with different binning");
+    }
+    for (size_t i{0}; i < bins_.size(); i++)
+    {
+        bins_[i].sumW += other.bins_[i].sumW;
+        bins_[i].sumW2 += other.bins_[i].sumW2;
+    }
+    entries_ += other.entries_;
+    sumW_ += other.sumW_;
+    sumW2_ += other.sumW2_;
+    sumWX_ += other.sumWX_;
+    sumWX2_ += other.sumWX2_;
+    sumWY_ += other.sumWY_;
+    sumWY2_ += other.sumWY2_;
+    sumWXY_ += other.sumWXY_;
+}
+
+void HistogramAccumulator2D::addTo(TH2D& hist) const
+{
+    if (!(AccumulatorAxis{*hist.GetXaxis()} == xAxis_) || !(AccumulatorAxis{*hist.GetYaxis()} == yAxis_))
+    {
+        throw std::logic_error(std::string{"Histogram accumulator binning doesn't match "} + hist.GetName());
+    }
+    if (empty())
+    {
+        return;
+    }
+
+    std::array<double, numStats> stats{};
+    hist.GetStats(stats.data());
+    const double entries{hist.GetEntries()};
+
+    if (hist.GetSumw2N() == 0)
+    {
+        hist.Sumw2();
+    }
+    double* contents{hist.GetArray()};
+    double* sumW2{hist.GetSumw2()->GetArray()};
+    for (size_t i{0}; i < bins_.size(); i++)
+    {
+        contents[i] += bins_[i].sumW;
+        sumW2[i] += bins_[i].sumW2;
+    }
+
+    stats[0] += sumW_;
+    stats[1] += sumW2_;
+    stats[2] += sumWX_;
+    stats[3] += sumWX2_;
+    stats[4] += sumWY_;
+    stats[5] += sumWY2_;
+    stats[6] += sumWXY_;
+    hist.PutStats(stats.data());
+    hist.SetEntries(entries + static_cast<double>(entries_));
+}
+
+void HistogramAccumulator2D::reset()
+{
+    std::fill(bins_.begin(), bins_.end(), Bin{0., 0.});
+    entries_ = 0;
+    sumW_ = 0.;
+    sumW2_ = 0.;
+    sumWX_ = 0.;
+    sumWX2_ = 0.;
+    sumWY_ = 0.;
+    sumWY2_ = 0.;
+    sumWXY_ = 0.;
+}
@@ -0,0 +1,124 @@
+#include "histogramFile.hpp"
+
+#include "TFile.h"
+#include "TH1D.h"
+#include "TObjString.h"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+// Makes the directories of the path a level at a time, as TDirectory::mkdir
+// of a nested path returns the top directory it made rather than the deepest
+TDirectory* makeDirectory(TDirectory* top, const std::string& path)
+{
+    TDirectory* directory{top};
+    std::istringstream levels{path};
+    for (std::string level; std::getline(levels, level, '/');)
+    {
+        TDirectory* subdirectory{directory->GetDirectory(level.c_str())};
+        if (!subdirectory)
+        {
+            subdirectory = directory->mkdir(level.c_str());
+        }
+        if (!subdirectory)
+        {
+            throw std::runtime_error("Couldn't make directory " + path + " of " + top->GetName());
+        }
+        directory = subdirectory;
+    }
+    return directory;
+}
+} // namespace
+
+std::string HistogramFile::path(const Key& key)
+{
+    return key.dataset + "/" + key.channel + "/" + key.stage + "/" + key.systematic + "/" + key.plot;
+}
+
+void HistogramFile::Writer::add(const Key& key, TH1D* hist)
+{
+    if (!histograms_.emplace(path(key), hist).second)
+    {
+        throw std::logic_error("Histogram saved twice: " + path(key));
+    }
+}
+
+void HistogramFile::Writer::write(const std::string& file, const int compression) const
+{
+    std::unique_ptr<TFile> outFile{compression < 0 ? new TFile{file.c_str(), "RECREATE"}
+                                                   : new TFile{file.c_str(), "RECREATE", "", compression}};
+    if (outFile->IsZombie())
+    {
+        throw std::runtime_error("Couldn't create histogram file " + file);
+    }
+
+    // The paths are sorted, so each directory is looked up once
+    std::string index;
+    std::string currentPath;
+    TDirectory* directory{nullptr};
+    for (const auto& histogram : histograms_)
+    {
+        const size_t slash{histogram.first.rfind('/')};
+        const std::string directoryPath{histogram.first.substr(0, slash)};
+        if (!directory || directoryPath != currentPath)
+        {
+            directory = makeDirectory(outFile.get(), directoryPath);
+            currentPath = directoryPath;
+        }
+        directory->WriteTObject(histogram.second, histogram.first.substr(slash + 1).c_str());
+        index += histogram.first + "\n";
+    }
+
+    TObjString indexString{index.c_str()};
+    outFile->WriteTObject(&indexString, "index");
+    outFile->Close();
+    std::cout << "Saved " << histograms_.size() << " histograms to " << file << std::endl;
+}
+
+HistogramFile::Reader::Reader(const std::string& file)
+    : file_{file}
+{
+    std::unique_ptr<TFile> inFile{new TFile{file.c_str(), "READ"}};
+    if (inFile->IsZombie())
+    {
+        throw std::runtime_error("Couldn't open histogram file " + file);
+    }
+    TObjString* indexString{nullptr};
+    inFile->GetObject("index", indexString);
+    if (!indexString)
+    {
+        throw std::runtime_error("No histogram index in " + file);
+    }
+
+    std::istringstream index{indexString->GetString().Data()};
+    delete indexString;
+    for (std::string path; std::getline(index, path);)
+    {
+        if (path.empty())
+        {
+            continue;
+        }
+        TH1D* hist{nullptr};
+        inFile->GetObject(path.c_str(), hist);
+        if (!hist)
+        {
+            throw std::runtime_error("Histogram " + path + " is in the index but not in " + file);
+        }
+        hist->SetDirectory(nullptr);
+        histograms_.emplace(path, std::unique_ptr<TH1D>{hist});
+    }
+    inFile->Close();
+}
+
+TH1D* HistogramFile::Reader::get(const Key& key) const
+{
+    const auto it{histograms_.find(path(key))};
+    if (it == histograms_.end())
+    {
+        throw std::runtime_error("No histogram " + path(key) + " in " + file_);
+    }
+    return it->second.get();
+}
@@ -1,5 +1,8 @@
 #include "histogramPlotter.hpp"
 
+#include "fingerprint.hpp"
+#include "provenance.hpp"
+
 #include "TCanvas.h"
 #include "TColor.h"
 #include "TH1D.h"
@@ -7,6 +10,7 @@
 #include "TLegend.h"
 #include "TMath.h"
 #include "TPad.h"
+#include "TROOT.h"
 #include "TStyle.h"
 
 // For CMS Guideline styling
@@ -14,7 +18,18 @@
 #include "TLatex.h"
 
 #include <boost/filesystem.hpp>
+#include <poll.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
 
 // For debugging. *sigh*
 #include <iostream>
@@ -22,6 +37,16 @@
 const bool BLIND_PLOTS(true);
 const bool writeExtraText(false);
 
+// Kept next to the plots. Bump the version when the manifest changes. Changes
+// to the drawing code are picked up from the hash of this file and its header,
+// which the makefile passes in, or failing that from the code version.
+const std::string plotManifestName{".plotManifest"};
+const std::string plotManifestVersion{"2"};
+#ifndef HTOSS_PLOTTER_VERSION
+#define HTOSS_PLOTTER_VERSION "unknown"
+#endif
+const std::string plotterVersion{HTOSS_PLOTTER_VERSION};
+
 HistogramPlotter::HistogramPlotter(std::vector<std::string> legOrder,
                                    std::vector<std::string> plotOrder,
                                    std::map<std::string, datasetInfo> dsetMap,
@@ -35,6 +60,9 @@ HistogramPlotter::HistogramPlotter(std::vector<std::string> legOrder,
     , is2016_{is2016}
     , is2018_{is2018}
     , loadHistos_{false}
+    , histogramWriter_{}
+    , histogramReader_{}
+    , histogramCompression_{-1}
     ,
 
     // Some things that actually need to be set. plot order, legend order and
@@ -42,6 +70,9 @@ HistogramPlotter::HistogramPlotter(std::vector<std::string> legOrder,
     plotOrder_{plotOrder}
     , legOrder_{legOrder}
     , dsetMap_{dsetMap}
+    , pendingPlots_{}
+    , plotWorkers_{1}
+    , forceReplot_{false}
 {
     gErrorIgnoreLevel = kInfo;
 
@@ -87,7 +118,9 @@ HistogramPlotter::~HistogramPlotter()
 
 void HistogramPlotter::plotHistos(
     std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>
-        plotMap)
+        plotMap,
+    const std::string& channel,
+    const std::string& systematic)
 {
     // Get a list of keys from the map.
     auto firstIt = plotMap.begin();
@@ -112,23 +145,12 @@ void HistogramPlotter::plotHistos(
             {
                 if (loadHistos_)
                 {
-                    TFile* inputFile = new TFile{
-                        (histogramDirectory_
-                         + firstIt->second[*stageIt]->getPlotPoint()[i].name
-                         + "_Histo.root")
-                            .c_str(),
-                        "READ"};
-                    TH1D* tempHist =
-                        dynamic_cast<TH1D*>(inputFile
-                                                ->Get((firstIt->second[*stageIt]
-                                                           ->getPlotPoint()[i]
-                                                           .name)
-                                                          .c_str())
-                                                ->Clone());
-                    tempHist->SetDirectory(0);
-                    tempPlotMap[mapIt->first] = tempHist;
-                    inputFile->Close();
-                    delete inputFile;
+                    tempPlotMap[mapIt->first] = histogramReader().get(
+                        {mapIt->first,
+                         channel,
+                         *stageIt,
+                         systematic,
+                         firstIt->second[*stageIt]->getPlotPoint()[i].configName});
                 }
                 else if (!loadHistos_)
                 {
@@ -154,15 +176,10 @@ std::map<std::string, TH1D*>
     for (auto plot_iter = plotOrder_.rbegin(); plot_iter != plotOrder_.rend();
          plot_iter++)
     {
-        TFile* inputFile =
-            new TFile{(histogramDirectory_ + *plot_iter + "_" + channel + "_"
-                       + plotName + "_Histo.root")
-                          .c_str(),
-                      "READ"};
         cutFlowMap.emplace(
             *plot_iter,
-            dynamic_cast<TH1D*>(
-                inputFile->Get((*plot_iter + "cutFlow").c_str())->Clone()));
+            histogramReader().get(
+                {*plot_iter, channel, plotName, HistogramFile::nominal, plotName}));
     }
     return cutFlowMap;
 }
@@ -174,70 +191,53 @@ void HistogramPlotter::saveHistos(std::map<std::string, TH1D*> cutFlowMap,
     for (auto plot_iter = plotOrder_.rbegin(); plot_iter != plotOrder_.rend();
          plot_iter++)
     {
-        TFile* outFile = new TFile{(histogramDirectory_ + *plot_iter + "_"
-                                    + channel + "_" + plotName + "_Histo.root")
-                                       .c_str(),
-                                   "RECREATE"};
-        outFile->cd();
-        cutFlowMap[*plot_iter]->Write(); // Write histo to file
-        outFile->Write();
-        outFile->Close();
-        delete outFile;
+        histogramWriter_.add(
+            {*plot_iter, channel, plotName, HistogramFile::nominal, plotName},
+            cutFlowMap[*plot_iter]);
     }
 }
 
 void HistogramPlotter::saveHistos(
     std::map<std::string, std::map<std::string, std::shared_ptr<Plots>>>
-        plotMap)
+        plotMap,
+    const std::string& channel,
+    const std::string& systematic)
 {
-    // Get a list of keys from the map.
-    auto firstIt = plotMap.begin();
-    std::vector<std::string> stageNameVec;
-    for (auto stageNameIt = firstIt->second.begin();
-         stageNameIt != firstIt->second.end();
-         stageNameIt++)
+    for (auto mapIt = plotMap.begin(); mapIt != plotMap.end(); mapIt++)
     {
-        stageNameVec.emplace_back(stageNameIt->first);
-    }
-
-    // Loop over all the plots, for each stage name. Then create a map for each
-    // with all datasets in it.
-    unsigned long plotNumb{
-        firstIt->second.begin()->second->getPlotPoint().size()};
-    for (unsigned i{0}; i < plotNumb; i++)
-    {
-        for (auto stageIt = stageNameVec.begin(); stageIt != stageNameVec.end();
+        for (auto stageIt = mapIt->second.begin();
+             stageIt != mapIt->second.end();
              stageIt++)
         {
-            std::map<std::string, TH1D*> tempPlotMap;
-            for (auto mapIt = plotMap.begin(); mapIt != plotMap.end(); mapIt++)
+            for (const auto& point : stageIt->second->getPlotPoint())
             {
-                tempPlotMap[mapIt->first] =
-                    mapIt->second[*stageIt]->getPlotPoint()[i].plotHist;
-            }
-            for (auto plot_iter = plotOrder_.rbegin();
-                 plot_iter != plotOrder_.rend();
-                 plot_iter++)
-            {
-                TFile* outFile = new TFile{
-                    (histogramDirectory_
-                     + firstIt->second[*stageIt]->getPlotPoint()[i].name
-                     + "_Histo.root")
-                        .c_str(),
-                    "RECREATE"};
-                outFile->cd();
-                tempPlotMap[*plot_iter]->SetName(
-                    (firstIt->second[*stageIt]->getPlotPoint()[i].name)
-                        .c_str());
-                tempPlotMap[*plot_iter]->Write(); // Write histo to file
-                outFile->Write();
-                outFile->Close();
-                delete outFile;
+                histogramWriter_.add({mapIt->first,
+                                      channel,
+                                      stageIt->first,
+                                      systematic,
+                                      point.configName},
+                                     point.plotHist);
             }
         }
     }
 }
 
+void HistogramPlotter::writeHistos()
+{
+    histogramWriter_.write(histogramDirectory_ + HistogramFile::fileName,
+                           histogramCompression_);
+}
+
+const HistogramFile::Reader& HistogramPlotter::histogramReader()
+{
+    if (!histogramReader_)
+    {
+        histogramReader_.reset(new HistogramFile::Reader{
+            histogramDirectory_ + HistogramFile::fileName});
+    }
+    return *histogramReader_;
+}
+
 void HistogramPlotter::makePlot(std::map<std::string, TH1D*> plotMap,
                                 std::string plotTitle,
                                 std::string plotName)
@@ -269,6 +269,361 @@ void HistogramPlotter::makePlot(std::map<std::string, TH1D*> plotMap,
                                 std::string subLabel,
                                 std::vector<std::string> xAxisLabels)
 {
+    pendingPlots_.push_back({plotMap, plotTitle, plotName, subLabel, xAxisLabels});
+}
+
+unsigned HistogramPlotter::renderPlots()
+{
+    if (pendingPlots_.empty())
+    {
+        return 0;
+    }
+    const auto start{std::chrono::steady_clock::now()};
+
+    // Drop the plots which haven't changed since they were last drawn
+    std::map<std::string, std::string> manifest{readPlotManifest()};
+    std::vector<std::string> fingerprints;
+    size_t upToDate{0};
+    for (auto it{pendingPlots_.begin()}; it != pendingPlots_.end();)
+    {
+        const std::string fingerprint{plotFingerprint(*it)};
+        const auto entry{manifest.find(it->name)};
+        bool unchanged{!forceReplot_ && entry != manifest.end() && entry->second == fingerprint};
+        for (const auto& extension : extensions_)
+        {
+            unchanged = unchanged && boost::filesystem::exists(outputFolder_ + it->name + extension);
+        }
+        if (unchanged)
+        {
+            it = pendingPlots_.erase(it);
+            upToDate++;
+            continue;
+        }
+        fingerprints.emplace_back(fingerprint);
+        ++it;
+    }
+    if (upToDate > 0)
+    {
+        std::cout << upToDate << " plots are up to date" << std::endl;
+    }
+    if (pendingPlots_.empty())
+    {
+        return 0;
+    }
+
+    const unsigned workers{std::min(
+        plotWorkers_, static_cast<unsigned>(pendingPlots_.size()))};
+    std::cout << "Drawing " << pendingPlots_.size() << " plots with "
+              << std::max(workers, 1u) << " worker(s) ..." << std::endl;
+
+    std::vector<PlotResult> results(pendingPlots_.size(), PlotResult{false, false, 0., {}});
+    if (workers > 1)
+    {
+        renderInWorkers(results, workers);
+    }
+    else
+    {
+        const bool batch{gROOT->IsBatch()};
+        gROOT->SetBatch(true);
+        for (size_t i{0}; i < pendingPlots_.size(); i++)
+        {
+            results[i] = renderPlot(pendingPlots_[i]);
+        }
+        gROOT->SetBatch(batch);
+    }
+
+    unsigned failed{0};
+    for (size_t i{0}; i < results.size(); i++)
+    {
+        const PlotResult& result{results[i]};
+        if (result.done && result.ok)
+        {
+            std::ostringstream time;
+            time << std::setw(8) << std::setprecision(2) << std::fixed << result.seconds;
+            std::cout << "    " << time.str() << " s  " << pendingPlots_[i].name << std::endl;
+            continue;
+        }
+        failed++;
+        std::cerr << "    FAILED    " << pendingPlots_[i].name << ": "
+                  << (result.done ? result.error : "plot worker died before drawing it")
+                  << std::endl;
+    }
+
+    // Failed plots are dropped so that they are retried next time
+    for (size_t i{0}; i < results.size(); i++)
+    {
+        if (results[i].done && results[i].ok)
+        {
+            manifest[pendingPlots_[i].name] = fingerprints[i];
+        }
+        else
+        {
+            manifest.erase(pendingPlots_[i].name);
+        }
+    }
+    writePlotManifest(manifest);
+
+    std::cout << "Drew " << results.size() - failed << " of " << results.size()
+              << " plots in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+              << " s" << std::endl;
+
+    pendingPlots_.clear();
+    return failed;
+}
+
+std::string HistogramPlotter::plotFingerprint(const PlotJob& job) const
+{
+    Fingerprint fingerprint;
+    fingerprint.add(plotManifestVersion)
+        .add(plotterVersion == "unknown" ? Provenance::codeVersion() : plotterVersion)
+        .add(BLIND_PLOTS)
+        .add(writeExtraText)
+        .add(is2016_)
+        .add(is2018_)
+        .add(lumiStr_)
+        .add(postfix_)
+        .add(extensions_)
+        .add(plotOrder_)
+        .add(legOrder_)
+        .add(job.title)
+        .add(job.subLabel)
+        .add(job.xAxisLabels);
+    for (const TPaveText* label : {labelOne_, labelTwo_, labelThree_})
+    {
+        fingerprint.add(label->GetLabel()).add(label->GetTextSize());
+    }
+
+    for (const auto& dataset : job.plotMap)
+    {
+        fingerprint.add(dataset.first);
+        const auto info{dsetMap_.find(dataset.first)};
+        if (info != dsetMap_.end())
+        {
+            fingerprint.add(info->second.colour)
+                .add(info->second.legLabel)
+                .add(info->second.legType);
+        }
+
+        const TH1D* hist{dataset.second};
+        if (!hist)
+        {
+            fingerprint.add(-1);
+            continue;
+        }
+        const int nBins{hist->GetNbinsX()};
+        fingerprint.add(nBins);
+        for (int bin{1}; bin <= nBins + 1; bin++)
+        {
+            fingerprint.add(hist->GetXaxis()->GetBinLowEdge(bin));
+        }
+        for (int bin{0}; bin <= nBins + 1; bin++)
+        {
+            fingerprint.add(hist->GetBinContent(bin)).add(hist->GetBinError(bin));
+        }
+    }
+    return fingerprint.hex();
+}
+
+std::map<std::string, std::string> HistogramPlotter::readPlotManifest() const
+{
+    std::map<std::string, std::string> manifest;
+    std::ifstream file{outputFolder_ + plotManifestName};
+    for (std::string line; std::getline(file, line);)
+    {
+        const size_t space{line.find(' ')};
+        if (space != std::string::npos)
+        {
+            manifest[line.substr(space + 1)] = line.substr(0, space);
+        }
+    }
+    return manifest;
+}
+
+void HistogramPlotter::writePlotManifest(const std::map<std::string, std::string>& manifest) const
+{
+    // Written aside and moved over so that an interrupted run can't leave a
+    // truncated manifest
+    const std::string fileName{outputFolder_ + plotManifestName};
+    {
+        std::ofstream file{fileName + ".tmp"};
+        for (const auto& entry : manifest)
+        {
+            file << entry.second << ' ' << entry.first << '\n';
+        }
+        if (!file)
+        {
+            std::cerr << "Couldn't write the plot manifest " << fileName << std::endl;
+            return;
+        }
+    }
+    boost::filesystem::rename(fileName + ".tmp", fileName);
+}
+
+HistogramPlotter::PlotResult HistogramPlotter::renderPlot(PlotJob& job)
+{
+    PlotResult result{true, true, 0., {}};
+    const auto start{std::chrono::steady_clock::now()};
+    try
+    {
+        drawPlot(job);
+    }
+    catch (const std::exception& e)
+    {
+        result.ok = false;
+        result.error = e.what();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Each worker draws every workers-th plot and reports back one line per plot
+// through a pipe: index, success, time and error message. A worker which
+// crashes only loses the plots it hadn't reported yet.
+void HistogramPlotter::renderInWorkers(std::vector<PlotResult>& results, const unsigned workers)
+{
+    std::vector<std::pair<pid_t, int>> children;
+    for (unsigned w{0}; w < workers; w++)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            throw std::runtime_error("Couldn't create a pipe for the plot workers");
+        }
+        // Don't let the children inherit unflushed output
+        std::cout.flush();
+        std::cerr.flush();
+        const pid_t pid{fork()};
+        if (pid < 0)
+        {
+            throw std::runtime_error("Couldn't start a plot worker");
+        }
+        if (pid == 0)
+        {
+            close(fds[0]);
+            gROOT->SetBatch(true);
+            setTDRStyle();
+            for (size_t i{w}; i < pendingPlots_.size(); i += workers)
+            {
+                const PlotResult result{renderPlot(pendingPlots_[i])};
+                std::string error{result.error};
+                std::replace(error.begin(), error.end(), '\n', ' ');
+                std::ostringstream line;
+                line << i << ' ' << result.ok << ' ' << result.seconds << ' '
+                     << error << '\n';
+                const std::string message{line.str()};
+                for (size_t written{0}; written < message.size();)
+                {
+                    const ssize_t n{write(fds[1], message.data() + written, message.size() - written)};
+                    if (n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (n <= 0)
+                    {
+                        _exit(1);
+                    }
+                    written += static_cast<size_t>(n);
+                }
+            }
+            close(fds[1]);
+            std::cout.flush();
+            std::cerr.flush();
+            // Skip the exit handlers, which belong to the parent's ROOT
+            _exit(0);
+        }
+        close(fds[1]);
+        children.emplace_back(pid, fds[0]);
+    }
+
+    // Read the pipes as the workers write to them, so none is left blocked on
+    // a full pipe while another is read
+    std::vector<pollfd> pipes;
+    for (const auto& child : children)
+    {
+        pipes.push_back({child.second, POLLIN, 0});
+    }
+    std::vector<std::string> outputs(children.size());
+    for (size_t openPipes{pipes.size()}; openPipes > 0;)
+    {
+        if (poll(pipes.data(), static_cast<nfds_t>(pipes.size()), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // Still reap the workers below, their unreported plots failing
+            std::cerr << "Couldn't wait for the plot workers" << std::endl;
+            break;
+        }
+        for (size_t c{0}; c < pipes.size(); c++)
+        {
+            if (pipes[c].fd < 0 || pipes[c].revents == 0)
+            {
+                continue;
+            }
+            char buffer[4096];
+            const ssize_t n{read(pipes[c].fd, buffer, sizeof buffer)};
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                // Worker done or crashed, poll skips negative fds
+                close(pipes[c].fd);
+                pipes[c].fd = -1;
+                openPipes--;
+                continue;
+            }
+            outputs[c].append(buffer, static_cast<size_t>(n));
+        }
+    }
+    for (const auto& reader : pipes)
+    {
+        if (reader.fd >= 0)
+        {
+            close(reader.fd);
+        }
+    }
+
+    for (size_t c{0}; c < children.size(); c++)
+    {
+        const auto& child{children[c]};
+        std::istringstream lines{outputs[c]};
+        for (std::string line; std::getline(lines, line);)
+        {
+            std::istringstream fields{line};
+            size_t i;
+            PlotResult result{true, false, 0., {}};
+            if (!(fields >> i >> result.ok >> result.seconds) || i >= results.size())
+            {
+                continue;
+            }
+            fields.get();
+            std::getline(fields, result.error);
+            results[i] = result;
+        }
+
+        int status{0};
+        while (waitpid(child.first, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "Plot worker " << child.first << " didn't finish cleanly" << std::endl;
+        }
+    }
+}
+
+void HistogramPlotter::drawPlot(PlotJob& job)
+{
+    std::map<std::string, TH1D*>& plotMap{job.plotMap};
+    const std::string& plotTitle{job.title};
+    const std::string& plotName{job.name};
+    const std::string& subLabel{job.subLabel};
+    const std::vector<std::string>& xAxisLabels{job.xAxisLabels};
+
     std::cerr << "Making a plot called: " << plotName << std::endl;
 
     // Make the legend. This is clearly the first thing I should do.
@@ -470,9 +825,8 @@ void HistogramPlotter::makePlot(std::map<std::string, TH1D*> plotMap,
         }
     }
     else {
-        std::cout << "This shouldn't occur - means there are no plots to be plotted." << std::endl;
-	std::cout << "Program should have crashed by now! Serious bug ..." << std::endl;
-        exit(999);
+        delete canvy;
+        throw std::runtime_error("No histograms to draw");
     }
 
     legend_->Draw();
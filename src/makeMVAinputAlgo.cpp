@@ -5,6 +5,7 @@
 #include "TTree.h"
 #include "config_parser.hpp"
 #include "makeMVAinputAlgo.hpp"
+#include "outputPolicy.hpp"
 
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
@@ -26,6 +27,8 @@ MakeMvaInputs::MakeMvaInputs()
     , doFakes{false}
     , inputDir{"mvaTest/"}
     , outputDir{"mvaInputs/"}
+    , outputPolicyName{}
+    , outputPolicy{-1, -1, {}}
 {
 }
 
@@ -56,7 +59,11 @@ void MakeMvaInputs::parseCommandLineArguements(const int argc, char* argv[])
         po::bool_switch(&doSysts),
         "Run dedicated systematic analysis")(
         "MC,M", po::bool_switch(&doMC), "Run MC analysis")(
-        "fakes,F", po::bool_switch(&doFakes), "Run fakes analysis");
+        "fakes,F", po::bool_switch(&doFakes), "Run fakes analysis")(
+        "outputPolicy",
+        po::value<std::string>(&outputPolicyName),
+        "Compression and basket sizes of the MVA inputs, e.g. made by "
+        "tuneCompression.exe.");
 
     po::variables_map vm;
 
@@ -79,6 +86,11 @@ void MakeMvaInputs::parseCommandLineArguements(const int argc, char* argv[])
         std::cerr << "Use -h or --help for help." << std::endl;
         std::exit(1);
     }
+
+    if (!outputPolicyName.empty())
+    {
+        outputPolicy = Parser::parse_output_policy(outputPolicyName);
+    }
 }
 
 void MakeMvaInputs::runMainAnalysis()
@@ -337,7 +349,11 @@ void MakeMvaInputs::standardAnalysis(
                 //        tree = new TChain(("tree"+syst).c_str());
                 //        tree->Add((inputDir+sample+channel+"mvaOut.root").c_str());
                 const long long numberOfEvents{tree->GetEntries()};
-                auto event{new MvaEvent{true, tree, is2016}};
+                // Files written with --slimMva keep the events in a payload
+                // tree shared by the systematics
+                auto payload{dynamic_cast<TTree*>(inFile->Get("payload"))};
+                auto event{payload ? new MvaEvent{true, payload, tree, is2016}
+                                   : new MvaEvent{true, tree, is2016}};
 
                 // loop over events
                 long double nEvents{0};
@@ -416,12 +432,22 @@ void MakeMvaInputs::dataAnalysis(const std::vector<std::string>& channels,
         }
         TFile outFile{(outputDir + "histofile_" + outChan + ".root").c_str(),
                       "RECREATE"};
+        const std::string dataFile{inputDir + channel + "Run" + era + channel
+                                   + "mvaOut.root"};
         TChain dataChain{"tree"};
-        dataChain.Add(
-            (inputDir + channel + "Run" + era + channel + "mvaOut.root")
-                .c_str());
+        dataChain.Add(dataFile.c_str());
+        TChain payloadChain{"payload"};
+        std::unique_ptr<MvaEvent> event;
+        if (MvaEvent::slimLayout(dataFile))
+        {
+            payloadChain.Add(dataFile.c_str());
+            event.reset(new MvaEvent{false, &payloadChain, &dataChain, is2016});
+        }
+        else
+        {
+            event.reset(new MvaEvent{false, &dataChain, is2016});
+        }
 
-        MvaEvent event{false, &dataChain, is2016};
         const long long numberOfEvents{dataChain.GetEntries()};
         TMVA::Timer lEventTimer{boost::numeric_cast<int>(numberOfEvents),
                                 "Running over dataset ...",
@@ -429,8 +455,8 @@ void MakeMvaInputs::dataAnalysis(const std::vector<std::string>& channels,
         for (long long i{0}; i < numberOfEvents; i++)
         {
             lEventTimer.DrawProgressBar(i);
-            event.GetEntry(i);
-            fillTree(outTreeSig, outTreeSdBnd, &event, outChan, channel, false);
+            event->GetEntry(i);
+            fillTree(outTreeSig, outTreeSdBnd, event.get(), outChan, channel, false);
         }
         outFile.cd();
         outTreeSig->SetDirectory(&outFile);
@@ -471,22 +497,35 @@ void MakeMvaInputs::sameSignAnalysis(
         const std::string chan{outFakeChanToData.at(outChan)};
 
         TChain dataChain{"tree"};
+        // Files written with --slimMva keep the events in a payload tree,
+        // chained alongside in the same order
+        TChain payloadChain{"payload"};
+        std::vector<std::string> inputFiles;
         // Get expected real SS events from MC
         for (const auto& mc : listOfMCs)
         {
             const std::string sample{mc.first};
+            inputFiles.emplace_back(inputDir + sample + chan + "invLepmvaOut.root");
+        }
+        inputFiles.emplace_back(inputDir + chanMap.at(chan) + chan + "invLepmvaOut.root");
 
-            // std::cout << "Doing SS fakes " << sample << std::endl;
-            if (!dataChain.Add(
-                    (inputDir + sample + chan + "invLepmvaOut.root").c_str()))
+        const bool slimLayout{MvaEvent::slimLayout(inputFiles.back())};
+        for (const auto& inputFile : inputFiles)
+        {
+            // std::cout << "Doing SS fakes " << inputFile << std::endl;
+            if (!dataChain.Add(inputFile.c_str()))
                 abort();
+            if (MvaEvent::slimLayout(inputFile) != slimLayout)
+            {
+                throw std::runtime_error(inputFile + " has another MVA tree layout than "
+                                         + inputFiles.back());
+            }
+            if (slimLayout)
+            {
+                payloadChain.Add(inputFile.c_str());
+            }
         }
 
-        if (!dataChain.AddFile(
-                (inputDir + chanMap.at(chan) + chan + "invLepmvaOut.root")
-                    .c_str()))
-            abort();
-
         auto outFile{
             new TFile{(outputDir + "histofile_" + outChan + ".root").c_str(),
                       "RECREATE"}};
@@ -502,7 +541,9 @@ void MakeMvaInputs::sameSignAnalysis(
                           ("Ttree_" + treeNamePostfixSB + outChan).c_str()};
             setupBranches(outTreeSdBnd);
         }
-        MvaEvent event{false, &dataChain, is2016};
+        std::unique_ptr<MvaEvent> event{
+            slimLayout ? new MvaEvent{false, &payloadChain, &dataChain, is2016}
+                       : new MvaEvent{false, &dataChain, is2016}};
 
         const long long numberOfEvents{dataChain.GetEntries()};
         TMVA::Timer lEventTimer{boost::numeric_cast<int>(numberOfEvents),
@@ -511,8 +552,8 @@ void MakeMvaInputs::sameSignAnalysis(
         for (long long i{0}; i < numberOfEvents; i++)
         {
             lEventTimer.DrawProgressBar(i);
-            event.GetEntry(i);
-            fillTree(outTreeSig, outTreeSdBnd, &event, outChan, chan, true);
+            event->GetEntry(i);
+            fillTree(outTreeSig, outTreeSdBnd, event.get(), outChan, chan, true);
         } // end event loop
 
         outFile->cd();
@@ -890,6 +931,7 @@ void MakeMvaInputs::setupBranches(TTree* tree)
     tree->Branch("zwj1DelR", &inputVars["zwj1DelR"], "zwj1DelR/F");
     tree->Branch("zwj2DelR", &inputVars["zwj2DelR"], "zwj2DelR/F");
     tree->Branch("zzDelR", &inputVars["zzDelR"], "zzDelR/F");
+    applyOutputPolicy(outputPolicy, tree);
 }
 
 void MakeMvaInputs::fillTree(TTree* outTreeSig,
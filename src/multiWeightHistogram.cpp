@@ -0,0 +1,104 @@
+#include "multiWeightHistogram.hpp"
+
+#include "TH1D.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+MultiWeightHistogram::MultiWeightHistogram(const TH1D& hist, const size_t channels)
+    : MultiWeightHistogram{AccumulatorAxis{*hist.GetXaxis()}, channels}
+{
+}
+
+MultiWeightHistogram::MultiWeightHistogram(const AccumulatorAxis& axis, const size_t channels)
+    : axis_{axis}
+    , channels_{channels}
+    , bins_{}
+    , moments_(channels, Moments{0., 0., 0., 0.})
+    , entries_{0}
+{
+    if (channels == 0)
+    {
+        throw std::logic_error("Multi-weight histogram without weight channels");
+    }
+}
+
+void MultiWeightHistogram::merge(const MultiWeightHistogram& other)
+{
+    if (!(axis_ == other.axis_) || channels_ != other.channels_)
+    {
+        throw std::logic_error("Merging multi-weight histograms with different binning");
+    }
+    if (other.empty())
+    {
+        return;
+    }
+    if (bins_.empty())
+    {
+        allocate();
+    }
+    for (size_t i{0}; i < bins_.size(); i++)
+    {
+        bins_[i].sumW += other.bins_[i].sumW;
+        bins_[i].sumW2 += other.bins_[i].sumW2;
+    }
+    for (size_t k{0}; k < channels_; k++)
+    {
+        moments_[k].sumW += other.moments_[k].sumW;
+        moments_[k].sumW2 += other.moments_[k].sumW2;
+        moments_[k].sumWX += other.moments_[k].sumWX;
+        moments_[k].sumWX2 += other.moments_[k].sumWX2;
+    }
+    entries_ += other.entries_;
+}
+
+void MultiWeightHistogram::addTo(TH1D& hist, const size_t channel) const
+{
+    if (!(AccumulatorAxis{*hist.GetXaxis()} == axis_) || channel >= channels_)
+    {
+        throw std::logic_error(std::string{"Multi-weight histogram doesn't match "} + hist.GetName());
+    }
+    if (empty())
+    {
+        return;
+    }
+
+    // As HistogramAccumulator::addTo
+    std::array<double, 13> stats{};
+    hist.GetStats(stats.data());
+    const double entries{hist.GetEntries()};
+
+    if (hist.GetSumw2N() == 0)
+    {
+        hist.Sumw2();
+    }
+    double* contents{hist.GetArray()};
+    double* sumW2{hist.GetSumw2()->GetArray()};
+    const size_t numBins{bins_.size() / channels_};
+    for (size_t i{0}; i < numBins; i++)
+    {
+        contents[i] += bins_[i * channels_ + channel].sumW;
+        sumW2[i] += bins_[i * channels_ + channel].sumW2;
+    }
+
+    stats[0] += moments_[channel].sumW;
+    stats[1] += moments_[channel].sumW2;
+    stats[2] += moments_[channel].sumWX;
+    stats[3] += moments_[channel].sumWX2;
+    hist.PutStats(stats.data());
+    hist.SetEntries(entries + static_cast<double>(entries_));
+}
+
+void MultiWeightHistogram::allocate()
+{
+    bins_.assign(static_cast<size_t>(axis_.nBins() + 2) * channels_, Bin{0., 0.});
+}
+
+void MultiWeightHistogram::reset()
+{
+    std::fill(bins_.begin(), bins_.end(), Bin{0., 0.});
+    std::fill(moments_.begin(), moments_.end(), Moments{0., 0., 0., 0.});
+    entries_ = 0;
+}
@@ -0,0 +1,43 @@
+#include "outputPolicy.hpp"
+
+#include "TBranch.h"
+#include "TObjArray.h"
+#include "TTree.h"
+
+#include <fnmatch.h>
+
+void applyOutputPolicy(const Parser::OutputPolicy& policy, TTree* tree)
+{
+    TObjArray* branches{tree->GetListOfBranches()};
+    for (int i{0}; i < branches->GetEntriesFast(); i++)
+    {
+        TBranch* branch{static_cast<TBranch*>(branches->At(i))};
+        int compression{policy.compression};
+        int basketSize{policy.basketSize};
+        for (const auto& rule : policy.rules)
+        {
+            if (fnmatch(rule.pattern.c_str(), branch->GetName(), 0) == 0)
+            {
+                // A rule leaves what it doesn't give to the policy's defaults
+                if (rule.compression >= 0)
+                {
+                    compression = rule.compression;
+                }
+                if (rule.basketSize > 0)
+                {
+                    basketSize = rule.basketSize;
+                }
+                break;
+            }
+        }
+        // The compression also applies to any sub-branches
+        if (compression >= 0)
+        {
+            branch->SetCompressionSettings(compression);
+        }
+        if (basketSize > 0)
+        {
+            branch->SetBasketSize(basketSize);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#include "pairVertex.hpp"
+
+#include "AnalysisEvent.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Built with -ftree-vectorize, see the makefile. The loop over the pairs is
+// kept free of branches so that it vectorises.
+namespace
+{
+struct VertexArrays
+{
+    const Float_t* vx;
+    const Float_t* vy;
+    const Float_t* vz;
+    const Float_t* px;
+    const Float_t* py;
+    const Float_t* pz;
+    const Float_t* cov00;
+    const Float_t* cov01;
+    const Float_t* cov02;
+    const Float_t* cov11;
+    const Float_t* cov12;
+    const Float_t* cov22;
+    const Float_t* chi2;
+    const Float_t* ndof;
+};
+
+struct PrimaryVertex
+{
+    float x;
+    float y;
+    float z;
+    float cov00;
+    float cov01;
+    float cov02;
+    float cov11;
+    float cov12;
+    float cov22;
+};
+
+PrimaryVertex leadingPrimaryVertex(const AnalysisEvent& event)
+{
+    if (event.numPVs < 1)
+    {
+        return {event.beamSpotX, event.beamSpotY, event.beamSpotZ, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+    }
+    return {event.pvX[0], event.pvY[0], event.pvZ[0], event.pvCov00[0], event.pvCov01[0], event.pvCov02[0], event.pvCov11[0], event.pvCov12[0], event.pvCov22[0]};
+}
+
+void computePairs(const VertexArrays& in, const size_t n, const PrimaryVertex& pv, PairVertices& out)
+{
+    out.resize(n);
+    float* distXY{out.distXY.data()};
+    float* sigXY{out.sigXY.data()};
+    float* distXYZ{out.distXYZ.data()};
+    float* sigXYZ{out.sigXYZ.data()};
+    float* chi2Ndof{out.chi2Ndof.data()};
+    float* cosXY{out.cosPointingXY.data()};
+    float* cosXYZ{out.cosPointingXYZ.data()};
+
+    const Float_t* vx{in.vx};
+    const Float_t* vy{in.vy};
+    const Float_t* vz{in.vz};
+    const Float_t* px{in.px};
+    const Float_t* py{in.py};
+    const Float_t* pz{in.pz};
+    const Float_t* cov00{in.cov00};
+    const Float_t* cov01{in.cov01};
+    const Float_t* cov02{in.cov02};
+    const Float_t* cov11{in.cov11};
+    const Float_t* cov12{in.cov12};
+    const Float_t* cov22{in.cov22};
+    const Float_t* chi2{in.chi2};
+    const Float_t* ndof{in.ndof};
+    const PrimaryVertex v{pv};
+
+    // The inputs are the event branches and the outputs our own vectors, so
+    // they never overlap
+#pragma GCC ivdep
+    for (size_t i{0}; i < n; i++)
+    {
+        const float dx{vx[i] - v.x};
+        const float dy{vy[i] - v.y};
+        const float dz{vz[i] - v.z};
+        const float c00{cov00[i] + v.cov00};
+        const float c01{cov01[i] + v.cov01};
+        const float c02{cov02[i] + v.cov02};
+        const float c11{cov11[i] + v.cov11};
+        const float c12{cov12[i] + v.cov12};
+        const float c22{cov22[i] + v.cov22};
+
+        // The variance of |d| is d^T C d / |d|^2, so the significance is
+        // |d|^2 / sqrt(d^T C d)
+        const float r2XY{dx * dx + dy * dy};
+        const float r2XYZ{r2XY + dz * dz};
+        const float varXY{dx * dx * c00 + 2.f * dx * dy * c01 + dy * dy * c11};
+        const float varXYZ{varXY + 2.f * dz * (dx * c02 + dy * c12) + dz * dz * c22};
+
+        distXY[i] = std::sqrt(r2XY);
+        distXYZ[i] = std::sqrt(r2XYZ);
+        sigXY[i] = varXY > 0.f ? r2XY / std::sqrt(varXY) : 0.f;
+        sigXYZ[i] = varXYZ > 0.f ? r2XYZ / std::sqrt(varXYZ) : 0.f;
+        chi2Ndof[i] = ndof[i] > 0.f ? chi2[i] / ndof[i] : -1.f;
+
+        const float p2XY{px[i] * px[i] + py[i] * py[i]};
+        const float p2XYZ{p2XY + pz[i] * pz[i]};
+        const float normXY{r2XY * p2XY};
+        const float normXYZ{r2XYZ * p2XYZ};
+        const float dotXY{dx * px[i] + dy * py[i]};
+        cosXY[i] = normXY > 0.f ? dotXY / std::sqrt(normXY) : 0.f;
+        cosXYZ[i] = normXYZ > 0.f ? (dotXY + dz * pz[i]) / std::sqrt(normXYZ) : 0.f;
+    }
+}
+} // namespace
+
+void PairVertices::resize(const size_t n)
+{
+    distXY.resize(n);
+    sigXY.resize(n);
+    distXYZ.resize(n);
+    sigXYZ.resize(n);
+    chi2Ndof.resize(n);
+    cosPointingXY.resize(n);
+    cosPointingXYZ.resize(n);
+}
+
+void PairVertex::compute(AnalysisEvent& event)
+{
+    const PrimaryVertex pv{leadingPrimaryVertex(event)};
+
+    const VertexArrays chs{event.chsTkPairTkVx, event.chsTkPairTkVy, event.chsTkPairTkVz, event.chsTkPairTkVtxPx, event.chsTkPairTkVtxPy, event.chsTkPairTkVtxPz, event.chsTkPairTkVtxCov00, event.chsTkPairTkVtxCov01, event.chsTkPairTkVtxCov02, event.chsTkPairTkVtxCov11, event.chsTkPairTkVtxCov12, event.chsTkPairTkVtxCov22, event.chsTkPairTkVtxChi2, event.chsTkPairTkVtxNdof};
+    computePairs(chs, static_cast<size_t>(std::max(event.numChsTrackPairs, 0)), pv, event.chsTkPairVertices);
+
+    const VertexArrays muons{event.muonTkPairPF2PATTkVx, event.muonTkPairPF2PATTkVy, event.muonTkPairPF2PATTkVz, event.muonTkPairPF2PATTkVtxPx, event.muonTkPairPF2PATTkVtxPy, event.muonTkPairPF2PATTkVtxPz, event.muonTkPairPF2PATTkVtxCov00, event.muonTkPairPF2PATTkVtxCov01, event.muonTkPairPF2PATTkVtxCov02, event.muonTkPairPF2PATTkVtxCov11, event.muonTkPairPF2PATTkVtxCov12, event.muonTkPairPF2PATTkVtxCov22, event.muonTkPairPF2PATTkVtxChi2, event.muonTkPairPF2PATTkVtxNdof};
+    computePairs(muons, static_cast<size_t>(std::max(event.numMuonTrackPairsPF2PAT, 0)), pv, event.muonTkPairVertices);
+}
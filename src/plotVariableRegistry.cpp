@@ -0,0 +1,60 @@
+#include "plotVariableRegistry.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+const PlotVariableRegistry& PlotVariableRegistry::instance()
+{
+    static const PlotVariableRegistry registry;
+    return registry;
+}
+
+PlotVariableRegistry::PlotVariableRegistry()
+{
+    for (const auto& definition : Plots::getScalarVariables())
+    {
+        variables_.push_back(Variable{definition.name, definition.dependencies, definition.fill, nullptr});
+    }
+    for (const auto& definition : Plots::getVectorVariables())
+    {
+        variables_.push_back(Variable{definition.name, definition.dependencies, nullptr, definition.fill});
+    }
+
+    // Sorted so that the IDs don't depend on the order of the definitions
+    std::sort(variables_.begin(), variables_.end(), [](const Variable& a, const Variable& b) {
+        return a.name < b.name;
+    });
+    for (unsigned i{0}; i < variables_.size(); i++)
+    {
+        if (!ids_.emplace(variables_[i].name, i).second)
+        {
+            throw std::logic_error("Plot variable defined twice: " + variables_[i].name);
+        }
+    }
+}
+
+unsigned PlotVariableRegistry::id(const std::string& fillExp) const
+{
+    const auto it{ids_.find(fillExp)};
+    if (it == ids_.end())
+    {
+        throw std::runtime_error("Unknown plot fillExp: " + fillExp);
+    }
+    return it->second;
+}
+
+void PlotVariableRegistry::check(const std::vector<std::string>& fillExps) const
+{
+    std::string unknown;
+    for (const auto& fillExp : fillExps)
+    {
+        if (ids_.find(fillExp) == ids_.end())
+        {
+            unknown += " " + fillExp;
+        }
+    }
+    if (!unknown.empty())
+    {
+        throw std::runtime_error("Unknown plot fillExp:" + unknown);
+    }
+}
@@ -1,33 +1,58 @@
 #include "TH1D.h"
 #include "TLorentzVector.h"
 #include "cutClass.hpp"
+#include "plotVariableRegistry.hpp"
 #include "plots.hpp"
 
 #include <boost/numeric/conversion/cast.hpp>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+// Returned by scalar plot variables with nothing to fill for the event
+constexpr float noValue{std::numeric_limits<float>::quiet_NaN()};
+
+// Dependencies of the plot variables
+constexpr unsigned Branches{DerivedCache::Branches};
+constexpr unsigned Leptons{DerivedCache::Leptons};
+constexpr unsigned Hadrons{DerivedCache::Hadrons};
+constexpr unsigned Jets{DerivedCache::Jets};
+
+// Refitted vertex quantity of the chosen pair, nothing if it has no vertex
+float pairVertexValue(const std::vector<float>& values, const int index)
+{
+    if (index < 0 || static_cast<size_t>(index) >= values.size())
+    {
+        return noValue;
+    }
+    return values[static_cast<size_t>(index)];
+}
+} // namespace
 
 Plots::Plots(const std::vector<std::string> titles, const std::vector<std::string> names, const std::vector<float> xMins, const std::vector<float> xMaxs, const std::vector<int> nBins, const std::vector<std::string> fillExps, const std::vector<std::string> xAxisLabels,
              const std::vector<int> cutStage, const unsigned thisCutStage,  const std::string postfixName) { // Get the function pointer map for later custopmisation. This is gonna be great, I promise.
-    const auto functionMap{getFncMap()};
+    const auto& registry{PlotVariableRegistry::instance()};
 
     plotPoint = std::vector<plot>(names.size());
+    binnings_.reserve(names.size());
+    bookedEmpty_ = 0;
     for (unsigned i{0}; i < names.size(); i++) {
         std::string plotName = names[i] + "_" + postfixName;
         plotPoint[i].name = plotName;
+        plotPoint[i].configName = names[i];
         plotPoint[i].title = titles[i];
-        plotPoint[i].fillExp = functionMap.at(fillExps[i]);
+        plotPoint[i].variable = registry.id(fillExps[i]);
         plotPoint[i].xAxisLabel = xAxisLabels[i];
-        plotPoint[i].plotHist =
-            new TH1D{plotName.c_str(),
-                     (plotName + ";" + plotPoint[i].xAxisLabel).c_str(),
-                     nBins[i],
-                     xMins[i],
-                     xMaxs[i]};
+        plotPoint[i].plotHist = nullptr;
+        binnings_.push_back({nBins[i], xMins[i], xMaxs[i]});
         plotPoint[i].fillPlot =
             boost::numeric_cast<unsigned>(cutStage[i]) <= thisCutStage;
     }
+    accumulators_ = newAccumulators();
 }
 
 Plots::~Plots()
@@ -36,17 +61,69 @@ Plots::~Plots()
         delete plotPoint[i].plotHist;
 }
 
-std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisEvent&)>> Plots::getFncMap() const {
+TH1D* Plots::histogram(const unsigned i)
+{
+    plot& point{plotPoint[i]};
+    if (!point.plotHist)
+    {
+        point.plotHist = new TH1D{point.name.c_str(),
+                                  (point.name + ";" + point.xAxisLabel).c_str(),
+                                  binnings_[i].nBins,
+                                  binnings_[i].min,
+                                  binnings_[i].max};
+        // Booked at any time, so keep it out of whichever file is open
+        point.plotHist->SetDirectory(nullptr);
+    }
+    return point.plotHist;
+}
+
+std::vector<plot> Plots::getPlotPoint()
+{
+    for (unsigned i{0}; i < plotPoint.size(); i++)
+    {
+        if (!plotPoint[i].plotHist)
+        {
+            histogram(i);
+            bookedEmpty_++;
+        }
+    }
+    return plotPoint;
+}
+
+Plots::MemoryUsage Plots::memoryUsage() const
+{
+    MemoryUsage usage{plotPoint.size(), 0, bookedEmpty_, 0, 0};
+    size_t booked{0};
+    for (unsigned i{0}; i < plotPoint.size(); i++)
+    {
+        // Contents and sum of weights squared, with under- and overflow
+        const size_t histBytes{sizeof(TH1D) + 2 * sizeof(double) * static_cast<size_t>(binnings_[i].nBins + 2)};
+        const size_t accumulatorBytes{accumulators_[i].bytes() + (i < multiWeight_.size() ? multiWeight_[i].bytes() : 0)};
+        usage.bytes += accumulatorBytes;
+        if (plotPoint[i].plotHist)
+        {
+            usage.bytes += histBytes;
+            booked++;
+        }
+        usage.eagerBytes += histBytes
+                            + 2 * sizeof(double) * static_cast<size_t>(binnings_[i].nBins + 2)
+                                  * (1 + (i < multiWeight_.size() ? multiWeight_[i].channels() : 0));
+    }
+    usage.filled = booked - bookedEmpty_;
+    return usage;
+}
+
+std::vector<Plots::VariableDef<Plots::ScalarFill>> Plots::getScalarVariables() {
     return {
-        {"lep1Pt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1Pt", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
                  TLorentzVector tempVec{
                      event.elePF2PATPX[event.electronIndexTight[0]],
                      event.elePF2PATPY[event.electronIndexTight[0]],
                      event.elePF2PATPZ[event.electronIndexTight[0]],
                      event.elePF2PATE[event.electronIndexTight[0]]};
-                 return {tempVec.Pt()};
+                 return tempVec.Pt();
              }
              else {
                  TLorentzVector tempVec{
@@ -55,13 +132,13 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.muonPF2PATPZ[event.muonIndexTight[0]],
                      event.muonPF2PATE[event.muonIndexTight[0]]};
 //                 tempVec *= event.muonMomentumSF[0];
-                 return {tempVec.Pt()};
+                 return tempVec.Pt();
              }
          }},
-        {"lep1Eta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1Eta", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
-                 return {std::abs(event.elePF2PATSCEta[event.electronIndexTight[0]])};
+                 return std::abs(event.elePF2PATSCEta[event.electronIndexTight[0]]);
              }
              else {
                  TLorentzVector tempVec{
@@ -70,18 +147,18 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.muonPF2PATPZ[event.muonIndexTight[0]],
                      event.muonPF2PATE[event.muonIndexTight[0]]};
 //                 tempVec *= event.muonMomentumSF[0];
-                 return {tempVec.Eta()};
+                 return tempVec.Eta();
              }
          }},
-        {"lep2Pt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2Pt", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
                  TLorentzVector tempVec{
                      event.elePF2PATPX[event.electronIndexTight[1]],
                      event.elePF2PATPY[event.electronIndexTight[1]],
                      event.elePF2PATPZ[event.electronIndexTight[1]],
                      event.elePF2PATE[event.electronIndexTight[1]]};
-                 return {tempVec.Pt()};
+                 return tempVec.Pt();
              }
              else {
                  TLorentzVector tempVec{
@@ -90,14 +167,14 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.muonPF2PATPZ[event.muonIndexTight[1]],
                      event.muonPF2PATE[event.muonIndexTight[1]]};
 //                 tempVec *= event.muonMomentumSF[1];
-                 return {tempVec.Pt()};
+                 return tempVec.Pt();
              }
          }},
-        {"lep2Eta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2Eta", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
-                 return {std::abs(
-                     event.elePF2PATSCEta[event.electronIndexTight[1]])};
+                 return std::abs(
+                     event.elePF2PATSCEta[event.electronIndexTight[1]]);
              }
              else {
                  TLorentzVector tempVec{
@@ -106,35 +183,31 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.muonPF2PATPZ[event.muonIndexTight[1]],
                      event.muonPF2PATE[event.muonIndexTight[1]]};
 //                 tempVec *= event.muonMomentumSF[1];
-                 return {tempVec.Eta()};
+                 return tempVec.Eta();
              }
          }},
-        {"lep1RelIso",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1RelIso", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
-                 return {
-                     event.elePF2PATComRelIsoRho[event.electronIndexTight[0]]};
+                 return event.elePF2PATComRelIsoRho[event.electronIndexTight[0]];
              }
              else {
-                 return {
-                     event.muonPF2PATComRelIsodBeta[event.muonIndexTight[0]]};
+                 return event.muonPF2PATComRelIsodBeta[event.muonIndexTight[0]];
              }
          }},
-        {"lep2RelIso",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2RelIso", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
-                 return {
-                     event.elePF2PATComRelIsoRho[event.electronIndexTight[1]]};
+                 return event.elePF2PATComRelIsoRho[event.electronIndexTight[1]];
              }
              else {
-                 return {
-                     event.muonPF2PATComRelIsodBeta[event.muonIndexTight[1]]};
+                 return event.muonPF2PATComRelIsodBeta[event.muonIndexTight[1]];
              }
          }},
-        {"lep1Phi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1Phi", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
-                 return {event.elePF2PATPhi[event.electronIndexTight[0]]};
+                 return event.elePF2PATPhi[event.electronIndexTight[0]];
              }
              else {
                  TLorentzVector tempVec{
@@ -143,13 +216,13 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.muonPF2PATPZ[event.muonIndexTight[0]],
                      event.muonPF2PATE[event.muonIndexTight[0]]};
 //                 tempVec *= event.muonMomentumSF[0];
-                 return {tempVec.Phi()};
+                 return tempVec.Phi();
              }
          }},
-        {"lep2Phi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2Phi", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1) {
-                 return {event.elePF2PATPhi[event.electronIndexTight[1]]};
+                 return event.elePF2PATPhi[event.electronIndexTight[1]];
              }
              else {
                  TLorentzVector tempVec{
@@ -158,61 +231,61 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.muonPF2PATPZ[event.muonIndexTight[1]],
                      event.muonPF2PATE[event.muonIndexTight[1]]};
 //                 tempVec *= event.muonMomentumSF[1];
-                 return {tempVec.Phi()};
+                 return tempVec.Phi();
              }
          }},
-        {"wQuark1Pt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.wPairQuarks.first.Pt()};
+        {"wQuark1Pt", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.wPairQuarks.first.Pt();
          }},
-        {"wQuark1Eta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.wPairQuarks.first.Eta()};
+        {"wQuark1Eta", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.wPairQuarks.first.Eta();
          }},
-        {"wQuark1Phi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.wPairQuarks.first.Phi()};
+        {"wQuark1Phi", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.wPairQuarks.first.Phi();
          }},
-        {"wQuark2Pt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.wPairQuarks.second.Pt()};
+        {"wQuark2Pt", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.wPairQuarks.second.Pt();
          }},
-        {"wQuark2Eta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs(event.wPairQuarks.second.Eta())};
+        {"wQuark2Eta", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return std::abs(event.wPairQuarks.second.Eta());
          }},
-        {"wQuark2Phi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.wPairQuarks.second.Phi()};
+        {"wQuark2Phi", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.wPairQuarks.second.Phi();
          }},
-        {"chs1TrkPt", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVec.first.Pt()};
+        {"chs1TrkPt", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVec.first.Pt();
          }},
-        {"chs1TrkEta", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs(event.chsPairVec.first.Eta())};
+        {"chs1TrkEta", Hadrons, [](const AnalysisEvent& event) -> float {
+             return std::abs(event.chsPairVec.first.Eta());
          }},
-        {"chs1TrkPhi", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVec.first.Phi()};
+        {"chs1TrkPhi", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVec.first.Phi();
          }},
-        {"chs2TrkPt", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVec.second.Pt()};
+        {"chs2TrkPt", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVec.second.Pt();
          }},
-        {"chs2TrkEta", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs(event.chsPairVec.second.Eta())};
+        {"chs2TrkEta", Hadrons, [](const AnalysisEvent& event) -> float {
+             return std::abs(event.chsPairVec.second.Eta());
          }},
-        {"chs2TrkPhi", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVec.second.Phi()};
+        {"chs2TrkPhi", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVec.second.Phi();
          }},
-        {"met",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.metPF2PATEt};
+        {"met", Branches,
+         [](const AnalysisEvent& event) -> float {
+             return event.metPF2PATEt;
          }},
-        {"numbJets",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.jetIndex.size()};
+        {"numbJets", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.jetIndex.size();
          }},
-        {"totalJetMass",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totalJetMass", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector totalJet;
              if (event.jetIndex.size() > 0)
              {
@@ -229,15 +302,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      tempJet *= smearValue;
                      totalJet += tempJet;
                  }
-                 return {totalJet.M()};
+                 return totalJet.M();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"totalJetPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totalJetPt", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector totalJet;
              if (event.jetIndex.size() > 0)
              {
@@ -254,15 +327,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      tempJet *= smearValue;
                      totalJet += tempJet;
                  }
-                 return {totalJet.Pt()};
+                 return totalJet.Pt();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"totalJetEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totalJetEta", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector totalJet;
              if (event.jetIndex.size() > 0)
              {
@@ -279,15 +352,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      tempJet *= smearValue;
                      totalJet += tempJet;
                  }
-                 return {totalJet.Eta()};
+                 return totalJet.Eta();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"totalJetPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totalJetPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector totalJet;
              if (event.jetIndex.size() > 0)
              {
@@ -304,15 +377,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      tempJet *= smearValue;
                      totalJet += tempJet;
                  }
-                 return {totalJet.Phi()};
+                 return totalJet.Phi();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"leadingJetPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"leadingJetPt", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 0)
              {
                  TLorentzVector tempJet;
@@ -322,15 +395,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[0]],
                                     event.jetPF2PATE[event.jetIndex[0]]);
                  tempJet *= smearValue;
-                 return {tempJet.Pt()};
+                 return tempJet.Pt();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"leadingJetEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"leadingJetEta", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 0)
              {
                  TLorentzVector tempJet;
@@ -340,15 +413,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[0]],
                                     event.jetPF2PATE[event.jetIndex[0]]);
                  tempJet *= smearValue;
-                 return {tempJet.Eta()};
+                 return tempJet.Eta();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"leadingJetPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"leadingJetPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 0)
              {
                  TLorentzVector tempJet;
@@ -358,15 +431,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[0]],
                                     event.jetPF2PATE[event.jetIndex[0]]);
                  tempJet *= smearValue;
-                 return {tempJet.Phi()};
+                 return tempJet.Phi();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"leadingJetDeltaRLep",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"leadingJetDeltaRLep", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 0)
              {
                  TLorentzVector tempJet;
@@ -376,35 +449,34 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[0]],
                                     event.jetPF2PATE[event.jetIndex[0]]);
                  tempJet *= smearValue;
-                 return {std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
+                 return std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
                                                event.zPairLeptons.first.Phi(),
                                                tempJet.Eta(),
                                                tempJet.Phi()),
                                   Cuts::deltaR(event.zPairLeptons.second.Eta(),
                                                event.zPairLeptons.second.Phi(),
                                                tempJet.Eta(),
-                                               tempJet.Phi()))};
+                                               tempJet.Phi()));
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"leadingJetBDisc",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"leadingJetBDisc", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 0)
              {
-                 return {
-                     event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
-                         [event.jetIndex[0]]};
+                 return event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
+                         [event.jetIndex[0]];
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"secondJetPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"secondJetPt", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 1)
              {
                  TLorentzVector tempJet;
@@ -414,15 +486,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[1]],
                                     event.jetPF2PATE[event.jetIndex[1]]);
                  tempJet *= smearValue;
-                 return {tempJet.Pt()};
+                 return tempJet.Pt();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"secondJetEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"secondJetEta", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 1)
              {
                  TLorentzVector tempJet;
@@ -432,15 +504,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[1]],
                                     event.jetPF2PATE[event.jetIndex[1]]);
                  tempJet *= smearValue;
-                 return {tempJet.Eta()};
+                 return tempJet.Eta();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"secondJetPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"secondJetPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 1)
              {
                  TLorentzVector tempJet;
@@ -450,28 +522,27 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[1]],
                                     event.jetPF2PATE[event.jetIndex[1]]);
                  tempJet *= smearValue;
-                 return {tempJet.Phi()};
+                 return tempJet.Phi();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"secondJetBDisc",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"secondJetBDisc", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 1)
              {
-                 return {
-                     event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
-                         [event.jetIndex[1]]};
+                 return event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
+                         [event.jetIndex[1]];
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"secondJetDeltaRLep",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"secondJetDeltaRLep", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 1)
              {
                  TLorentzVector tempJet;
@@ -481,22 +552,22 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[1]],
                                     event.jetPF2PATE[event.jetIndex[1]]);
                  tempJet *= smearValue;
-                 return {std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
+                 return std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
                                                event.zPairLeptons.first.Phi(),
                                                tempJet.Eta(),
                                                tempJet.Phi()),
                                   Cuts::deltaR(event.zPairLeptons.second.Eta(),
                                                event.zPairLeptons.second.Phi(),
                                                tempJet.Eta(),
-                                               tempJet.Phi()))};
+                                               tempJet.Phi()));
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"thirdJetPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"thirdJetPt", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 2)
              {
                  TLorentzVector tempJet;
@@ -506,15 +577,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[2]],
                                     event.jetPF2PATE[event.jetIndex[2]]);
                  tempJet *= smearValue;
-                 return {tempJet.Pt()};
+                 return tempJet.Pt();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"thirdJetEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"thirdJetEta", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 2)
              {
                  TLorentzVector tempJet;
@@ -524,15 +595,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[2]],
                                     event.jetPF2PATE[event.jetIndex[2]]);
                  tempJet *= smearValue;
-                 return {tempJet.Eta()};
+                 return tempJet.Eta();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"thirdJetPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"thirdJetPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 2)
              {
                  TLorentzVector tempJet;
@@ -542,28 +613,27 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[2]],
                                     event.jetPF2PATE[event.jetIndex[2]]);
                  tempJet *= smearValue;
-                 return {tempJet.Phi()};
+                 return tempJet.Phi();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"thirdJetBDisc",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"thirdJetBDisc", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 2)
              {
-                 return {
-                     event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
-                         [event.jetIndex[2]]};
+                 return event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
+                         [event.jetIndex[2]];
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"thirdJetDeltaRLep",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"thirdJetDeltaRLep", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 2)
              {
                  TLorentzVector tempJet;
@@ -573,22 +643,22 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[2]],
                                     event.jetPF2PATE[event.jetIndex[2]]);
                  tempJet *= smearValue;
-                 return {std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
+                 return std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
                                                event.zPairLeptons.first.Phi(),
                                                tempJet.Eta(),
                                                tempJet.Phi()),
                                   Cuts::deltaR(event.zPairLeptons.second.Eta(),
                                                event.zPairLeptons.second.Phi(),
                                                tempJet.Eta(),
-                                               tempJet.Phi()))};
+                                               tempJet.Phi()));
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"fourthJetPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"fourthJetPt", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 3)
              {
                  TLorentzVector tempJet;
@@ -598,15 +668,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[3]],
                                     event.jetPF2PATE[event.jetIndex[3]]);
                  tempJet *= smearValue;
-                 return {tempJet.Pt()};
+                 return tempJet.Pt();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"fourthJetEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"fourthJetEta", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 3)
              {
                  TLorentzVector tempJet;
@@ -616,15 +686,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[3]],
                                     event.jetPF2PATE[event.jetIndex[3]]);
                  tempJet *= smearValue;
-                 return {tempJet.Eta()};
+                 return tempJet.Eta();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"fourthJetPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"fourthJetPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 3)
              {
                  TLorentzVector tempJet;
@@ -634,28 +704,27 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[3]],
                                     event.jetPF2PATE[event.jetIndex[3]]);
                  tempJet *= smearValue;
-                 return {tempJet.Phi()};
+                 return tempJet.Phi();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"fourthJetBDisc",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"fourthJetBDisc", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 3)
              {
-                 return {
-                     event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
-                         [event.jetIndex[3]]};
+                 return event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
+                         [event.jetIndex[3]];
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"fourthJetDeltaRLep",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"fourthJetDeltaRLep", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() > 1)
              {
                  TLorentzVector tempJet;
@@ -665,254 +734,250 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                     event.jetPF2PATPz[event.jetIndex[1]],
                                     event.jetPF2PATE[event.jetIndex[1]]);
                  tempJet *= smearValue;
-                 return {std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
+                 return std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
                                                event.zPairLeptons.first.Phi(),
                                                tempJet.Eta(),
                                                tempJet.Phi()),
                                   Cuts::deltaR(event.zPairLeptons.second.Eta(),
                                                event.zPairLeptons.second.Phi(),
                                                tempJet.Eta(),
-                                               tempJet.Phi()))};
+                                               tempJet.Phi()));
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"numbBJets",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.bTagIndex.size()};
+        {"numbBJets", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.bTagIndex.size();
          }},
-        {"bTagDisc",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"bTagDisc", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() > 0)
              {
-                 return {
-                     event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
-                         [event.jetIndex[event.bTagIndex[0]]]};
+                 return event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
+                         [event.jetIndex[event.bTagIndex[0]]];
              }
-             return {};
+             return noValue;
          }},
-        {"zLepton1Pt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairLeptons.first.Pt()};
+        {"zLepton1Pt", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.Pt();
          }},
-        {"zLepton1Eta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs(event.zPairLeptons.first.Eta())};
+        {"zLepton1Eta", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return std::abs(event.zPairLeptons.first.Eta());
          }},
-        {"zLepton2Pt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairLeptons.second.Pt()};
+        {"zLepton2Pt", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.second.Pt();
          }},
-        {"zLepton2Eta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs(event.zPairLeptons.second.Eta())};
+        {"zLepton2Eta", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return std::abs(event.zPairLeptons.second.Eta());
          }},
-        {"zLepton1RelIso",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairRelIso.first};
+        {"zLepton1RelIso", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairRelIso.first;
          }},
-        {"zLepton2RelIso",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairRelIso.second};
+        {"zLepton2RelIso", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairRelIso.second;
          }},
-        {"zLepton1Phi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairLeptons.first.Phi()};
+        {"zLepton1Phi", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.Phi();
          }},
-        {"zLepton2Phi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairLeptons.second.Phi()};
+        {"zLepton2Phi", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.second.Phi();
          }},
-        {"zPairMass",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 (event.zPairLeptons.first + event.zPairLeptons.second).M()};
+        {"zPairMass", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).M();
          }},
-        {"zPairPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 (event.zPairLeptons.first + event.zPairLeptons.second).Pt()};
+        {"zPairPt", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).Pt();
          }},
-        {"zPairEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs(
-                 (event.zPairLeptons.first + event.zPairLeptons.second).Eta())};
+        {"zPairEta", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return std::abs(
+                 (event.zPairLeptons.first + event.zPairLeptons.second).Eta());
          }},
-        {"zPairPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.zPairLeptons.first + event.zPairLeptons.second).Phi()};
+        {"zPairPhi", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).Phi();
          }},
-        {"zPairMassRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-                 return { (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).M() };
+        {"zPairMassRefit", Leptons,
+         [](const AnalysisEvent& event) -> float {
+                 return (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).M();
          }},
-        {"zPairPtRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-                 return { (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).Pt() };
+        {"zPairPtRefit", Leptons,
+         [](const AnalysisEvent& event) -> float {
+                 return (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).Pt();
          }},
-        {"zPairEtaRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-                 return { (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).Eta() };
+        {"zPairEtaRefit", Leptons,
+         [](const AnalysisEvent& event) -> float {
+                 return (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).Eta();
          }},
-        {"zPairPhiRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-                 return { (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).Phi() };
+        {"zPairPhiRefit", Leptons,
+         [](const AnalysisEvent& event) -> float {
+                 return (event.zPairLeptonsRefitted.first+event.zPairLeptonsRefitted.second).Phi();
          }},
-	{"chsPairMass",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.chsPairVec.first + event.chsPairVec.second).M()};
+        {"chsPairMass", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.chsPairVec.first + event.chsPairVec.second).M();
          }},
-	{"chsPairPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.chsPairVec.first + event.chsPairVec.second).Pt()};
+        {"chsPairPt", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.chsPairVec.first + event.chsPairVec.second).Pt();
          }},
-	{"chsPairEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs((event.chsPairVec.first + event.chsPairVec.second).Eta())};
+        {"chsPairEta", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return std::abs((event.chsPairVec.first + event.chsPairVec.second).Eta());
          }},
-	{"chsPairPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.chsPairVec.first + event.chsPairVec.second).Phi()};
+        {"chsPairPhi", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.chsPairVec.first + event.chsPairVec.second).Phi();
          }},
-        {"chsPairDeltaR", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVec.first.DeltaR(event.chsPairVec.second)};
+        {"chsPairDeltaR", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVec.first.DeltaR(event.chsPairVec.second);
          }},
-        {"chsPairDeltaPhi", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVec.first.DeltaPhi(event.chsPairVec.second)};
+        {"chsPairDeltaPhi", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVec.first.DeltaPhi(event.chsPairVec.second);
          }},
-        {"chsPairDeltaZ", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVec.first.Z() - event.chsPairVec.second.Z()};
+        {"chsPairDeltaZ", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVec.first.Z() - event.chsPairVec.second.Z();
          }},
-	{"chsPairMassRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M()};
+        {"chsPairMassRefit", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M();
          }},
-	{"chsPairPtRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Pt()};
+        {"chsPairPtRefit", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Pt();
          }},
-	{"chsPairEtaRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::abs((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Eta())};
+        {"chsPairEtaRefit", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return std::abs((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Eta());
          }},
-	{"chsPairPhiRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Phi()};
+        {"chsPairPhiRefit", Hadrons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Phi();
          }},
-        {"chsPairDeltaRRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVecRefitted.first.DeltaR(event.chsPairVecRefitted.second)};
+        {"chsPairDeltaRRefit", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVecRefitted.first.DeltaR(event.chsPairVecRefitted.second);
          }},
-        {"chsPairDeltaPhiRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVecRefitted.first.DeltaPhi(event.chsPairVecRefitted.second)};
+        {"chsPairDeltaPhiRefit", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVecRefitted.first.DeltaPhi(event.chsPairVecRefitted.second);
          }},
-        {"chsPairDeltaZRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.chsPairVecRefitted.first.Z() - event.chsPairVecRefitted.second.Z()};
+        {"chsPairDeltaZRefit", Hadrons, [](const AnalysisEvent& event) -> float {
+             return event.chsPairVecRefitted.first.Z() - event.chsPairVecRefitted.second.Z();
          }},
-        {"wPairMass", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.wPairQuarks.first + event.wPairQuarks.second).M()};
+        {"wPairMass", Jets, [](const AnalysisEvent& event) -> float {
+             return (event.wPairQuarks.first + event.wPairQuarks.second).M();
          }},
-        {"discalarMass", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).M() };
+        {"discalarMass", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).M();
          }},
-        {"discalarMassNew", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"discalarMassNew", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
              TLorentzVector mu1, mu2;
              int idx1 {event.muonPF2PATPackedCandIndex[event.zPairIndex.first]};
              int idx2 {event.muonPF2PATPackedCandIndex[event.zPairIndex.second]};
              mu1.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx1], event.packedCandsPseudoTrkPy[idx1], event.packedCandsPseudoTrkPz[idx1], event.packedCandsE[idx1]);
              mu2.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx2], event.packedCandsPseudoTrkPy[idx2], event.packedCandsPseudoTrkPz[idx2], event.packedCandsE[idx2]);
-             return { (mu1+mu2 + event.chsPairVec.first + event.chsPairVec.second).M() };
-//             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).M() };
+             return (mu1+mu2 + event.chsPairVec.first + event.chsPairVec.second).M();
+//             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).M();
          }},
-        {"discalarDeltaMass", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).M() - (event.chsPairVec.first + event.chsPairVec.second).M() };
+        {"discalarDeltaMass", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).M() - (event.chsPairVec.first + event.chsPairVec.second).M();
          }},
-        {"discalarDeltaMassNew", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"discalarDeltaMassNew", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
              TLorentzVector mu1, mu2;
              int idx1 {event.muonPF2PATPackedCandIndex[event.zPairIndex.first]};
              int idx2 {event.muonPF2PATPackedCandIndex[event.zPairIndex.second]};
              mu1.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx1], event.packedCandsPseudoTrkPy[idx1], event.packedCandsPseudoTrkPz[idx1], event.packedCandsE[idx1]);
              mu2.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx2], event.packedCandsPseudoTrkPy[idx2], event.packedCandsPseudoTrkPz[idx2], event.packedCandsE[idx2]);
-             return { (mu1 + mu2).M() - (event.chsPairVec.first + event.chsPairVec.second).M() };
+             return (mu1 + mu2).M() - (event.chsPairVec.first + event.chsPairVec.second).M();
          }},
-        {"discalarPt", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).Pt() };
+        {"discalarPt", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).Pt();
          }},
-        {"discalarEta", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).Eta() };
+        {"discalarEta", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).Eta();
          }},
-        {"discalarPhi", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).Phi() };
+        {"discalarPhi", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVec.first + event.chsPairVec.second).Phi();
          }},
-        {"discalarDeltaR", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).DeltaR((event.chsPairVec.first + event.chsPairVec.second)) };
+        {"discalarDeltaR", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).DeltaR((event.chsPairVec.first + event.chsPairVec.second));
          }},
-        {"discalarDeltaRNew", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"discalarDeltaRNew", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
              TLorentzVector mu1, mu2;
              int idx1 {event.muonPF2PATPackedCandIndex[event.zPairIndex.first]};
              int idx2 {event.muonPF2PATPackedCandIndex[event.zPairIndex.second]};
              mu1.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx1], event.packedCandsPseudoTrkPy[idx1], event.packedCandsPseudoTrkPz[idx1], event.packedCandsE[idx1]);
              mu2.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx2], event.packedCandsPseudoTrkPy[idx2], event.packedCandsPseudoTrkPz[idx2], event.packedCandsE[idx2]);
-             return { (mu1+mu2).DeltaR((event.chsPairVec.first + event.chsPairVec.second)) };
+             return (mu1+mu2).DeltaR((event.chsPairVec.first + event.chsPairVec.second));
          }},
-        {"discalarDeltaPhi", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).DeltaPhi((event.chsPairVec.first + event.chsPairVec.second)) };
+        {"discalarDeltaPhi", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).DeltaPhi((event.chsPairVec.first + event.chsPairVec.second));
          }},
-        {"discalarDeltaZ", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).Z() - (event.chsPairVec.first + event.chsPairVec.second).Z() };
+        {"discalarDeltaZ", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).Z() - (event.chsPairVec.first + event.chsPairVec.second).Z();
          }},
-        {"discalarMassRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M() };
+        {"discalarMassRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M();
          }},
-        {"discalarMassRefitNew", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"discalarMassRefitNew", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
              TLorentzVector mu1, mu2;
              int idx1 {event.muonPF2PATPackedCandIndex[event.zPairIndex.first]};
              int idx2 {event.muonPF2PATPackedCandIndex[event.zPairIndex.second]};
              mu1.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx1], event.packedCandsPseudoTrkPy[idx1], event.packedCandsPseudoTrkPz[idx1], event.packedCandsE[idx1]);
              mu2.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx2], event.packedCandsPseudoTrkPy[idx2], event.packedCandsPseudoTrkPz[idx2], event.packedCandsE[idx2]);
-             return { (mu1+mu2 + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M() };
+             return (mu1+mu2 + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M();
          }},
-        {"discalarDeltaMassRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).M() - (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M() };
+        {"discalarDeltaMassRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).M() - (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M();
          }},
-        {"discalarDeltaMassRefitNew", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"discalarDeltaMassRefitNew", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
              TLorentzVector mu1, mu2;
              int idx1 {event.muonPF2PATPackedCandIndex[event.zPairIndex.first]};
              int idx2 {event.muonPF2PATPackedCandIndex[event.zPairIndex.second]};
              mu1.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx1], event.packedCandsPseudoTrkPy[idx1], event.packedCandsPseudoTrkPz[idx1], event.packedCandsE[idx1]);
              mu2.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx2], event.packedCandsPseudoTrkPy[idx2], event.packedCandsPseudoTrkPz[idx2], event.packedCandsE[idx2]);
-             return { (mu1+mu2).M() - (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M() };
+             return (mu1+mu2).M() - (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).M();
          }},
-        {"discalarPtRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Pt() };
+        {"discalarPtRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Pt();
          }},
-        {"discalarEtaRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Eta() };
+        {"discalarEtaRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Eta();
          }},
-        {"discalarPhiRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Phi() };
+        {"discalarPhiRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second + event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Phi();
          }},
-        {"discalarDeltaRRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).DeltaR((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second)) };
+        {"discalarDeltaRRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).DeltaR((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second));
          }},
-        {"discalarDeltaRRefitNew", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"discalarDeltaRRefitNew", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
              TLorentzVector mu1, mu2;
              int idx1 {event.muonPF2PATPackedCandIndex[event.zPairIndex.first]};
              int idx2 {event.muonPF2PATPackedCandIndex[event.zPairIndex.second]};
              mu1.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx1], event.packedCandsPseudoTrkPy[idx1], event.packedCandsPseudoTrkPz[idx1], event.packedCandsE[idx1]);
              mu2.SetPxPyPzE(event.packedCandsPseudoTrkPx[idx2], event.packedCandsPseudoTrkPy[idx2], event.packedCandsPseudoTrkPz[idx2], event.packedCandsE[idx2]);
-             return { (mu1+mu2).DeltaR((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second)) };
+             return (mu1+mu2).DeltaR((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second));
          }},
-        {"discalarDeltaPhiRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).DeltaPhi((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second)) };
+        {"discalarDeltaPhiRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).DeltaPhi((event.chsPairVecRefitted.first + event.chsPairVecRefitted.second));
          }},
-        {"discalarDeltaZRefit", [](const AnalysisEvent& event) -> std::vector<float> {
-             return { (event.zPairLeptons.first + event.zPairLeptons.second).Z() - (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Z() };
+        {"discalarDeltaZRefit", Leptons | Hadrons, [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).Z() - (event.chsPairVecRefitted.first + event.chsPairVecRefitted.second).Z();
          }},
-
-        {"topMass",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"topMass", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() > 0)
              {
                  TLorentzVector tempBjet;
@@ -923,17 +988,17 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                      event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
                  tempBjet *= smearValue;
-                 return {(tempBjet + event.wPairQuarks.first
+                 return (tempBjet + event.wPairQuarks.first
                           + event.wPairQuarks.second)
-                             .M()};
+                             .M();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"topPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"topPt", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() > 0)
              {
                  TLorentzVector tempBjet;
@@ -944,17 +1009,17 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                      event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
                  tempBjet *= smearValue;
-                 return {(tempBjet + event.wPairQuarks.first
+                 return (tempBjet + event.wPairQuarks.first
                           + event.wPairQuarks.second)
-                             .Pt()};
+                             .Pt();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"topEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"topEta", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() > 0)
              {
                  TLorentzVector tempBjet;
@@ -965,17 +1030,17 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                      event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
                  tempBjet *= smearValue;
-                 return {std::abs((tempBjet + event.wPairQuarks.first
+                 return std::abs((tempBjet + event.wPairQuarks.first
                                    + event.wPairQuarks.second)
-                                      .Eta())};
+                                      .Eta());
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"topPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"topPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() > 0)
              {
                  TLorentzVector tempBjet;
@@ -986,191 +1051,188 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                      event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
                  tempBjet *= smearValue;
-                 return {(tempBjet + event.wPairQuarks.first
+                 return (tempBjet + event.wPairQuarks.first
                           + event.wPairQuarks.second)
-                             .Phi()};
+                             .Phi();
              }
              else
              {
-                 return {};
+                 return noValue;
              }
          }},
-        {"lep1D0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1D0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATD0PV[event.electronIndexTight[0]]};
+                 return event.elePF2PATD0PV[event.electronIndexTight[0]];
              }
              else
              {
-              	 return {event.muonPF2PATDBPV[event.muonIndexTight[0]]};
+              	 return event.muonPF2PATDBPV[event.muonIndexTight[0]];
              }
          }},
-        {"lep1D0Sig",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1D0Sig", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATImpactTransSignificance[event.electronIndexTight[0]]};
+                 return event.elePF2PATImpactTransSignificance[event.electronIndexTight[0]];
              }
              else
              {
-                 return { (std::abs(event.muonPF2PATDBPV[event.muonIndexTight[0]]))/(event.muonPF2PATDBPVError[event.muonIndexTight[0]] + 1.0e-06) };
+                 return (std::abs(event.muonPF2PATDBPV[event.muonIndexTight[0]]))/(event.muonPF2PATDBPVError[event.muonIndexTight[0]] + 1.0e-06);
              }
          }},
-        {"lep2D0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2D0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATD0PV[event.electronIndexTight[1]]};
+                 return event.elePF2PATD0PV[event.electronIndexTight[1]];
              }
              else
              {
-                 return {event.muonPF2PATDBPV[event.muonIndexTight[1]]};
+                 return event.muonPF2PATDBPV[event.muonIndexTight[1]];
              }
          }},
-        {"lep2D0Sig",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2D0Sig", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATImpactTransSignificance[event.electronIndexTight[1]]};
+                 return event.elePF2PATImpactTransSignificance[event.electronIndexTight[1]];
              }
              else
              {
-              	 return { (std::abs(event.muonPF2PATDBPV[event.muonIndexTight[1]]))/(event.muonPF2PATDBPVError[event.muonIndexTight[1]] + 1.0e-06) };
+              	 return (std::abs(event.muonPF2PATDBPV[event.muonIndexTight[1]]))/(event.muonPF2PATDBPVError[event.muonIndexTight[1]] + 1.0e-06);
              }
          }},
-        {"lep1DZ",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1DZ", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATDZPV[event.electronIndexTight[0]]};
+                 return event.elePF2PATDZPV[event.electronIndexTight[0]];
              }
              else
              {
-                 return {event.muonPF2PATDZPV[event.muonIndexTight[0]]};
+                 return event.muonPF2PATDZPV[event.muonIndexTight[0]];
              }
          }},
-        {"lep1DZSig",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1DZSig", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATImpact3DSignificance[event.electronIndexTight[0]]};
+                 return event.elePF2PATImpact3DSignificance[event.electronIndexTight[0]];
              }
              else
              {
-              	 return { (std::abs(event.muonPF2PATDZPV[event.muonIndexTight[0]]))/(event.muonPF2PATDZPVError[event.muonIndexTight[0]] + 1.0e-06) };
+              	 return (std::abs(event.muonPF2PATDZPV[event.muonIndexTight[0]]))/(event.muonPF2PATDZPVError[event.muonIndexTight[0]] + 1.0e-06);
              }
          }},
-        {"lep2DZ",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2DZ", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATDZPV[event.electronIndexTight[1]]};
+                 return event.elePF2PATDZPV[event.electronIndexTight[1]];
              }
              else
              {
-                 return {event.muonPF2PATDZPV[event.muonIndexTight[1]]};
+                 return event.muonPF2PATDZPV[event.muonIndexTight[1]];
              }
          }},
-        {"lep2DZSig",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2DZSig", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATImpact3DSignificance[event.electronIndexTight[1]]};
+                 return event.elePF2PATImpact3DSignificance[event.electronIndexTight[1]];
              }
              else
              {
-              	 return { (std::abs(event.muonPF2PATDZPV[event.muonIndexTight[1]]))/(event.muonPF2PATDZPVError[event.muonIndexTight[1]] + 1.0e-06) };
+              	 return (std::abs(event.muonPF2PATDZPV[event.muonIndexTight[1]]))/(event.muonPF2PATDZPVError[event.muonIndexTight[1]] + 1.0e-06);
              }
          }},
-        {"lep1DBD0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1DBD0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATTrackDBD0[event.electronIndexTight[0]]};
+                 return event.elePF2PATTrackDBD0[event.electronIndexTight[0]];
              }
              else
              {
-                 return {event.muonPF2PATTrackDBD0[event.muonIndexTight[0]]};
+                 return event.muonPF2PATTrackDBD0[event.muonIndexTight[0]];
              }
          }},
-        {"lep2DBD0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2DBD0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATTrackDBD0[event.electronIndexTight[1]]};
+                 return event.elePF2PATTrackDBD0[event.electronIndexTight[1]];
              }
              else
              {
-                 return {event.muonPF2PATTrackDBD0[event.muonIndexTight[1]]};
+                 return event.muonPF2PATTrackDBD0[event.muonIndexTight[1]];
              }
          }},
-        {"lep1BeamSpotCorrectedD0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1BeamSpotCorrectedD0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATBeamSpotCorrectedTrackD0
-                             [event.electronIndexTight[0]]};
+                 return event.elePF2PATBeamSpotCorrectedTrackD0
+                             [event.electronIndexTight[0]];
              }
              else
              {
-                 return {event.muonPF2PATBeamSpotCorrectedD0
-                             [event.muonIndexTight[0]]};
+                 return event.muonPF2PATBeamSpotCorrectedD0
+                             [event.muonIndexTight[0]];
              }
          }},
-        {"lep2BeamSpotCorrectedD0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2BeamSpotCorrectedD0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {event.elePF2PATBeamSpotCorrectedTrackD0
-                             [event.electronIndexTight[1]]};
+                 return event.elePF2PATBeamSpotCorrectedTrackD0
+                             [event.electronIndexTight[1]];
              }
              else
              {
-                 return {event.muonPF2PATBeamSpotCorrectedD0
-                             [event.muonIndexTight[1]]};
+                 return event.muonPF2PATBeamSpotCorrectedD0
+                             [event.muonIndexTight[1]];
              }
          }},
-        {"lep1InnerTrackD0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep1InnerTrackD0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {};
+                 return noValue;
              }
              else
              {
-                 return {
-                     event.muonPF2PATDBInnerTrackD0[event.muonIndexTight[0]]};
+                 return event.muonPF2PATDBInnerTrackD0[event.muonIndexTight[0]];
              }
          }},
-        {"lep2InnerTrackD0",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lep2InnerTrackD0", Leptons,
+         [](const AnalysisEvent& event) -> float {
              if (event.electronIndexTight.size() > 1)
              {
-                 return {};
+                 return noValue;
              }
              else
              {
-                 return {
-                     event.muonPF2PATDBInnerTrackD0[event.muonIndexTight[1]]};
+                 return event.muonPF2PATDBInnerTrackD0[event.muonIndexTight[1]];
              }
          }},
-        {"wTransverseMass",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 std::sqrt(2 * event.wPairQuarks.first.Pt()
+        {"wTransverseMass", Jets,
+         [](const AnalysisEvent& event) -> float {
+             return std::sqrt(2 * event.wPairQuarks.first.Pt()
                            * event.wPairQuarks.second.Pt()
                            * (1
                               - std::cos(event.wPairQuarks.first.Phi()
-                                         - event.wPairQuarks.second.Phi())))};
+                                         - event.wPairQuarks.second.Phi())));
          }},
-        {"jjDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"jjDelR", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempJet1;
              TLorentzVector tempJet2;
              if (event.jetIndex.size() < 2)
              {
-                 return {};
+                 return noValue;
              }
              float smearValue1 = event.jetSmearValue[event.jetIndex[0]];
              float smearValue2 = event.jetSmearValue[event.jetIndex[1]];
@@ -1184,15 +1246,15 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                  event.jetPF2PATE[event.jetIndex[1]]);
              tempJet1 *= smearValue1;
              tempJet2 *= smearValue2;
-             return {tempJet1.DeltaR(tempJet2)};
+             return tempJet1.DeltaR(tempJet2);
          }},
-        {"jjDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"jjDelPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempJet1;
              TLorentzVector tempJet2;
              if (event.jetIndex.size() < 2)
              {
-                 return {};
+                 return noValue;
              }
              float smearValue1 = event.jetSmearValue[event.jetIndex[0]];
              float smearValue2 = event.jetSmearValue[event.jetIndex[1]];
@@ -1206,31 +1268,30 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                                  event.jetPF2PATE[event.jetIndex[1]]);
              tempJet1 *= smearValue1;
              tempJet2 *= smearValue2;
-             return {tempJet1.DeltaPhi(tempJet2)};
+             return tempJet1.DeltaPhi(tempJet2);
          }},
-        {"wwDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"wwDelR", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() < 3)
              {
-                 return {};
+                 return noValue;
              }
-             return {event.wPairQuarks.first.DeltaR(event.wPairQuarks.second)};
+             return event.wPairQuarks.first.DeltaR(event.wPairQuarks.second);
          }},
-        {"wwDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"wwDelPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.jetIndex.size() < 3)
              {
-                 return {};
+                 return noValue;
              }
-             return {
-                 event.wPairQuarks.first.DeltaPhi(event.wPairQuarks.second)};
+             return event.wPairQuarks.first.DeltaPhi(event.wPairQuarks.second);
          }},
-        {"lbDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lbDelR", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempJet1;
              if (event.bTagIndex.size() < 1)
              {
-                 return {};
+                 return noValue;
              }
              float smearValue =
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]];
@@ -1240,14 +1301,14 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPz[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempJet1 *= smearValue;
-             return {tempJet1.DeltaR(event.wLepton)};
+             return tempJet1.DeltaR(event.wLepton);
          }},
-        {"lbDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"lbDelPhi", Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempJet1;
              if (event.bTagIndex.size() < 1)
              {
-                 return {};
+                 return noValue;
              }
              float smearValue =
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]];
@@ -1257,80 +1318,69 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPz[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempJet1 *= smearValue;
-             return {tempJet1.DeltaPhi(event.wLepton)};
-         }},
-        {"zLepDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.first.DeltaR(event.zPairLeptons.second)};
-         }},
-        {"zLepDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.first.DeltaPhi(event.zPairLeptons.second)};
-         }},
-        {"zLepDelZ",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.first.Z() - event.zPairLeptons.second.Z()};
-         }},
-        {"zLepDelRRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptonsRefitted.first.DeltaR(event.zPairLeptonsRefitted.second)};
-         }},
-        {"zLepDelPhiRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptonsRefitted.first.DeltaPhi(event.zPairLeptonsRefitted.second)};
-         }},
-        {"zLepDelZRefit",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptonsRefitted.first.Z() - event.zPairLeptonsRefitted.second.Z()};
-         }},
-        {"zLep1Quark1DelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairLeptons.first.DeltaR(event.wPairQuarks.first)};
-         }},
-        {"zLep1Quark1DelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.first.DeltaPhi(event.wPairQuarks.first)};
-         }},
-        {"zLep1Quark2DelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairLeptons.first.DeltaR(event.wPairQuarks.second)};
-         }},
-        {"zLep1Quark2DelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.first.DeltaPhi(event.wPairQuarks.second)};
-         }},
-        {"zLep2Quark1DelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.zPairLeptons.second.DeltaR(event.wPairQuarks.first)};
-         }},
-        {"zLep2Quark1DelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.second.DeltaPhi(event.wPairQuarks.first)};
-         }},
-        {"zLep2Quark2DelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.second.DeltaR(event.wPairQuarks.second)};
-         }},
-        {"zLep2Quark2DelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 event.zPairLeptons.second.DeltaPhi(event.wPairQuarks.second)};
-         }},
-        {"zLep1BjetDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+             return tempJet1.DeltaPhi(event.wLepton);
+         }},
+        {"zLepDelR", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.DeltaR(event.zPairLeptons.second);
+         }},
+        {"zLepDelPhi", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.DeltaPhi(event.zPairLeptons.second);
+         }},
+        {"zLepDelZ", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.Z() - event.zPairLeptons.second.Z();
+         }},
+        {"zLepDelRRefit", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptonsRefitted.first.DeltaR(event.zPairLeptonsRefitted.second);
+         }},
+        {"zLepDelPhiRefit", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptonsRefitted.first.DeltaPhi(event.zPairLeptonsRefitted.second);
+         }},
+        {"zLepDelZRefit", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptonsRefitted.first.Z() - event.zPairLeptonsRefitted.second.Z();
+         }},
+        {"zLep1Quark1DelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.DeltaR(event.wPairQuarks.first);
+         }},
+        {"zLep1Quark1DelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.DeltaPhi(event.wPairQuarks.first);
+         }},
+        {"zLep1Quark2DelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.DeltaR(event.wPairQuarks.second);
+         }},
+        {"zLep1Quark2DelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.first.DeltaPhi(event.wPairQuarks.second);
+         }},
+        {"zLep2Quark1DelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.second.DeltaR(event.wPairQuarks.first);
+         }},
+        {"zLep2Quark1DelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.second.DeltaPhi(event.wPairQuarks.first);
+         }},
+        {"zLep2Quark2DelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.second.DeltaR(event.wPairQuarks.second);
+         }},
+        {"zLep2Quark2DelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return event.zPairLeptons.second.DeltaPhi(event.wPairQuarks.second);
+         }},
+        {"zLep1BjetDelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() < 1)
              {
-                 return {};
+                 return noValue;
              }
              TLorentzVector tempJet1;
              float smearValue{
@@ -1341,13 +1391,13 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPz[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempJet1 *= smearValue;
-             return {event.zPairLeptons.first.DeltaR(tempJet1)};
+             return event.zPairLeptons.first.DeltaR(tempJet1);
          }},
-        {"zLep1BjetDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zLep1BjetDelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() < 1)
              {
-                 return {};
+                 return noValue;
              }
              TLorentzVector tempJet1;
              float smearValue{
@@ -1358,13 +1408,13 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPz[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempJet1 *= smearValue;
-             return {event.zPairLeptons.first.DeltaPhi(tempJet1)};
+             return event.zPairLeptons.first.DeltaPhi(tempJet1);
          }},
-        {"zLep2BjetDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zLep2BjetDelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() < 1)
              {
-                 return {};
+                 return noValue;
              }
              TLorentzVector tempJet1;
              float smearValue{
@@ -1375,13 +1425,13 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPz[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempJet1 *= smearValue;
-             return {event.zPairLeptons.second.DeltaR(tempJet1)};
+             return event.zPairLeptons.second.DeltaR(tempJet1);
          }},
-        {"zLep2BjetDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zLep2BjetDelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              if (event.bTagIndex.size() < 1)
              {
-                 return {};
+                 return noValue;
              }
              TLorentzVector tempJet1;
              float smearValue{
@@ -1392,20 +1442,18 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPz[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempJet1 *= smearValue;
-             return {event.zPairLeptons.second.DeltaPhi(tempJet1)};
+             return event.zPairLeptons.second.DeltaPhi(tempJet1);
          }},
-        {"lepHt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 (event.zPairLeptons.first + event.zPairLeptons.second).Pt()};
+        {"lepHt", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).Pt();
          }},
-        {"wQuarkHt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {
-                 (event.zPairLeptons.first + event.zPairLeptons.second).Pt()};
+        {"wQuarkHt", Leptons,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second).Pt();
          }},
-        {"jetHt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"jetHt", Jets,
+         [](const AnalysisEvent& event) -> float {
              float jetHt{0.0};
              if (event.jetIndex.size() > 0)
              {
@@ -1423,10 +1471,10 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      jetHt += tempJet.Pt();
                  }
              }
-             return {jetHt};
+             return jetHt;
          }},
-        {"totHt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totHt", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              float totHt{0.0};
              totHt +=
                  (event.zPairLeptons.first + event.zPairLeptons.second).Pt();
@@ -1446,10 +1494,10 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      totHt += tempJet.Pt();
                  }
              }
-             return {totHt};
+             return totHt;
          }},
-        {"totHtOverPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totHtOverPt", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              float totHt{0.0};
              totHt +=
                  (event.zPairLeptons.first + event.zPairLeptons.second).Pt();
@@ -1493,10 +1541,10 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  }
              }
 
-             return {totHt / std::sqrt(totPx * totPx + totPy * totPy)};
+             return totHt / std::sqrt(totPx * totPx + totPy * totPy);
          }},
-        {"totPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totPt", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              float totPx{0.0};
              float totPy{0.0};
              totPx +=
@@ -1520,10 +1568,10 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      totPy += tempJet.Py();
                  }
              }
-             return {std::sqrt(totPx * totPx + totPy * totPy)};
+             return std::sqrt(totPx * totPx + totPy * totPy);
          }},
-        {"totEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totEta", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector totVec;
              totVec = event.zPairLeptons.first + event.zPairLeptons.second;
              if (event.jetIndex.size() > 0)
@@ -1541,10 +1589,10 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      tempJet *= smearValue;
                  }
              }
-             return {std::abs(totVec.Eta())};
+             return std::abs(totVec.Eta());
          }},
-        {"totM",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"totM", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector totVec;
              totVec = event.zPairLeptons.first + event.zPairLeptons.second;
              if (event.jetIndex.size() > 0)
@@ -1563,42 +1611,42 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                      totVec += tempJet;
                  }
              }
-             return {totVec.M()};
+             return totVec.M();
          }},
-        {"wzDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
+        {"wzDelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
                          .DeltaR(event.wPairQuarks.first
-                                 + event.wPairQuarks.second)};
+                                 + event.wPairQuarks.second);
          }},
-        {"wzDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
+        {"wzDelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
                          .DeltaPhi(event.wPairQuarks.first
-                                   + event.wPairQuarks.second)};
-         }},
-        {"zQuark1DelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
-                         .DeltaR(event.wPairQuarks.first)};
-         }},
-        {"zQuark1DelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
-                         .DeltaPhi(event.wPairQuarks.first)};
-         }},
-        {"zQuark2DelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
-                         .DeltaR(event.wPairQuarks.second)};
-         }},
-        {"zQuark2DelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
-                         .DeltaPhi(event.wPairQuarks.second)};
-         }},
-        {"zTopDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+                                   + event.wPairQuarks.second);
+         }},
+        {"zQuark1DelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
+                         .DeltaR(event.wPairQuarks.first);
+         }},
+        {"zQuark1DelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
+                         .DeltaPhi(event.wPairQuarks.first);
+         }},
+        {"zQuark2DelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
+                         .DeltaR(event.wPairQuarks.second);
+         }},
+        {"zQuark2DelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
+                         .DeltaPhi(event.wPairQuarks.second);
+         }},
+        {"zTopDelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempBjet;
              float smearValue{
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]]};
@@ -1608,12 +1656,12 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempBjet *= smearValue;
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
                          .DeltaR(event.wPairQuarks.first
-                                 + event.wPairQuarks.second + tempBjet)};
+                                 + event.wPairQuarks.second + tempBjet);
          }},
-        {"zTopDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zTopDelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempBjet;
              float smearValue{
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]]};
@@ -1623,12 +1671,12 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempBjet *= smearValue;
-             return {(event.zPairLeptons.first + event.zPairLeptons.second)
+             return (event.zPairLeptons.first + event.zPairLeptons.second)
                          .DeltaPhi(event.wPairQuarks.first
-                                   + event.wPairQuarks.second + tempBjet)};
+                                   + event.wPairQuarks.second + tempBjet);
          }},
-        {"zl1TopDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zl1TopDelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempBjet;
              float smearValue{
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]]};
@@ -1638,12 +1686,12 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempBjet *= smearValue;
-             return {(event.zPairLeptons.first)
+             return (event.zPairLeptons.first)
                          .DeltaR(event.wPairQuarks.first
-                                 + event.wPairQuarks.second + tempBjet)};
+                                 + event.wPairQuarks.second + tempBjet);
          }},
-        {"zl1TopDelPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zl1TopDelPhi", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempBjet;
              float smearValue{
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]]};
@@ -1653,12 +1701,12 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempBjet *= smearValue;
-             return {(event.zPairLeptons.first)
+             return (event.zPairLeptons.first)
                          .DeltaPhi(event.wPairQuarks.first
-                                   + event.wPairQuarks.second + tempBjet)};
+                                   + event.wPairQuarks.second + tempBjet);
          }},
-        {"zl2TopDelR",
-         [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zl2TopDelR", Leptons | Jets,
+         [](const AnalysisEvent& event) -> float {
              TLorentzVector tempBjet;
              float smearValue{
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]]};
@@ -1668,90 +1716,11 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempBjet *= smearValue;
-             return {(event.zPairLeptons.second)
+             return (event.zPairLeptons.second)
                          .DeltaR(event.wPairQuarks.first
-                                 + event.wPairQuarks.second + tempBjet)};
+                                 + event.wPairQuarks.second + tempBjet);
          }},
-        {"allJetEta",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             std::vector<float> etas;
-             for (const auto& i : event.jetIndex)
-             {
-                 float smearValue = event.jetSmearValue[i];
-                 TLorentzVector tempJet{event.jetPF2PATPx[i],
-                                        event.jetPF2PATPy[i],
-                                        event.jetPF2PATPz[i],
-                                        event.jetPF2PATE[i]};
-                 tempJet *= smearValue;
-                 etas.emplace_back(tempJet.Eta());
-             }
-             return etas;
-         }},
-        {"allJetPhi",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             std::vector<float> phis;
-             for (const auto& i : event.jetIndex)
-             {
-                 float smearValue = event.jetSmearValue[i];
-                 TLorentzVector tempJet{event.jetPF2PATPx[i],
-                                        event.jetPF2PATPy[i],
-                                        event.jetPF2PATPz[i],
-                                        event.jetPF2PATE[i]};
-                 tempJet *= smearValue;
-                 phis.emplace_back(tempJet.Phi());
-             }
-             return phis;
-         }},
-        {"allJetPt",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             std::vector<float> pts;
-             for (const auto& i : event.jetIndex)
-             {
-                 float smearValue = event.jetSmearValue[i];
-                 TLorentzVector tempJet{event.jetPF2PATPx[i],
-                                        event.jetPF2PATPy[i],
-                                        event.jetPF2PATPz[i],
-                                        event.jetPF2PATE[i]};
-                 tempJet *= smearValue;
-                 pts.emplace_back(tempJet.Pt());
-             }
-             return pts;
-         }},
-        {"allJetDeltaRLep",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             std::vector<float> dRs;
-             for (const auto& i : event.jetIndex)
-             {
-                 float smearValue = event.jetSmearValue[i];
-                 TLorentzVector tempJet{event.jetPF2PATPx[i],
-                                        event.jetPF2PATPy[i],
-                                        event.jetPF2PATPz[i],
-                                        event.jetPF2PATE[i]};
-                 tempJet *= smearValue;
-                 dRs.emplace_back(
-                     std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
-                                           event.zPairLeptons.first.Phi(),
-                                           tempJet.Eta(),
-                                           tempJet.Phi()),
-                              Cuts::deltaR(event.zPairLeptons.second.Eta(),
-                                           event.zPairLeptons.second.Phi(),
-                                           tempJet.Eta(),
-                                           tempJet.Phi())));
-             }
-             return dRs;
-         }},
-        {"allJetBDisc",
-         [](const AnalysisEvent& event) -> std::vector<float> {
-             std::vector<float> discs;
-             for (const auto& i : event.jetIndex)
-             {
-                 discs.emplace_back(
-                     event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
-                         [i]);
-             }
-             return discs;
-         }},
-        {"zl2TopDelPhi", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"zl2TopDelPhi", Leptons | Jets, [](const AnalysisEvent& event) -> float {
              TLorentzVector tempBjet;
              float smearValue{
                  event.jetSmearValue[event.jetIndex[event.bTagIndex[0]]]};
@@ -1761,184 +1730,428 @@ std::unordered_map<std::string, std::function<std::vector<float>(const AnalysisE
                  event.jetPF2PATPhi[event.jetIndex[event.bTagIndex[0]]],
                  event.jetPF2PATE[event.jetIndex[event.bTagIndex[0]]]);
              tempBjet *= smearValue;
-             return {(event.zPairLeptons.second)
+             return (event.zPairLeptons.second)
                          .DeltaPhi(event.wPairQuarks.first
-                                   + event.wPairQuarks.second + tempBjet)};
+                                   + event.wPairQuarks.second + tempBjet);
          }},
-        {"mumuVtxPx", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVtxPx[event.mumuTrkIndex]};
+        {"mumuVtxPx", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVtxPx[event.mumuTrkIndex];
          }},
-        {"mumuVtxPy", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVtxPy[event.mumuTrkIndex]};
+        {"mumuVtxPy", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVtxPy[event.mumuTrkIndex];
          }},
-        {"mumuVtxPz", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVtxPz[event.mumuTrkIndex]};
+        {"mumuVtxPz", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVtxPz[event.mumuTrkIndex];
          }},
-        {"mumuVtxP", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::sqrt( event.muonTkPairPF2PATTkVtxP2[event.mumuTrkIndex] )};
+        {"mumuVtxP", Leptons, [](const AnalysisEvent& event) -> float {
+             return std::sqrt( event.muonTkPairPF2PATTkVtxP2[event.mumuTrkIndex] );
          }},
-	{"mumuVx", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVx[event.mumuTrkIndex]};
+        {"mumuVx", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVx[event.mumuTrkIndex];
          }},
-	{"mumuVy", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVy[event.mumuTrkIndex]};
+        {"mumuVy", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVy[event.mumuTrkIndex];
          }},
-	{"mumuVz", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVz[event.mumuTrkIndex]};
+        {"mumuVz", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVz[event.mumuTrkIndex];
          }},
-	{"mumuVabs", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"mumuVabs", Leptons, [](const AnalysisEvent& event) -> float {
              float vx {event.muonTkPairPF2PATTkVx[event.mumuTrkIndex]}, vy {event.muonTkPairPF2PATTkVy[event.mumuTrkIndex]}, vz {event.muonTkPairPF2PATTkVz[event.mumuTrkIndex]};
-             return { std::sqrt(vx*vx + vy*vy + vz*vz) };
+             return std::sqrt(vx*vx + vy*vy + vz*vz);
          }},
-	{"mumuVtxChi2Ndof", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxChi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxNdof[event.mumuTrkIndex]+1.0e-06)};
+        {"mumuVtxChi2Ndof", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxChi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxNdof[event.mumuTrkIndex]+1.0e-06);
          }},
-	{"mumuVtxAngleXY", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxAngleXY[event.mumuTrkIndex])};
+        {"mumuVtxAngleXY", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxAngleXY[event.mumuTrkIndex]);
          }},
-        {"mumuVtxAngleXYZ", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxAngleXYZ[event.mumuTrkIndex])};         
+        {"mumuVtxAngleXYZ", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxAngleXYZ[event.mumuTrkIndex]);         
          }},
-        {"mumuVtxSigXY", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxDistMagXY[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYSigma[event.mumuTrkIndex]+1.0e-06)};
+        {"mumuVtxSigXY", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxDistMagXY[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYSigma[event.mumuTrkIndex]+1.0e-06);
          }},
-	{"mumuVtxSigXYZ", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxDistMagXYZ[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYZSigma[event.mumuTrkIndex]+1.0e-06)};
+        {"mumuVtxSigXYZ", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxDistMagXYZ[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYZSigma[event.mumuTrkIndex]+1.0e-06);
          }},
-	{"mumuVtxDca", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxDcaPreFit[event.mumuTrkIndex])};
+        {"mumuVtxDca", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxDcaPreFit[event.mumuTrkIndex]);
          }},
-        {"mumuTrkInnerPtOld1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkPt[event.zPairIndex.first]};
+        {"mumuTrkInnerPtOld1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkPt[event.zPairIndex.first];
          }},
-        {"mumuTrkInnerEtaOld1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkEta[event.zPairIndex.first]};
+        {"mumuTrkInnerEtaOld1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkEta[event.zPairIndex.first];
          }},
-        {"mumuTrkInnerChi2NdofOld1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkNormChi2[event.zPairIndex.first]};
+        {"mumuTrkInnerChi2NdofOld1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkNormChi2[event.zPairIndex.first];
          }},
-        {"mumuTrkInnerPtOld2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkPt[event.zPairIndex.second]};
+        {"mumuTrkInnerPtOld2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkPt[event.zPairIndex.second];
          }},
-        {"mumuTrkInnerEtaOld2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkEta[event.zPairIndex.second]};
+        {"mumuTrkInnerEtaOld2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkEta[event.zPairIndex.second];
          }},
-        {"mumuTrkInnerChi2NdofOld2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkNormChi2[event.zPairIndex.second]};
+        {"mumuTrkInnerChi2NdofOld2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkNormChi2[event.zPairIndex.second];
          }},
-	{"mumuTrkInnerPtNew1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk1Pt[event.mumuTrkIndex]};
+        {"mumuTrkInnerPtNew1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk1Pt[event.mumuTrkIndex];
          }},
-	{"mumuTrkInnerEtaNew1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex]};
+        {"mumuTrkInnerEtaNew1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex];
          }},
-	{"mumuTrkInnerChi2NdofNew1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTk1Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk1Ndof[event.mumuTrkIndex]+1.0e-06)};
+        {"mumuTrkInnerChi2NdofNew1", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTk1Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk1Ndof[event.mumuTrkIndex]+1.0e-06);
          }},
-	{"mumuTrkInnerPtNew2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk2Pt[event.mumuTrkIndex]};
+        {"mumuTrkInnerPtNew2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk2Pt[event.mumuTrkIndex];
          }},
-	{"mumuTrkInnerEtaNew2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex]};
+        {"mumuTrkInnerEtaNew2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex];
          }},
-	{"mumuTrkInnerChi2NdofNew2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTk2Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk2Ndof[event.mumuTrkIndex]+1.0e-06)};
+        {"mumuTrkInnerChi2NdofNew2", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTk2Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk2Ndof[event.mumuTrkIndex]+1.0e-06);
          }},
-        {"dichsVtxPx", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVtxPx[event.mumuTrkIndex]};
+        {"dichsVtxPx", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVtxPx[event.mumuTrkIndex];
          }},
-        {"dichsVtxPy", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVtxPy[event.mumuTrkIndex]};
+        {"dichsVtxPy", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVtxPy[event.mumuTrkIndex];
          }},
-        {"dichsVtxPz", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVtxPz[event.mumuTrkIndex]};
+        {"dichsVtxPz", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVtxPz[event.mumuTrkIndex];
          }},
-        {"dichsVtxP", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {std::sqrt( event.muonTkPairPF2PATTkVtxP2[event.mumuTrkIndex] )};
+        {"dichsVtxP", Leptons, [](const AnalysisEvent& event) -> float {
+             return std::sqrt( event.muonTkPairPF2PATTkVtxP2[event.mumuTrkIndex] );
          }},
-	{"dichsVx", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVx[event.mumuTrkIndex]};
+        {"dichsVx", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVx[event.mumuTrkIndex];
          }},
-	{"dichsVy", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVy[event.mumuTrkIndex]};
+        {"dichsVy", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVy[event.mumuTrkIndex];
          }},
-	{"dichsVz", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTkVz[event.mumuTrkIndex]};
+        {"dichsVz", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTkVz[event.mumuTrkIndex];
          }},
-	{"dichsVabs", [](const AnalysisEvent& event) -> std::vector<float> {
+        {"dichsVabs", Leptons, [](const AnalysisEvent& event) -> float {
              float vx {event.muonTkPairPF2PATTkVx[event.mumuTrkIndex]}, vy {event.muonTkPairPF2PATTkVy[event.mumuTrkIndex]}, vz {event.muonTkPairPF2PATTkVz[event.mumuTrkIndex]};
-             return { std::sqrt(vx*vx + vy*vy + vz*vz) };
+             return std::sqrt(vx*vx + vy*vy + vz*vz);
+         }},
+        {"dichsVtxChi2Ndof", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxChi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxNdof[event.mumuTrkIndex]+1.0e-06);
+         }},
+        {"dichsVtxAngleXY", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxAngleXY[event.mumuTrkIndex]);
+         }},
+        {"dichsVtxAngleXYZ", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxAngleXYZ[event.mumuTrkIndex]);         
+         }},
+        {"dichsVtxSigXY", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxDistMagXY[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYSigma[event.mumuTrkIndex]+1.0e-06);
+         }},
+        {"dichsVtxSigXYZ", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxDistMagXYZ[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYZSigma[event.mumuTrkIndex]+1.0e-06);
+         }},
+        {"dichsVtxDca", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTkVtxDcaPreFit[event.mumuTrkIndex]);
+         }},
+        {"dichsTrkInnerPtOld1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkPt[event.zPairIndex.first];
+         }},
+        {"dichsTrkInnerEtaOld1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkEta[event.zPairIndex.first];
+         }},
+        {"dichsTrkInnerChi2NdofOld1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkNormChi2[event.zPairIndex.first];
+         }},
+        {"dichsTrkInnerPtOld2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkPt[event.zPairIndex.second];
+         }},
+        {"dichsTrkInnerEtaOld2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkEta[event.zPairIndex.second];
          }},
-	{"dichsVtxChi2Ndof", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxChi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxNdof[event.mumuTrkIndex]+1.0e-06)};
+        {"dichsTrkInnerChi2NdofOld2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonPF2PATInnerTkNormChi2[event.zPairIndex.second];
          }},
-	{"dichsVtxAngleXY", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxAngleXY[event.mumuTrkIndex])};
+        {"dichsTrkInnerPtNew1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk1Pt[event.mumuTrkIndex];
          }},
-        {"dichsVtxAngleXYZ", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxAngleXYZ[event.mumuTrkIndex])};         
+        {"dichsTrkInnerEtaNew1", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex];
          }},
-        {"dichsVtxSigXY", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxDistMagXY[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYSigma[event.mumuTrkIndex]+1.0e-06)};
+        {"dichsTrkInnerChi2NdofNew1", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTk1Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk1Ndof[event.mumuTrkIndex]+1.0e-06);
          }},
-	{"dichsVtxSigXYZ", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxDistMagXYZ[event.mumuTrkIndex])/(event.muonTkPairPF2PATTkVtxDistMagXYZSigma[event.mumuTrkIndex]+1.0e-06)};
+        {"dichsTrkInnerPtNew2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk2Pt[event.mumuTrkIndex];
          }},
-	{"dichsVtxDca", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTkVtxDcaPreFit[event.mumuTrkIndex])};
+        {"dichsTrkInnerEtaNew2", Leptons, [](const AnalysisEvent& event) -> float {
+             return event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex];
          }},
-        {"dichsTrkInnerPtOld1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkPt[event.zPairIndex.first]};
+        {"dichsTrkInnerChi2NdofNew2", Leptons, [](const AnalysisEvent& event) -> float {
+             return (event.muonTkPairPF2PATTk2Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk2Ndof[event.mumuTrkIndex]+1.0e-06);
          }},
-        {"dichsTrkInnerEtaOld1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkEta[event.zPairIndex.first]};
+        {"mumuPairVtxDistXY", Leptons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.muonTkPairVertices.distXY, event.mumuTrkIndex);
          }},
-        {"dichsTrkInnerChi2NdofOld1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkNormChi2[event.zPairIndex.first]};
+        {"mumuPairVtxSigXY", Leptons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.muonTkPairVertices.sigXY, event.mumuTrkIndex);
          }},
-        {"dichsTrkInnerPtOld2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkPt[event.zPairIndex.second]};
+        {"mumuPairVtxDistXYZ", Leptons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.muonTkPairVertices.distXYZ, event.mumuTrkIndex);
          }},
-        {"dichsTrkInnerEtaOld2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkEta[event.zPairIndex.second]};
+        {"mumuPairVtxSigXYZ", Leptons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.muonTkPairVertices.sigXYZ, event.mumuTrkIndex);
          }},
-        {"dichsTrkInnerChi2NdofOld2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonPF2PATInnerTkNormChi2[event.zPairIndex.second]};
+        {"mumuPairVtxChi2Ndof", Leptons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.muonTkPairVertices.chi2Ndof, event.mumuTrkIndex);
          }},
-	{"dichsTrkInnerPtNew1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk1Pt[event.mumuTrkIndex]};
+        {"mumuPairVtxCosPointingXY", Leptons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.muonTkPairVertices.cosPointingXY, event.mumuTrkIndex);
          }},
-	{"dichsTrkInnerEtaNew1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex]};
+        {"mumuPairVtxCosPointingXYZ", Leptons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.muonTkPairVertices.cosPointingXYZ, event.mumuTrkIndex);
          }},
-	{"dichsTrkInnerChi2NdofNew1", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTk1Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk1Ndof[event.mumuTrkIndex]+1.0e-06)};
+        {"chsPairVtxDistXY", Hadrons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.chsTkPairVertices.distXY, event.chsPairTrkIndex);
          }},
-	{"dichsTrkInnerPtNew2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk2Pt[event.mumuTrkIndex]};
+        {"chsPairVtxSigXY", Hadrons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.chsTkPairVertices.sigXY, event.chsPairTrkIndex);
          }},
-	{"dichsTrkInnerEtaNew2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {event.muonTkPairPF2PATTk2Eta[event.mumuTrkIndex]};
+        {"chsPairVtxDistXYZ", Hadrons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.chsTkPairVertices.distXYZ, event.chsPairTrkIndex);
          }},
-	{"dichsTrkInnerChi2NdofNew2", [](const AnalysisEvent& event) -> std::vector<float> {
-             return {(event.muonTkPairPF2PATTk2Chi2[event.mumuTrkIndex])/(event.muonTkPairPF2PATTk2Ndof[event.mumuTrkIndex]+1.0e-06)};
+        {"chsPairVtxSigXYZ", Hadrons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.chsTkPairVertices.sigXYZ, event.chsPairTrkIndex);
+         }},
+        {"chsPairVtxChi2Ndof", Hadrons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.chsTkPairVertices.chi2Ndof, event.chsPairTrkIndex);
+         }},
+        {"chsPairVtxCosPointingXY", Hadrons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.chsTkPairVertices.cosPointingXY, event.chsPairTrkIndex);
+         }},
+        {"chsPairVtxCosPointingXYZ", Hadrons, [](const AnalysisEvent& event) -> float {
+             return pairVertexValue(event.chsTkPairVertices.cosPointingXYZ, event.chsPairTrkIndex);
+         }}
+    };
+}
+
+std::vector<Plots::VariableDef<Plots::VectorFill>> Plots::getVectorVariables() {
+    return {
+        {"allJetEta", Jets,
+         [](const AnalysisEvent& event, std::vector<float>& values) {
+             for (const auto& i : event.jetIndex)
+             {
+                 float smearValue = event.jetSmearValue[i];
+                 TLorentzVector tempJet{event.jetPF2PATPx[i],
+                                        event.jetPF2PATPy[i],
+                                        event.jetPF2PATPz[i],
+                                        event.jetPF2PATE[i]};
+                 tempJet *= smearValue;
+                 values.emplace_back(tempJet.Eta());
+             }
+         }},
+        {"allJetPhi", Jets,
+         [](const AnalysisEvent& event, std::vector<float>& values) {
+             for (const auto& i : event.jetIndex)
+             {
+                 float smearValue = event.jetSmearValue[i];
+                 TLorentzVector tempJet{event.jetPF2PATPx[i],
+                                        event.jetPF2PATPy[i],
+                                        event.jetPF2PATPz[i],
+                                        event.jetPF2PATE[i]};
+                 tempJet *= smearValue;
+                 values.emplace_back(tempJet.Phi());
+             }
+         }},
+        {"allJetPt", Jets,
+         [](const AnalysisEvent& event, std::vector<float>& values) {
+             for (const auto& i : event.jetIndex)
+             {
+                 float smearValue = event.jetSmearValue[i];
+                 TLorentzVector tempJet{event.jetPF2PATPx[i],
+                                        event.jetPF2PATPy[i],
+                                        event.jetPF2PATPz[i],
+                                        event.jetPF2PATE[i]};
+                 tempJet *= smearValue;
+                 values.emplace_back(tempJet.Pt());
+             }
+         }},
+        {"allJetDeltaRLep", Leptons | Jets,
+         [](const AnalysisEvent& event, std::vector<float>& values) {
+             for (const auto& i : event.jetIndex)
+             {
+                 float smearValue = event.jetSmearValue[i];
+                 TLorentzVector tempJet{event.jetPF2PATPx[i],
+                                        event.jetPF2PATPy[i],
+                                        event.jetPF2PATPz[i],
+                                        event.jetPF2PATE[i]};
+                 tempJet *= smearValue;
+                 values.emplace_back(
+                     std::min(Cuts::deltaR(event.zPairLeptons.first.Eta(),
+                                           event.zPairLeptons.first.Phi(),
+                                           tempJet.Eta(),
+                                           tempJet.Phi()),
+                              Cuts::deltaR(event.zPairLeptons.second.Eta(),
+                                           event.zPairLeptons.second.Phi(),
+                                           tempJet.Eta(),
+                                           tempJet.Phi())));
+             }
+         }},
+        {"allJetBDisc", Jets,
+         [](const AnalysisEvent& event, std::vector<float>& values) {
+             for (const auto& i : event.jetIndex)
+             {
+                 values.emplace_back(
+                     event.jetPF2PATpfCombinedInclusiveSecondaryVertexV2BJetTags
+                         [i]);
+             }
+         }},
+        {"allChsPairVtxSigXY", Branches, [](const AnalysisEvent& event, std::vector<float>& values) {
+             values.insert(values.end(), event.chsTkPairVertices.sigXY.begin(), event.chsTkPairVertices.sigXY.end());
+         }},
+        {"allChsPairVtxSigXYZ", Branches, [](const AnalysisEvent& event, std::vector<float>& values) {
+             values.insert(values.end(), event.chsTkPairVertices.sigXYZ.begin(), event.chsTkPairVertices.sigXYZ.end());
+         }},
+        {"allChsPairVtxCosPointingXY", Branches, [](const AnalysisEvent& event, std::vector<float>& values) {
+             values.insert(values.end(), event.chsTkPairVertices.cosPointingXY.begin(), event.chsTkPairVertices.cosPointingXY.end());
          }}
     };
 }
 
 void Plots::fillAllPlots(const AnalysisEvent& event, const double eventWeight)
 {
+    if (weightChannels_.empty() || event.weightVariations.empty())
+    {
+        fillAllPlots(event, eventWeight, accumulators_);
+        return;
+    }
+    if (event.weightVariations.size() != weightChannels_.size())
+    {
+        throw std::logic_error("Number of weight variations doesn't match the weight channels of the plots");
+    }
+
+    channelWeights_[0] = eventWeight;
+    for (size_t k{0}; k < weightChannels_.size(); k++)
+    {
+        channelWeights_[k + 1] = eventWeight * event.weightVariations[k];
+    }
+    const auto& registry{PlotVariableRegistry::instance()};
+    for (unsigned i{0}; i < plotPoint.size(); i++) {
+        if (!plotPoint[i].fillPlot) continue;
+
+        const unsigned id{plotPoint[i].variable};
+        const auto& variable{registry.variable(id)};
+        if (variable.fillScalar) {
+            const float val{event.derivedCache.scalar(id, variable.dependencies, variable.fillScalar, event)};
+            if (!std::isnan(val)) multiWeight_[i].fill(val, channelWeights_.data());
+        }
+        else {
+            for (const auto& val : event.derivedCache.values(id, variable.dependencies, variable.fillVector, event)) {
+                multiWeight_[i].fill(val, channelWeights_.data());
+            }
+        }
+    }
+}
+
+std::vector<HistogramAccumulator> Plots::newAccumulators() const
+{
+    std::vector<HistogramAccumulator> accumulators;
+    accumulators.reserve(binnings_.size());
+    for (const auto& binning : binnings_)
+    {
+        accumulators.emplace_back(binning.nBins, binning.min, binning.max);
+    }
+    return accumulators;
+}
+
+void Plots::fillAllPlots(const AnalysisEvent& event, const double eventWeight, std::vector<HistogramAccumulator>& accumulators) const
+{
+    // Values are shared through the event's cache with every other stage and
+    // systematic the event is plotted for
+    const auto& registry{PlotVariableRegistry::instance()};
     for (unsigned i{0}; i < plotPoint.size(); i++) {
-        if (plotPoint[i].fillPlot) {
-            for (const auto& val : (this->plotPoint[i].fillExp)(event)) {
-                plotPoint[i].plotHist->Fill(val, eventWeight);
+        if (!plotPoint[i].fillPlot) continue;
+
+        const unsigned id{plotPoint[i].variable};
+        const auto& variable{registry.variable(id)};
+        if (variable.fillScalar) {
+            const float val{event.derivedCache.scalar(id, variable.dependencies, variable.fillScalar, event)};
+            if (!std::isnan(val)) accumulators[i].fill(val, eventWeight);
+        }
+        else {
+            for (const auto& val : event.derivedCache.values(id, variable.dependencies, variable.fillVector, event)) {
+                accumulators[i].fill(val, eventWeight);
             }
         }
     }
 }
 
+void Plots::merge(const std::vector<HistogramAccumulator>& accumulators)
+{
+    for (unsigned i{0}; i < accumulators_.size(); i++)
+    {
+        accumulators_[i].merge(accumulators[i]);
+    }
+}
+
+void Plots::setWeightChannels(std::vector<std::shared_ptr<Plots>> channels)
+{
+    flush();
+    weightChannels_ = std::move(channels);
+    multiWeight_.clear();
+    channelWeights_.assign(weightChannels_.size() + 1, 0.);
+    if (weightChannels_.empty())
+    {
+        return;
+    }
+    for (const auto& channel : weightChannels_)
+    {
+        if (channel->plotPoint.size() != plotPoint.size())
+        {
+            throw std::logic_error("Weight channel plots don't match the nominal plots");
+        }
+    }
+    multiWeight_.reserve(binnings_.size());
+    for (const auto& binning : binnings_)
+    {
+        multiWeight_.emplace_back(AccumulatorAxis{binning.nBins, binning.min, binning.max}, weightChannels_.size() + 1);
+    }
+}
+
+void Plots::flush()
+{
+    // Only histograms with something to add are booked
+    for (unsigned i{0}; i < plotPoint.size(); i++)
+    {
+        if (accumulators_[i].empty())
+        {
+            continue;
+        }
+        accumulators_[i].addTo(*histogram(i));
+        accumulators_[i].reset();
+    }
+    // Channel 0 is the nominal
+    for (unsigned i{0}; i < multiWeight_.size(); i++)
+    {
+        if (multiWeight_[i].empty())
+        {
+            continue;
+        }
+        multiWeight_[i].addTo(*histogram(i), 0);
+        for (size_t k{0}; k < weightChannels_.size(); k++)
+        {
+            multiWeight_[i].addTo(*weightChannels_[k]->histogram(i), k + 1);
+        }
+        multiWeight_[i].reset();
+    }
+}
+
 void Plots::saveAllPlots()
 {
+    flush();
+    getPlotPoint();
     for (unsigned i{0}; i < plotPoint.size(); i++)
     {
         plotPoint[i].plotHist->SaveAs(("plots/" + plotPoint[i].name + ".pdf").c_str());
@@ -0,0 +1,91 @@
+#include "postLepSkim.hpp"
+
+#include "AnalysisEvent.hpp"
+#include "TDirectory.h"
+#include "TTree.h"
+
+#include <iostream>
+
+PostLepSkim::PostLepSkim(TTree* input, TDirectory* output, const std::vector<std::string>& branches)
+    : tree_{nullptr}
+    , selectionStep_{0}
+    , muonIndex_{}
+    , zPairIndex1_{-1}
+    , zPairIndex2_{-1}
+    , mumuTrkIndex_{-1}
+    , chsIndex_{}
+    , chsPairIndex1_{-1}
+    , chsPairIndex2_{-1}
+    , chsPairTrkIndex_{-1}
+    , jetIndex_{}
+{
+    // CloneTree only copies the active branches. The input is read in full
+    // again afterwards, as the selection may use branches which aren't kept.
+    input->SetBranchStatus("*", false);
+    for (const auto& branch : branches)
+    {
+        unsigned found{0};
+        input->SetBranchStatus(branch.c_str(), true, &found);
+        if (found == 0)
+        {
+            std::cerr << "Skim branch " << branch << " not in the input" << std::endl;
+        }
+    }
+    tree_ = input->CloneTree(0);
+    input->SetBranchStatus("*", true);
+    tree_->SetDirectory(output);
+
+    tree_->Branch("skimSelectionStep", &selectionStep_);
+    tree_->Branch("skimMuonIndex", &muonIndex_);
+    tree_->Branch("skimZPairIndex1", &zPairIndex1_);
+    tree_->Branch("skimZPairIndex2", &zPairIndex2_);
+    tree_->Branch("skimMumuTrkIndex", &mumuTrkIndex_);
+    tree_->Branch("skimChsIndex", &chsIndex_);
+    tree_->Branch("skimChsPairIndex1", &chsPairIndex1_);
+    tree_->Branch("skimChsPairIndex2", &chsPairIndex2_);
+    tree_->Branch("skimChsPairTrkIndex", &chsPairTrkIndex_);
+    tree_->Branch("skimJetIndex", &jetIndex_);
+}
+
+PostLepSkim::~PostLepSkim()
+{
+    delete tree_;
+}
+
+void PostLepSkim::fill(const AnalysisEvent& event, const Cuts::SelectionStep step)
+{
+    using Step = Cuts::SelectionStep;
+    if (step < Step::Muons)
+    {
+        return;
+    }
+
+    selectionStep_ = static_cast<int>(step);
+    muonIndex_ = event.muonIndexTight;
+    const bool dilepton{step >= Step::Dilepton};
+    zPairIndex1_ = dilepton ? event.zPairIndex.first : -1;
+    zPairIndex2_ = dilepton ? event.zPairIndex.second : -1;
+    mumuTrkIndex_ = dilepton ? event.mumuTrkIndex : -1;
+    if (step >= Step::ChargedHadrons)
+    {
+        chsIndex_ = event.chsIndex;
+    }
+    else
+    {
+        chsIndex_.clear();
+    }
+    const bool dihadron{step >= Step::Dihadron};
+    chsPairIndex1_ = dihadron ? event.chsPairIndex.first : -1;
+    chsPairIndex2_ = dihadron ? event.chsPairIndex.second : -1;
+    chsPairTrkIndex_ = dihadron ? event.chsPairTrkIndex : -1;
+    if (step >= Step::Jets)
+    {
+        jetIndex_ = event.jetIndex;
+    }
+    else
+    {
+        jetIndex_.clear();
+    }
+
+    tree_->Fill();
+}
@@ -1,38 +1,343 @@
 #include "AnalysisEvent.hpp"
+#include "config_parser.hpp"
+#include "eventDeduplicator.hpp"
+#include "outputPolicy.hpp"
 
 #include <TChain.h>
 #include <TFile.h>
+#include <TROOT.h>
 #include <TTree.h>
-#include <array>
+#include <algorithm>
+#include <atomic>
 #include <boost/filesystem.hpp>
 #include <boost/functional/hash.hpp>
-#include <boost/numeric/conversion/cast.hpp>
 #include <boost/program_options.hpp>
-#include <boost/progress.hpp>
 #include <boost/range/iterator_range.hpp>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <regex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 using namespace std::string_literals;
 namespace fs = boost::filesystem;
 
+// Each input file is skimmed into its own output file by a pool of worker
+// threads. Double lepton files go first, as single lepton events are only kept
+// if no double lepton file had them. A file is done once its marker,
+// <output>.done, exists. The marker is written aside and renamed, after the
+// output itself, so an interrupted run is resumed by running it again.
+// The double lepton events are looked up through an EventDeduplicator, which
+// can be checked against the set of run and event numbers used before it with
+// --checkDedup.
+
+namespace
+{
+using EventKey = std::pair<Int_t, Int_t>; // Run and event number
+using EventSet = std::unordered_set<EventKey, boost::hash<EventKey>>;
+using Event = EventDeduplicator::Event;
+
+struct SkimJob
+{
+    std::string input;
+    std::string output;
+};
+
+struct SkimResult
+{
+    bool ok;
+    bool resumed;
+    long long eventsIn;
+    long long eventsOut;
+    long long singleElectron;
+    long long dupElectron;
+    long long singleMuon;
+    long long dupMuon;
+    double seconds;
+    long long dedupMismatches;
+    std::string error;
+};
+
+// The marker holds the input the output was made from and its counts
+void writeMarker(const SkimJob& job, const SkimResult& result)
+{
+    const std::string marker{job.output + ".done"};
+    {
+        std::ofstream out{marker + ".tmp", std::ios::trunc};
+        out << "input " << job.input << "\neventsIn " << result.eventsIn << "\neventsOut " << result.eventsOut
+            << "\nsingleElectron " << result.singleElectron << "\ndupElectron " << result.dupElectron
+            << "\nsingleMuon " << result.singleMuon << "\ndupMuon " << result.dupMuon << "\n";
+        if (!out.flush())
+        {
+            throw std::runtime_error("Couldn't write " + marker);
+        }
+    }
+    fs::rename(marker + ".tmp", marker);
+}
+
+// Whether the job was done by an earlier run, filling in its counts if so
+bool readMarker(const SkimJob& job, SkimResult& result)
+{
+    std::ifstream in{job.output + ".done"};
+    if (!in || !fs::is_regular_file(job.output))
+    {
+        return false;
+    }
+    std::string input;
+    std::string key;
+    for (std::string line; std::getline(in, line);)
+    {
+        std::istringstream fields{line};
+        fields >> key;
+        if (key == "input")
+        {
+            fields >> input;
+        }
+        else if (key == "eventsIn")
+        {
+            fields >> result.eventsIn;
+        }
+        else if (key == "eventsOut")
+        {
+            fields >> result.eventsOut;
+        }
+        else if (key == "singleElectron")
+        {
+            fields >> result.singleElectron;
+        }
+        else if (key == "dupElectron")
+        {
+            fields >> result.dupElectron;
+        }
+        else if (key == "singleMuon")
+        {
+            fields >> result.singleMuon;
+        }
+        else if (key == "dupMuon")
+        {
+            fields >> result.dupMuon;
+        }
+    }
+    if (input != job.input)
+    {
+        std::cerr << "WARNING: " << job.output << " was made from " << input << ", remaking it from " << job.input
+                  << std::endl;
+        return false;
+    }
+    result.resumed = true;
+    return true;
+}
+
+Event dedupEvent(const Int_t run, const Float_t lumiblock, const Int_t event)
+{
+    return {run, static_cast<uint32_t>(lumiblock), static_cast<uint32_t>(event)};
+}
+
+// Run and event numbers of a finished skim, for double lepton files which
+// were done by an earlier run
+void readEvents(const std::string& file, std::vector<Event>& events)
+{
+    TChain chain{"tree"};
+    chain.Add(file.c_str());
+    chain.SetBranchStatus("*", false);
+    chain.SetBranchStatus("eventRun", true);
+    chain.SetBranchStatus("eventNum", true);
+    chain.SetBranchStatus("eventLumiblock", true);
+    Int_t eventRun;
+    Int_t eventNum;
+    Float_t eventLumiblock;
+    chain.SetBranchAddress("eventRun", &eventRun);
+    chain.SetBranchAddress("eventNum", &eventNum);
+    chain.SetBranchAddress("eventLumiblock", &eventLumiblock);
+    const long long numberOfEvents{chain.GetEntries()};
+    for (long long i{0}; i < numberOfEvents; i++)
+    {
+        chain.GetEntry(i);
+        events.push_back(dedupEvent(eventRun, eventLumiblock, eventNum));
+    }
+}
+
+// Skims one file. Double lepton events passing are added to passing, single
+// lepton ones are checked against dileptonEvents, and against checkEvents if
+// not null.
+SkimResult skimFile(const SkimJob& job,
+                    const std::string& channel,
+                    const bool singleLepton,
+                    const bool is2016,
+                    const bool is2018,
+                    const EventDeduplicator& dileptonEvents,
+                    const EventSet* const checkEvents,
+                    const Parser::OutputPolicy& outputPolicy,
+                    std::vector<Event>& passing)
+{
+    SkimResult result{true, false, 0, 0, 0, 0, 0, 0, 0., 0, ""};
+
+    TChain datasetChain{"tree"};
+    datasetChain.Add(job.input.c_str());
+
+    // Written aside, so that a partial output is never taken as done
+    const std::string tmpOutput{job.output + ".tmp"};
+    TFile outFile{tmpOutput.c_str(), "RECREATE"};
+    if (outFile.IsZombie())
+    {
+        throw std::runtime_error("Couldn't create " + tmpOutput);
+    }
+    TTree* const outTree{datasetChain.CloneTree(0)};
+    applyOutputPolicy(outputPolicy, outTree);
+
+    result.eventsIn = datasetChain.GetEntries();
+    // Far too large for a thread's stack
+    std::unique_ptr<AnalysisEvent> event{new AnalysisEvent{false, &datasetChain, is2016, is2018}};
+
+    for (long long int i{0}; i < result.eventsIn; i++)
+    {
+        event->GetEntry(i);
+
+        if (!singleLepton)
+        {
+            bool trigger{false};
+            if (channel == "ee")
+            {
+                // clang-format off
+//                trigger = event->eeTrig();
+                // clang-format on
+            }
+            if (channel == "mumu")
+            {
+                trigger = event->mumuTrig();
+            }
+            if (channel == "emu")
+            {
+//                trigger = event->muEGTrig();
+            }
+
+            if (trigger)
+            {
+                passing.push_back(dedupEvent(event->eventRun, event->eventLumiblock, event->eventNum));
+                outTree->Fill();
+            }
+            continue;
+        }
+
+        // clang-format off
+//        const bool eTrig{(channel == "ee" || channel == "emu") && event->eTrig()};
+        const bool eTrig{false};
+        // clang-format on
+        const bool muTrig{(channel == "mumu" || channel == "emu") && event->muTrig()};
+
+        // If a single lepton trigger fired, check to see if the event also
+        // fired a double lepton trigger
+        if (eTrig || muTrig)
+        {
+            if (eTrig)
+            {
+                result.singleElectron++;
+            }
+            if (muTrig)
+            {
+                result.singleMuon++;
+            }
+            // If event has already been found ... skip event
+            const bool duplicate{dileptonEvents.contains(dedupEvent(event->eventRun, event->eventLumiblock, event->eventNum))};
+            if (checkEvents && duplicate != (checkEvents->count({event->eventRun, event->eventNum}) > 0))
+            {
+                result.dedupMismatches++;
+            }
+            if (duplicate)
+            {
+                if (eTrig)
+                {
+                    result.dupElectron++;
+                }
+                if (muTrig)
+                {
+                    result.dupMuon++;
+                }
+            }
+            // If event has not already been found, add to new skim
+            else
+            {
+                outTree->Fill();
+            }
+        }
+    }
+    result.eventsOut = outTree->GetEntries();
+
+    outFile.cd();
+    outTree->Write();
+    outFile.Close();
+    fs::rename(tmpOutput, job.output);
+    return result;
+}
+
+// Runs the jobs over the workers, taking the next job as each one finishes
+template <typename Work>
+void runQueue(const size_t numJobs, const unsigned workers, Work work)
+{
+    std::atomic<size_t> next{0};
+    const auto worker{[&next, numJobs, &work]() {
+        for (size_t i{next++}; i < numJobs; i = next++)
+        {
+            work(i);
+        }
+    }};
+    std::vector<std::thread> threads;
+    for (unsigned i{0}; i < std::min<size_t>(workers, numJobs); i++)
+    {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// ROOT files of the directories, sorted so that the output numbering doesn't
+// depend on the directory order
+std::vector<std::string> inputFiles(const std::vector<std::string>& dirs)
+{
+    const std::regex mask{".*\\.root"};
+    std::vector<std::string> files;
+    for (const auto& dir : dirs)
+    {
+        std::vector<std::string> dirFiles;
+        for (const auto& file : boost::make_iterator_range(fs::directory_iterator{dir}, {}))
+        {
+            const std::string path{file.path().string()};
+            if (fs::is_regular_file(file.status()) && std::regex_match(path, mask))
+            {
+                dirFiles.push_back(path);
+            }
+        }
+        std::sort(dirFiles.begin(), dirFiles.end());
+        files.insert(files.end(), dirFiles.begin(), dirFiles.end());
+    }
+    return files;
+}
+} // namespace
+
 int main(int argc, char* argv[])
 {
     std::vector<std::string> dileptonDirs;
     std::vector<std::string> singleLeptonDirs;
     std::string datasetName;
     std::string channel;
+    std::string outputDir;
+    unsigned workers;
+    size_t dedupMemory;
+    std::string spillDir;
+    bool checkDedup;
+    std::string outputPolicyName;
     bool is2016_;
     bool is2018_;
 
-    int singleElectron{0};
-    int dupElectron{0};
-    int singleMuon{0};
-    int dupMuon{0};
-
     // Define command-line flags
     namespace po = boost::program_options;
     po::options_description desc("Options");
@@ -54,7 +359,32 @@ int main(int argc, char* argv[])
         "Directories in which to look for single lepton datasets.")(
         "datasetName,o",
         po::value<std::string>(&datasetName)->required(),
-        "Output dataset name.");
+        "Output dataset name.")(
+        "outputDir",
+        po::value<std::string>(&outputDir),
+        "Directory in which the output dataset directory is made. Defaults to "
+        "/data0/data/TopPhysics/postTriggerSkims<era>, with the dataset name "
+        "appended to it.")(
+        "jobs,j",
+        po::value<unsigned>(&workers)->default_value(std::max(1u, std::thread::hardware_concurrency())),
+        "Number of files skimmed at once.")(
+        "dedupMemory",
+        po::value<size_t>(&dedupMemory)->default_value(2048),
+        "Memory in MB for the double lepton events, beyond which they are "
+        "kept in --spillDir. Unlimited without --spillDir.")(
+        "spillDir",
+        po::value<std::string>(&spillDir),
+        "Directory for the double lepton events which don't fit in "
+        "--dedupMemory.")(
+        "checkDedup",
+        po::bool_switch(&checkDedup),
+        "Also keep every double lepton run and event number in a hash set, "
+        "as before the deduplicator, and fail if the two disagree on any "
+        "event.")(
+        "outputPolicy",
+        po::value<std::string>(&outputPolicyName),
+        "Compression and basket sizes of the skims, e.g. made by "
+        "tuneCompression.exe.");
     po::variables_map vm;
 
     // Parse arguments
@@ -76,6 +406,10 @@ int main(int argc, char* argv[])
                 "condition to be BOTH 2016 AND 2018! Chose only "
                 " one or none!");
         }
+        if (workers == 0)
+        {
+            throw po::invalid_option_value("0");
+        }
     }
     catch (const po::error& e)
     {
@@ -87,280 +421,160 @@ int main(int argc, char* argv[])
     if (is2016_) era = "2016";
     else if (is2018_) era = "2018";
     else era = "2017";
-    const std::string postTriggerSkimDir{"/data0/data/TopPhysics/postTriggerSkims" + era};
-
-    const std::regex mask{".*\\.root"};
-    int fileNum{0};
-
-    std::unordered_set<std::pair<int, int>,
-                       boost::hash<std::pair<Int_t, Int_t>>>
-        triggerDoubleCountCheck;
-
-    for (const auto& dileptonDir : dileptonDirs)
-    { // for each dilepton input directory
-        for (const auto& file : boost::make_iterator_range(
-                 fs::directory_iterator{dileptonDir}, {}))
-        { // for each file in directory
-            const std::string path{file.path().string()};
-            std::cout << "path: " << path << std::endl;
-
-            if (!fs::is_regular_file(file.status())
-                || !std::regex_match(path, mask))
-            {
-                continue; // skip if not a root file
-            }
-
-            const std::string numName{std::to_string(fileNum)};
-            const std::string numNamePlus{std::to_string(fileNum + 2)};
-
-            if (fs::is_regular_file(postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numNamePlus + ".root"))
-            {
-                // don't overwrite existing skim files, except for the last two
-                fileNum++;
-                continue;
-            }
-
-            TChain datasetChain{"tree"};
-            datasetChain.Add(path.c_str());
-
-            TTree* const outTree = datasetChain.CloneTree(0);
-
-            std::string outFilePath{postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numName + ".root"};
-            TFile outFile{outFilePath.c_str(), "RECREATE"};
-
-            const long long int numberOfEvents{datasetChain.GetEntries()};
-
-            boost::progress_display progress{
-                boost::numeric_cast<unsigned long>(numberOfEvents),
-                std::cout,
-                outFilePath + "\n"};
-            AnalysisEvent event{false, &datasetChain, is2016_, is2018_};
-
-            for (long long int i{0}; i < numberOfEvents; i++)
-            {
-                ++progress; // update progress bar (++ must be prefix)
-                event.GetEntry(i);
-
-                if (channel == "ee")
-                {
-                    // clang-format off
-//                    const bool eeTrig{event.eeTrig()};
-                    const bool eeTrig{false};
-                    // clang-format on
-
-                    if (eeTrig)
-                    {
-                        triggerDoubleCountCheck.emplace(event.eventRun,
-                                                        event.eventNum);
-                        outTree->Fill();
-                    }
-                }
-
-                if (channel == "mumu")
-                {
-                    const bool mumuTrig{event.mumuTrig()};
-
-                    if (mumuTrig)
-                    {
-                        triggerDoubleCountCheck.emplace(event.eventRun,
-                                                        event.eventNum);
-                        outTree->Fill();
-                    }
-                }
-
-                if (channel == "emu")
-                {
-//                    const bool muEGTrig{event.muEGTrig()};
-                    const bool muEGTrig{false};
-
-                    if (muEGTrig)
-                    {
-                        triggerDoubleCountCheck.emplace(event.eventRun,
-                                                        event.eventNum);
-                        outTree->Fill();
-                    }
-                } // end emu
-            }
-            outFile.cd();
-            outTree->Write();
-
-            outFile.Write();
-            outFile.Close();
-
-            fileNum++;
-            std::cout << std::endl;
-
-            delete outTree;
+    const std::string postTriggerSkimDir{outputDir.empty() ? "/data0/data/TopPhysics/postTriggerSkims" + era + datasetName
+                                                           : (fs::path{outputDir} / datasetName).string()};
+    fs::create_directories(postTriggerSkimDir);
+    const Parser::OutputPolicy outputPolicy{outputPolicyName.empty() ? Parser::OutputPolicy{-1, -1, {}}
+                                                                     : Parser::parse_output_policy(outputPolicyName)};
+
+    // Numbered across the double then single lepton files, as before
+    const std::vector<std::string> dileptonFiles{inputFiles(dileptonDirs)};
+    const std::vector<std::string> singleLeptonFiles{inputFiles(singleLeptonDirs)};
+    std::vector<SkimJob> jobs;
+    for (const auto& files : {dileptonFiles, singleLeptonFiles})
+    {
+        for (const auto& file : files)
+        {
+            jobs.push_back({file, postTriggerSkimDir + "/triggerSkim" + std::to_string(jobs.size()) + ".root"});
         }
     }
 
-    for (const auto& singleLeptonDir : singleLeptonDirs)
-    { // for each single lepton input directory
-        for (const auto& file : boost::make_iterator_range(
-                 fs::directory_iterator{singleLeptonDir}, {}))
-        { // for each file in directory
-            const std::string path{file.path().string()};
-            std::cout << "path: " << path << std::endl;
-
-            if (!fs::is_regular_file(file.status())
-                || !std::regex_match(path, mask))
+    ROOT::EnableThreadSafety();
+    std::vector<SkimResult> results(jobs.size());
+    EventDeduplicator triggerDoubleCountCheck{dedupMemory * 1024 * 1024, spillDir};
+    EventSet checkEvents;
+    std::mutex mutex; // For checkEvents and the output
+    size_t finished{0};
+
+    const auto runJob{[&](const size_t i) {
+        const bool singleLepton{i >= dileptonFiles.size()};
+        const auto start{std::chrono::steady_clock::now()};
+        SkimResult result{true, false, 0, 0, 0, 0, 0, 0, 0., 0, ""};
+        std::vector<Event> passing;
+        try
+        {
+            if (!readMarker(jobs[i], result))
             {
-                continue; // skip if not a root file
+                result = skimFile(jobs[i],
+                                  channel,
+                                  singleLepton,
+                                  is2016_,
+                                  is2018_,
+                                  triggerDoubleCountCheck,
+                                  checkDedup ? &checkEvents : nullptr,
+                                  outputPolicy,
+                                  passing);
+                writeMarker(jobs[i], result);
             }
-
-            const std::string numName{std::to_string(fileNum)};
-            const std::string numNamePlus{std::to_string(fileNum + 2)};
-
-            if (fs::is_regular_file(postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numNamePlus + ".root"))
+            else if (!singleLepton)
             {
-                // don't overwrite existing skim files, except for the last two
-                fileNum++;
-                continue;
+                readEvents(jobs[i].output, passing);
             }
+        }
+        catch (const std::exception& e)
+        {
+            result.ok = false;
+            result.error = e.what();
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!singleLepton)
+        {
+            triggerDoubleCountCheck.add(passing);
+        }
 
-            TChain datasetChain{"tree"};
-            datasetChain.Add(path.c_str());
-            TTree* const outTree = datasetChain.CloneTree(0);
-
-            std::string outFilePath{postTriggerSkimDir + datasetName
-                                    + "/triggerSkim" + numName + ".root"};
-            TFile outFile{outFilePath.c_str(), "RECREATE"};
-
-            const long long int numberOfEvents{datasetChain.GetEntries()};
-
-            boost::progress_display progress{
-                boost::numeric_cast<unsigned long>(numberOfEvents),
-                std::cout,
-                outFilePath + "\n"};
-            AnalysisEvent event{false, &datasetChain, is2016_, is2018_};
-
-            for (long long int i{0}; i < numberOfEvents; i++)
+        std::lock_guard<std::mutex> lock{mutex};
+        if (!singleLepton && checkDedup)
+        {
+            for (const auto& event : passing)
             {
-                ++progress; // update progress bar (++ must be prefix)
-                event.GetEntry(i);
-                if (channel == "ee")
-                {
-//                    const bool eTrig{event.eTrig()};
-                    const bool eTrig{false};
-                    if (eTrig)
-                    {
-                        auto it{triggerDoubleCountCheck.find(
-                            {event.eventRun, event.eventNum})};
-                        singleElectron++;
-                        // If event has already been found ... skip event
-                        if (it != triggerDoubleCountCheck.end())
-                        {
-                            dupElectron++;
-                        }
-                        // If event has not already been found, add to new skim
-                        else
-                        {
-                            // triggerDoubleCountCheck.emplace(
-                            // event.eventRun, event.eventNum);
-                            outTree->Fill();
-                        }
-                    }
-                } // end single electron check for ee
-
-                if (channel == "mumu")
-                {
-                    const bool muTrig{event.muTrig()};
-
-                    // If single Muon triggered fired, check to see if event
-                    // also fired a DoubleMuon trigger
-                    if (muTrig)
-                    {
-                        singleMuon++;
-                        auto it{triggerDoubleCountCheck.find(
-                            {event.eventRun, event.eventNum})};
-                        // If event has already been found ... skip event
-                        if (it != triggerDoubleCountCheck.end())
-                        {
-                            dupMuon++;
-                        }
-                        // If event has not already been found, add to new skim
-                        else
-                        {
-                            // triggerDoubleCountCheck.emplace(
-                            // event.eventRun, event.eventNum);
-                            outTree->Fill();
-                        }
-                    }
-
-                } // end single muon check for mumu
-
-                if (channel == "emu")
-                {
-                    // check eTrigger for emu first
-                    // clang-format off
-//                    const bool eTrig{event.eTrig()};
-                    const bool eTrig{false};
-                    // then check muTrigger for emu
-                    const bool muTrig{event.muTrig()};
-                    // clang-format on
-
-                    // If either single lepton  triggered fired, check to see if
-                    // event also fired a MuonEG trigger
-                    if (eTrig || muTrig)
-                    {
-                        if (eTrig)
-                        {
-                            singleElectron++;
-                        }
-                        if (muTrig)
-                        {
-                            singleMuon++;
-                        }
-                        auto it{triggerDoubleCountCheck.find(
-                            {event.eventRun, event.eventNum})};
-                        // If event has already been found ... skip event
-                        if (it != triggerDoubleCountCheck.end())
-                        {
-                            if (eTrig)
-                            {
-                                dupElectron++;
-                            }
-                            if (muTrig)
-                            {
-                                dupMuon++;
-                            }
-                        }
-                        // If event has not already been found, add to new skim
-                        else
-                        {
-                            // triggerDoubleCountCheck.emplace(
-                            // event.eventRun, event.eventNum);
-                            outTree->Fill();
-                        }
-                    }
-                } // end single lepton check for emu
+                checkEvents.emplace(event.run, static_cast<Int_t>(event.event));
             }
-            outFile.cd();
-            outTree->Write();
-
-            outFile.Write();
-            outFile.Close();
-
-            fileNum++;
-            std::cout << std::endl;
+        }
+        results[i] = result;
+        std::cout << "[" << ++finished << "/" << jobs.size() << "] " << jobs[i].input << " -> " << jobs[i].output;
+        if (!result.ok)
+        {
+            std::cout << " FAILED: " << result.error;
+        }
+        else if (result.resumed)
+        {
+            std::cout << " (done before)";
+        }
+        std::cout << std::endl;
+    }};
+
+    // The single lepton files need every double lepton event, so can't be
+    // skimmed if any double lepton file failed
+    runQueue(dileptonFiles.size(), workers, runJob);
+    triggerDoubleCountCheck.freeze();
+    std::cout << triggerDoubleCountCheck.size() << " double lepton events, using "
+              << triggerDoubleCountCheck.bytes() / (1024 * 1024) << " MB" << std::endl;
+    const bool dileptonFailed{std::any_of(results.begin(),
+                                          results.begin() + static_cast<std::ptrdiff_t>(dileptonFiles.size()),
+                                          [](const SkimResult& result) { return !result.ok; })};
+    if (!dileptonFailed)
+    {
+        runQueue(singleLeptonFiles.size(), workers, [&runJob, &dileptonFiles](const size_t i) {
+            runJob(dileptonFiles.size() + i);
+        });
+    }
+    else
+    {
+        for (size_t i{dileptonFiles.size()}; i < jobs.size(); i++)
+        {
+            results[i].error = "not skimmed, as a double lepton file failed";
+        }
+    }
 
-            delete outTree;
+    std::cout << "\nEvents in, events out, seconds, file" << std::endl;
+    SkimResult total{true, false, 0, 0, 0, 0, 0, 0, 0., 0, ""};
+    unsigned failed{0};
+    for (size_t i{0}; i < jobs.size(); i++)
+    {
+        const SkimResult& result{results[i]};
+        if (!result.ok)
+        {
+            failed++;
+            std::cout << "FAILED " << jobs[i].input << ": " << result.error << std::endl;
+            continue;
         }
+        std::cout << result.eventsIn << "\t" << result.eventsOut << "\t"
+                  << (result.resumed ? "done before" : std::to_string(static_cast<long long>(result.seconds))) << "\t"
+                  << jobs[i].input << std::endl;
+        total.eventsIn += result.eventsIn;
+        total.eventsOut += result.eventsOut;
+        total.singleElectron += result.singleElectron;
+        total.dupElectron += result.dupElectron;
+        total.singleMuon += result.singleMuon;
+        total.dupMuon += result.dupMuon;
+        total.dedupMismatches += result.dedupMismatches;
     }
+    std::cout << total.eventsIn << "\t" << total.eventsOut << "\t\tTotal of " << jobs.size() - failed << " files"
+              << std::endl;
 
     if (channel == "ee" || channel == "emu")
     {
         std::cout << "Single electron trigger fired with double lepton "
                      "trigger/Total single electron triggers fired: "
-                  << dupElectron << " / " << singleElectron << std::endl;
+                  << total.dupElectron << " / " << total.singleElectron << std::endl;
     }
     if (channel == "mumu" || channel == "emu")
     {
         std::cout << "Single muon trigger fired with double lepton "
                      "trigger/Total single muon triggers fired: "
-                  << dupMuon << " / " << singleMuon << std::endl;
+                  << total.dupMuon << " / " << total.singleMuon << std::endl;
+    }
+    if (checkDedup)
+    {
+        std::cout << "Lookups where the deduplicator and hash set disagree: " << total.dedupMismatches << std::endl;
+    }
+    if (failed)
+    {
+        std::cerr << failed << " files failed, run again to retry them" << std::endl;
+        return 1;
+    }
+    if (total.dedupMismatches > 0)
+    {
+        return 1;
     }
 }
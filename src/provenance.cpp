@@ -0,0 +1,86 @@
+#include "provenance.hpp"
+
+#include "fingerprint.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+// Set by the makefile
+#ifndef HTOSS_CODE_VERSION
+#define HTOSS_CODE_VERSION "unknown"
+#endif
+
+std::string Provenance::codeVersion()
+{
+    return HTOSS_CODE_VERSION;
+}
+
+void Provenance::addFile(Fingerprint& fingerprint, const std::string& file)
+{
+    fingerprint.add(file);
+    std::ifstream in{file, std::ios::binary};
+    const std::string contents{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    fingerprint.add(contents);
+}
+
+void Provenance::addInputs(Fingerprint& fingerprint, const std::vector<std::string>& locations)
+{
+    for (const auto& location : locations)
+    {
+        // Sorted, as directory order isn't stable
+        std::vector<fs::path> files;
+        if (fs::is_directory(location))
+        {
+            for (const auto& entry : boost::make_iterator_range(fs::directory_iterator{location}, {}))
+            {
+                if (entry.path().extension() == ".root")
+                {
+                    files.push_back(entry.path());
+                }
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        fingerprint.add(location).add(files.size());
+        for (const auto& file : files)
+        {
+            fingerprint.add(file.filename().string())
+                .add(static_cast<unsigned long long>(fs::file_size(file)))
+                .add(static_cast<long long>(fs::last_write_time(file)));
+        }
+    }
+}
+
+std::string Provenance::read(const std::string& file)
+{
+    std::ifstream in{file + ".provenance"};
+    std::string hash;
+    in >> hash;
+    return hash;
+}
+
+bool Provenance::matches(const std::string& file, const std::string& hash)
+{
+    return fs::exists(file) && read(file) == hash;
+}
+
+void Provenance::stamp(const std::string& file, const std::string& hash)
+{
+    const std::string stampFile{file + ".provenance"};
+    {
+        std::ofstream out{stampFile + ".tmp", std::ios::trunc};
+        out << hash << "\nMade by " << codeVersion() << "\n";
+        if (!out.flush())
+        {
+            throw std::runtime_error("Couldn't write the provenance of " + file);
+        }
+    }
+    fs::rename(stampFile + ".tmp", stampFile);
+}
@@ -13,6 +13,7 @@
 #include "TLorentzVector.h"
 #include "TString.h"
 #include "config_parser.hpp"
+#include "deltaRKernel.hpp"
 
 #include <boost/filesystem.hpp>
 #include <boost/functional/hash.hpp>
@@ -1092,12 +1093,6 @@ bool scalarGrandparent (const AnalysisEvent& event, const Int_t& k, const Int_t&
 }
 
 float deltaR(float eta1, float phi1, float eta2, float phi2){
-  float dEta = eta1-eta2;
-  float dPhi = phi1-phi2;
-  while (fabs(dPhi) > 3.14159265359){
-    dPhi += (dPhi > 0.? -2*3.14159265359:2*3.14159265359);
-  }
-  //  if(singleEventInfoDump_)  std::cout << eta1 << " " << eta2 << " phi " << phi1 << " " << phi2 << " ds: " << eta1-eta2 << " " << phi1-phi2 << " dR: " << std::sqrt((dEta*dEta)+(dPhi*dPhi)) << std::endl;
-  return std::sqrt((dEta*dEta)+(dPhi*dPhi));
+  return std::sqrt(DeltaR::deltaR2(eta1, phi1, eta2, phi2));
 }
 
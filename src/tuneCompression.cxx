@@ -0,0 +1,363 @@
+#include "Compression.h"
+#include "RVersion.h"
+#include "TBranch.h"
+#include "TChain.h"
+#include "TFile.h"
+#include "TObjArray.h"
+#include "TTree.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Makes an output policy, as read by --outputPolicy of analysisMain.exe,
+// makeMVAinputMain.exe and postTriggerSkimmer.exe, from a sample of a tree.
+// The sample is written once with every candidate algorithm and level, and
+// each branch is then read back on its own:
+//  - Branches matching --hot, i.e. read for every event, take the setting
+//    quickest to read back among those within --hotSizeSlack of the
+//    smallest, and baskets of --hotBasketEntries entries.
+//  - The rest take the smallest setting, and baskets of --coldBasketEntries.
+// Branches with no rule in the policy take the setting which is smallest
+// over the whole tree.
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace
+{
+// zstd first came in ROOT 6.20
+const std::map<std::string, ROOT::ECompressionAlgorithm> algorithms{
+    {"zlib", ROOT::kZLIB}, {"lzma", ROOT::kLZMA}, {"lz4", ROOT::kLZ4},
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 20, 0)
+    {"zstd", ROOT::kZSTD},
+#endif
+};
+
+struct Candidate
+{
+    std::string algorithm;
+    int level;
+    int settings;
+};
+
+struct Measurement
+{
+    long long zipBytes;
+    long long totBytes;
+    double readSeconds;
+};
+
+// Writes the sample with the candidate's settings, then reads back each
+// branch of it
+std::map<std::string, Measurement> measure(TChain& input,
+                                           const std::vector<long long>& sample,
+                                           const Candidate& candidate,
+                                           const std::string& file)
+{
+    std::string treeName;
+    {
+        TFile out{file.c_str(), "RECREATE"};
+        if (out.IsZombie())
+        {
+            throw std::runtime_error("Couldn't create " + file);
+        }
+        out.SetCompressionSettings(candidate.settings);
+        TTree* copy{input.CloneTree(0)};
+        copy->SetDirectory(&out);
+        treeName = copy->GetName();
+        for (const long long entry : sample)
+        {
+            input.GetEntry(entry);
+            copy->Fill();
+        }
+        out.Write();
+        out.Close();
+    }
+
+    std::map<std::string, Measurement> measurements;
+    {
+        TFile in{file.c_str(), "READ"};
+        TTree* tree{nullptr};
+        in.GetObject(treeName.c_str(), tree);
+        if (!tree)
+        {
+            throw std::runtime_error("No tree " + treeName + " in " + file);
+        }
+        const long long entries{tree->GetEntries()};
+        const TObjArray* branches{tree->GetListOfBranches()};
+        for (int i{0}; i < branches->GetEntriesFast(); i++)
+        {
+            TBranch* branch{static_cast<TBranch*>(branches->At(i))};
+            const auto start{std::chrono::steady_clock::now()};
+            for (long long entry{0}; entry < entries; entry++)
+            {
+                branch->GetEntry(entry);
+            }
+            const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+            measurements[branch->GetName()] = {branch->GetZipBytes("*"), branch->GetTotBytes("*"), elapsed.count()};
+        }
+    }
+    fs::remove(file);
+    return measurements;
+}
+
+void emitCompression(YAML::Emitter& out, const Candidate& candidate)
+{
+    out << YAML::Flow << YAML::BeginMap;
+    out << YAML::Key << "algorithm" << YAML::Value << candidate.algorithm;
+    out << YAML::Key << "level" << YAML::Value << candidate.level;
+    out << YAML::EndMap;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> inputs;
+    std::string treeName;
+    std::string outputFile;
+    long long sampleSize;
+    std::vector<std::string> algorithmNames;
+    std::vector<std::string> allAlgorithms;
+    std::string allAlgorithmsText;
+    for (const auto& algorithm : algorithms)
+    {
+        allAlgorithms.push_back(algorithm.first);
+        allAlgorithmsText += (allAlgorithmsText.empty() ? "" : " ") + algorithm.first;
+    }
+    std::vector<int> levels;
+    std::vector<std::string> hot;
+    double hotSizeSlack;
+    int hotBasketEntries;
+    int coldBasketEntries;
+    std::string workDir;
+
+    po::options_description desc{"Options"};
+    desc.add_options()("help,h", "Print this message.")(
+        "input,i",
+        po::value<std::vector<std::string>>(&inputs)->multitoken()->required(),
+        "Files of the tree to sample, e.g. a skim or MVA tree like those the "
+        "policy is for.")(
+        "tree,t",
+        po::value<std::string>(&treeName)->default_value("tree"),
+        "Name of the tree.")(
+        "output,o",
+        po::value<std::string>(&outputFile)->required(),
+        "Output policy YAML.")(
+        "events,n",
+        po::value<long long>(&sampleSize)->default_value(5000),
+        "Entries sampled, evenly spread over the inputs.")(
+        "algorithms",
+        po::value<std::vector<std::string>>(&algorithmNames)->multitoken()->default_value(allAlgorithms, allAlgorithmsText),
+        "Candidate compression algorithms, by default all those this ROOT "
+        "has.")(
+        "levels",
+        po::value<std::vector<int>>(&levels)->multitoken()->default_value({1, 4, 9}, "1 4 9"),
+        "Candidate compression levels of each algorithm.")(
+        "hot",
+        po::value<std::vector<std::string>>(&hot)->multitoken(),
+        "Branches read for every event, e.g. by the selection. Wildcards "
+        "allowed.")(
+        "hotSizeSlack",
+        po::value<double>(&hotSizeSlack)->default_value(1.5),
+        "How much larger than the smallest a hot branch may be made for "
+        "quicker reading.")(
+        "hotBasketEntries",
+        po::value<int>(&hotBasketEntries)->default_value(1000),
+        "Entries per basket of hot branches, small enough not to decompress "
+        "much more than is read when skipping entries.")(
+        "coldBasketEntries",
+        po::value<int>(&coldBasketEntries)->default_value(10000),
+        "Entries per basket of the other branches, larger ones compressing "
+        "better.")(
+        "workDir",
+        po::value<std::string>(&workDir)->default_value(fs::temp_directory_path().string()),
+        "Directory for the sample written with each candidate.");
+    po::positional_options_description positional;
+    positional.add("input", -1);
+    po::variables_map vm;
+
+    std::vector<Candidate> candidates;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc;
+            return 0;
+        }
+
+        po::notify(vm);
+        for (const auto& algorithm : algorithmNames)
+        {
+            const auto found{algorithms.find(algorithm)};
+            if (found == algorithms.end() && algorithm == "zstd")
+            {
+                throw po::error(std::string{"zstd needs ROOT 6.20 or later, but this is ROOT "} + ROOT_RELEASE);
+            }
+            if (found == algorithms.end())
+            {
+                throw po::invalid_option_value(algorithm);
+            }
+            for (const int level : levels)
+            {
+                candidates.push_back({algorithm, level, ROOT::CompressionSettings(found->second, level)});
+            }
+        }
+        if (candidates.empty() || sampleSize < 1)
+        {
+            throw po::error("Nothing to sample");
+        }
+    }
+    catch (const po::error& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        TChain input{treeName.c_str()};
+        for (const auto& file : inputs)
+        {
+            input.Add(file.c_str());
+        }
+        const long long entries{input.GetEntries()};
+        if (entries == 0)
+        {
+            throw std::runtime_error("No entries of " + treeName + " to sample");
+        }
+        const long long step{std::max(1LL, entries / sampleSize)};
+        std::vector<long long> sample;
+        for (long long entry{0}; entry < entries && static_cast<long long>(sample.size()) < sampleSize; entry += step)
+        {
+            sample.push_back(entry);
+        }
+
+        std::vector<std::map<std::string, Measurement>> measurements;
+        for (const auto& candidate : candidates)
+        {
+            std::cout << "Writing " << sample.size() << " entries with " << candidate.algorithm << " level "
+                      << candidate.level << std::endl;
+            measurements.push_back(
+                measure(input, sample, candidate, (fs::path{workDir} / fs::unique_path("tune%%%%-%%%%-%%%%.root")).string()));
+        }
+
+        // The default is the smallest over the whole tree
+        size_t defaultCandidate{0};
+        long long smallestTotal{-1};
+        for (size_t i{0}; i < candidates.size(); i++)
+        {
+            long long total{0};
+            for (const auto& branch : measurements[i])
+            {
+                total += branch.second.zipBytes;
+            }
+            if (smallestTotal < 0 || total < smallestTotal)
+            {
+                smallestTotal = total;
+                defaultCandidate = i;
+            }
+        }
+
+        std::ostringstream inputList;
+        for (const auto& file : inputs)
+        {
+            inputList << " " << file;
+        }
+        YAML::Emitter out;
+        out << YAML::Comment("Output policy made by tuneCompression.exe from " + std::to_string(sample.size())
+                             + " entries of " + treeName + " in" + inputList.str());
+        out << YAML::BeginMap;
+        out << YAML::Key << "compression" << YAML::Value;
+        emitCompression(out, candidates[defaultCandidate]);
+        out << YAML::Key << "branches" << YAML::Value << YAML::BeginSeq;
+
+        std::cout << std::left << std::setw(40) << "Branch" << std::setw(6) << "Hot" << std::setw(12) << "Setting"
+                  << std::right << std::setw(14) << "Bytes/entry" << std::setw(14) << "us/entry" << std::endl;
+        for (const auto& branch : measurements.front())
+        {
+            const std::string& name{branch.first};
+            const bool isHot{std::any_of(hot.begin(), hot.end(), [&name](const std::string& pattern) {
+                return fnmatch(pattern.c_str(), name.c_str(), 0) == 0;
+            })};
+
+            long long smallest{-1};
+            for (const auto& candidate : measurements)
+            {
+                const long long zipBytes{candidate.at(name).zipBytes};
+                smallest = smallest < 0 ? zipBytes : std::min(smallest, zipBytes);
+            }
+            size_t chosen{0};
+            for (size_t i{1}; i < candidates.size(); i++)
+            {
+                const Measurement& current{measurements[i].at(name)};
+                const Measurement& best{measurements[chosen].at(name)};
+                if (isHot)
+                {
+                    const bool small{current.zipBytes <= hotSizeSlack * static_cast<double>(smallest)};
+                    const bool bestSmall{best.zipBytes <= hotSizeSlack * static_cast<double>(smallest)};
+                    if (small && (!bestSmall || current.readSeconds < best.readSeconds))
+                    {
+                        chosen = i;
+                    }
+                }
+                else if (current.zipBytes < best.zipBytes
+                         || (current.zipBytes == best.zipBytes && current.readSeconds < best.readSeconds))
+                {
+                    chosen = i;
+                }
+            }
+
+            const Measurement& result{measurements[chosen].at(name)};
+            const double entryBytes{static_cast<double>(result.totBytes) / static_cast<double>(sample.size())};
+            const int basketEntries{isHot ? hotBasketEntries : coldBasketEntries};
+            const int basketSize{static_cast<int>(std::min(std::max(entryBytes * basketEntries, 4096.), 4194304.))};
+            const double zipPerEntry{static_cast<double>(result.zipBytes) / static_cast<double>(sample.size())};
+            const double microsPerEntry{result.readSeconds * 1e6 / static_cast<double>(sample.size())};
+
+            std::ostringstream summary;
+            summary << std::fixed << std::setprecision(2) << (isHot ? "hot, " : "cold, ") << zipPerEntry
+                    << " bytes and " << microsPerEntry << " us per entry";
+            out << YAML::BeginMap;
+            out << YAML::Key << "pattern" << YAML::Value << name;
+            out << YAML::Key << "compression" << YAML::Value;
+            emitCompression(out, candidates[chosen]);
+            out << YAML::Key << "basketSize" << YAML::Value << basketSize;
+            out << YAML::EndMap << YAML::Comment(summary.str());
+
+            std::cout << std::left << std::setw(40) << name << std::setw(6) << (isHot ? "yes" : "no") << std::setw(12)
+                      << (candidates[chosen].algorithm + " " + std::to_string(candidates[chosen].level)) << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(14) << zipPerEntry << std::setw(14)
+                      << microsPerEntry << std::endl;
+        }
+        out << YAML::EndSeq << YAML::EndMap;
+
+        std::ofstream policyFile{outputFile, std::ios::trunc};
+        policyFile << out.c_str() << std::endl;
+        if (!policyFile)
+        {
+            throw std::runtime_error("Couldn't write " + outputFile);
+        }
+        std::cout << "Saved the output policy to " << outputFile << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}